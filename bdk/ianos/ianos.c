@@ -23,6 +23,7 @@
 #include <mem/heap.h>
 #include <storage/nx_sd.h>
 #include <utils/types.h>
+#include <utils/util.h>
 
 #include <gfx_utils.h>
 
@@ -33,6 +34,7 @@ extern heap_t _heap;
 
 void *elfBuf = NULL;
 void *fileBuf = NULL;
+static u32 fileCrc32 = 0;
 
 static void _ianos_call_ep(moduleEntrypoint_t entrypoint, void *moduleConfig)
 {
@@ -68,16 +70,22 @@ uintptr_t ianos_loader(char *path, elfType_t type, void *moduleConfig)
 {
 	el_ctx ctx;
 	uintptr_t epaddr = 0;
+	u32 fileSize;
+
+	fileCrc32 = 0;
 
 	if (!sd_mount())
 		goto elfLoadFinalOut;
 
 	// Read library.
-	fileBuf = sd_file_read(path, NULL);
+	fileBuf = sd_file_read(path, &fileSize);
 
 	if (!fileBuf)
 		goto elfLoadFinalOut;
 
+	// Identify the module, so callers can tie cached results to it.
+	fileCrc32 = crc32_calc(0, fileBuf, fileSize);
+
 	ctx.pread = _ianos_read_cb;
 
 	if (el_init(&ctx))
@@ -118,4 +126,9 @@ elfFreeOut:
 
 elfLoadFinalOut:
 	return epaddr;
-}
\ No newline at end of file
+}
+
+u32 ianos_get_crc32()
+{
+	return fileCrc32;
+}
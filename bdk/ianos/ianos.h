@@ -30,5 +30,6 @@ typedef enum
 } elfType_t;
 
 uintptr_t ianos_loader(char *path, elfType_t type, void* config);
+u32 ianos_get_crc32(); // Of the last loaded module file. 0 if loading failed.
 
 #endif
\ No newline at end of file
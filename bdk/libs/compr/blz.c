@@ -32,6 +32,64 @@ const blz_footer *blz_get_footer(const unsigned char *compData, unsigned int com
 	return srcFooter;
 }
 
+// Copies size bytes backwards, ending at dst/src. Uses words when both sides share alignment.
+static inline __attribute__((always_inline)) void _blz_copy_back(unsigned char *dst, const unsigned char *src, u32 size)
+{
+	if (size >= 8 && dst >= src + 4 && !(((u32)dst ^ (u32)src) & 3))
+	{
+		while ((u32)dst & 3)
+		{
+			*--dst = *--src;
+			size--;
+		}
+		while (size >= 4)
+		{
+			dst -= 4;
+			src -= 4;
+			*(u32 *)dst = *(const u32 *)src;
+			size -= 4;
+		}
+	}
+
+	while (size--)
+		*--dst = *--src;
+}
+
+// Copies a back-reference forward. Source is always ahead of destination, so it never reads new data.
+static inline __attribute__((always_inline)) void _blz_copy_seg(unsigned char *dst, u32 seg_ofs, u32 size)
+{
+	const unsigned char *src = dst + seg_ofs;
+
+	if (size >= 8 && !(seg_ofs & 3))
+	{
+		while ((u32)dst & 3)
+		{
+			*dst++ = *src++;
+			size--;
+		}
+		while (size >= 4)
+		{
+			*(u32 *)dst = *(const u32 *)src;
+			dst += 4;
+			src += 4;
+			size -= 4;
+		}
+	}
+	else if (size >= 3)
+	{
+		// Minimum segment size. Unrolled.
+		dst[0] = src[0];
+		dst[1] = src[1];
+		dst[2] = src[2];
+		dst += 3;
+		src += 3;
+		size -= 3;
+	}
+
+	while (size--)
+		*dst++ = *src++;
+}
+
 // From https://github.com/SciresM/hactool/blob/master/kip.c which is exactly how kernel does it, thanks SciresM!
 int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const blz_footer *footer)
 {
@@ -45,6 +103,46 @@ int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const
 
 	while (out_ofs)
 	{
+		// Fast path. A control byte consumes up to 17 bytes and produces up to 8 * 18 bytes, so no bounds checks needed.
+		if (cmp_ofs >= (1 + 8 * 2) && out_ofs >= (8 * 18))
+		{
+			const unsigned char *in = &cmp_start[cmp_ofs];
+			unsigned char *out = &cmp_start[out_ofs];
+			u32 control = *--in;
+
+			if (!control)
+			{
+				// Whole byte of literals.
+				_blz_copy_back(out, in, 8);
+				out -= 8;
+				in -= 8;
+			}
+			else
+			{
+				for (u32 i = 0; i < 8; i++, control <<= 1)
+				{
+					if (control & 0x80)
+					{
+						in -= 2;
+						u32 seg_val = (in[1] << 8) | in[0];
+						u32 seg_size = (seg_val >> 12) + 3;
+						out -= seg_size;
+						_blz_copy_seg(out, (seg_val & 0x0FFF) + 3, seg_size);
+					}
+					else
+						*--out = *--in;
+				}
+			}
+
+			cmp_ofs = in - cmp_start;
+			out_ofs = out - cmp_start;
+
+			continue;
+		}
+
+		if (cmp_ofs < 1)
+			return 0; // Out of bounds.
+
 		unsigned char control = cmp_start[--cmp_ofs];
 		for (unsigned int i=0; i<8; i++)
 		{
@@ -62,8 +160,7 @@ int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const
 
 				out_ofs -= seg_size;
 
-				for (unsigned int j = 0; j < seg_size; j++)
-					cmp_start[out_ofs + j] = cmp_start[out_ofs + j + seg_ofs];
+				_blz_copy_seg(&cmp_start[out_ofs], seg_ofs, seg_size);
 			}
 			else
 			{
@@ -76,8 +173,8 @@ int blz_uncompress_inplace(unsigned char *dataBuf, unsigned int compSize, const
 			control <<= 1;
 			if (out_ofs == 0) // Blz works backwards, so if it reaches byte 0, it's done.
 				return 1;
-			}
 		}
+	}
 
 	return 1;
 }
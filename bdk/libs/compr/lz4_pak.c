@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "lz4.h"
+#include "lz4_pak.h"
+
+const lz4_pak_hdr_t *lz4_pak_get_hdr(const void *pak, u32 size)
+{
+	const lz4_pak_hdr_t *hdr = (const lz4_pak_hdr_t *)pak;
+
+	if (size < sizeof(lz4_pak_hdr_t) || hdr->magic != LZ4_PAK_MAGIC || hdr->version != LZ4_PAK_VERSION)
+		return NULL;
+
+	if (hdr->count > (size - sizeof(lz4_pak_hdr_t)) / sizeof(lz4_pak_entry_t))
+		return NULL;
+
+	// Validate entries against pak size. They must also cover the whole image in order, without gaps.
+	const lz4_pak_entry_t *entries = (const lz4_pak_entry_t *)(hdr + 1);
+	u32 raw_end = 0;
+	for (u32 i = 0; i < hdr->count; i++)
+	{
+		if (entries[i].comp_size > size || entries[i].comp_off > (size - entries[i].comp_size) ||
+			entries[i].raw_off != raw_end || !entries[i].raw_size || entries[i].raw_size > (hdr->raw_size - raw_end))
+			return NULL;
+
+		raw_end += entries[i].raw_size;
+	}
+
+	if (raw_end != hdr->raw_size || !raw_end)
+		return NULL;
+
+	return hdr;
+}
+
+int lz4_pak_find(const void *pak, u32 raw_off)
+{
+	const lz4_pak_hdr_t *hdr = (const lz4_pak_hdr_t *)pak;
+	const lz4_pak_entry_t *entries = (const lz4_pak_entry_t *)(hdr + 1);
+
+	for (u32 i = 0; i < hdr->count; i++)
+	{
+		if (raw_off >= entries[i].raw_off && raw_off < (entries[i].raw_off + entries[i].raw_size))
+			return i;
+	}
+
+	return -1;
+}
+
+int lz4_pak_unpack_entry(const void *pak, u32 idx, void *dst)
+{
+	const lz4_pak_hdr_t *hdr = (const lz4_pak_hdr_t *)pak;
+	const lz4_pak_entry_t *entry = (const lz4_pak_entry_t *)(hdr + 1) + idx;
+
+	if (idx >= hdr->count)
+		return 0;
+
+	const char *src = (const char *)pak + entry->comp_off;
+	char *out = (char *)dst + entry->raw_off;
+
+	if (entry->comp_size == entry->raw_size)
+	{
+		memcpy(out, src, entry->raw_size);
+		return 1;
+	}
+
+	return LZ4_decompress_safe(src, out, entry->comp_size, entry->raw_size) == (int)entry->raw_size;
+}
+
+int lz4_pak_unpack(const void *pak, void *dst)
+{
+	const lz4_pak_hdr_t *hdr = (const lz4_pak_hdr_t *)pak;
+
+	for (u32 i = 0; i < hdr->count; i++)
+		if (!lz4_pak_unpack_entry(pak, i, dst))
+			return 0;
+
+	return 1;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _LZ4_PAK_H_
+#define _LZ4_PAK_H_
+
+#include <utils/types.h>
+
+#define LZ4_PAK_MAGIC   0x50345A4C // "LZ4P".
+#define LZ4_PAK_VERSION 1
+
+/*
+ * Layout: header, entries[count], then the data of each entry.
+ * Each entry is an independent LZ4 block, so it can be unpacked on its own.
+ * Entries are ordered by raw_off and cover the whole unpacked image.
+ * An entry with comp_size equal to raw_size is stored uncompressed.
+ */
+typedef struct _lz4_pak_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+	u32 raw_size; // Size of the whole unpacked image.
+} lz4_pak_hdr_t;
+
+typedef struct _lz4_pak_entry_t
+{
+	u32 raw_off;   // Offset in the unpacked image.
+	u32 raw_size;
+	u32 comp_off;  // Offset from the start of the pak.
+	u32 comp_size;
+} lz4_pak_entry_t;
+
+// Returns the header if pak is a valid LZ4 pak, NULL otherwise. Other calls expect a validated pak.
+const lz4_pak_hdr_t *lz4_pak_get_hdr(const void *pak, u32 size);
+// Returns entry index that contains raw_off or -1.
+int  lz4_pak_find(const void *pak, u32 raw_off);
+// Unpacks an entry to dst + raw_off. Returns 0 on failure.
+int  lz4_pak_unpack_entry(const void *pak, u32 idx, void *dst);
+// Unpacks all entries to dst. Returns 0 on failure.
+int  lz4_pak_unpack(const void *pak, void *dst);
+
+#endif
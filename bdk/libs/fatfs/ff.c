@@ -3851,7 +3851,21 @@ FRESULT f_read (
 			cc = btr / SS(fs);					/* When remaining bytes >= sector size, */
 			if (cc > 0) {						/* Read maximum contiguous sectors directly */
 				if (csect + cc > fs->csize) {	/* Clip at cluster boundary */
+					rcnt = cc;
 					cc = fs->csize - csect;
+					while (cc < rcnt) {			/* Extend over physically contiguous clusters */
+#if FF_USE_FASTSEEK
+						if (fp->cltbl) {
+							clst = clmt_clust(fp, fp->fptr + (FSIZE_t)cc * SS(fs));
+						} else
+#endif
+						{
+							clst = get_fat(&fp->obj, fp->clust);
+						}
+						if (clst != fp->clust + 1) break;	/* Fragmented or error. Next cluster is followed as usual */
+						fp->clust = clst;
+						cc += (rcnt - cc > fs->csize) ? fs->csize : rcnt - cc;
+					}
 				}
 				if (disk_read(fs->pdrv, rbuff, sect, cc) != RES_OK) {
 					EFSPRINTF("RLIO");
@@ -5360,10 +5374,11 @@ FRESULT f_rename (
 /* Change Attribute                                                      */
 /*-----------------------------------------------------------------------*/
 
-FRESULT f_chmod (
+static FRESULT chmod_path (
 	const TCHAR* path,	/* Pointer to the file path */
 	BYTE attr,			/* Attribute bits */
-	BYTE mask			/* Attribute mask to change */
+	BYTE mask,			/* Attribute mask to change */
+	int sync			/* Flush the volume after the change */
 )
 {
 	FRESULT res;
@@ -5390,7 +5405,7 @@ FRESULT f_chmod (
 				dj.dir[DIR_Attr] = (attr & mask) | (dj.dir[DIR_Attr] & (BYTE)~mask);	/* Apply attribute change */
 				fs->wflag = 1;
 			}
-			if (res == FR_OK) {
+			if (res == FR_OK && sync) {
 				res = sync_fs(fs);
 			}
 		}
@@ -5401,6 +5416,56 @@ FRESULT f_chmod (
 }
 
 
+FRESULT f_chmod (
+	const TCHAR* path,	/* Pointer to the file path */
+	BYTE attr,			/* Attribute bits */
+	BYTE mask			/* Attribute mask to change */
+)
+{
+	return chmod_path(path, attr, mask, 1);
+}
+
+
+#if FF_FASTFS
+/*-----------------------------------------------------------------------*/
+/* Change Attribute Without Flushing The Volume                          */
+/*-----------------------------------------------------------------------*/
+/* The entry is only updated in the sector window. Changes that fall in  */
+/* the same directory sector get written back together when the window   */
+/* moves, or when f_sync_vol() is called.                                */
+
+FRESULT f_chmod_fast (
+	const TCHAR* path,	/* Pointer to the file path */
+	BYTE attr,			/* Attribute bits */
+	BYTE mask			/* Attribute mask to change */
+)
+{
+	return chmod_path(path, attr, mask, 0);
+}
+
+
+/*-----------------------------------------------------------------------*/
+/* Flush Pending Volume Changes                                          */
+/*-----------------------------------------------------------------------*/
+
+FRESULT f_sync_vol (
+	const TCHAR* path	/* Logical drive number */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+
+
+	res = find_volume(&path, &fs, FA_WRITE);	/* Get logical drive */
+	if (res == FR_OK) {
+		res = sync_fs(fs);
+	}
+
+	LEAVE_FF(fs, res);
+}
+#endif
+
+
 
 
 /*-----------------------------------------------------------------------*/
@@ -5826,6 +5891,25 @@ FRESULT f_forward (
 
 
 #if FF_USE_MKFS && !FF_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Get number of sectors for the next area fill write                    */
+/*-----------------------------------------------------------------------*/
+
+static DWORD mkfs_chunk (	/* Number of sectors to write */
+	DWORD sect,		/* Current sector */
+	DWORD nsect,	/* Number of sectors left */
+	DWORD sz_al		/* Write alignment (AU of the medium, clamped to the working buffer) [sector] */
+)
+{
+	DWORD n;
+
+
+	n = sz_al - (sect & (sz_al - 1));	/* Up to the next alignment boundary, so the following writes do not straddle erase blocks */
+	return (n > nsect) ? nsect : n;
+}
+
+
+
 /*-----------------------------------------------------------------------*/
 /* Create an FAT/exFAT volume                                            */
 /*-----------------------------------------------------------------------*/
@@ -5842,9 +5926,9 @@ FRESULT f_mkfs (
 	const UINT n_rootdir = 512;	/* Number of root directory entries for FAT volume */
 	static const WORD cst[] = {1, 4, 16, 64, 256, 512, 0};	/* Cluster size boundary for FAT volume (4Ks unit) */
 	static const WORD cst32[] = {1, 2, 4, 8, 16, 32, 0};	/* Cluster size boundary for FAT32 volume (128Ks unit) */
-	BYTE fmt, sys, *buf, *pte, pdrv, part;
+	BYTE fmt, sys, *buf, *pb, *pte, pdrv, part;
 	WORD ss;	/* Sector size */
-	DWORD szb_buf, sz_buf, sz_blk, n_clst, pau, sect, nsect, n;
+	DWORD szb_buf, sz_buf, sz_blk, sz_al, n_clst, pau, sect, nsect, n;
 	DWORD b_vol, b_fat, b_data;				/* Base LBA for volume, fat, data */
 	DWORD sz_vol, sz_rsv, sz_fat, sz_dir;	/* Size for volume, fat, dir, data */
 	UINT i;
@@ -5889,6 +5973,12 @@ FRESULT f_mkfs (
 		szb_buf = sz_buf * ss;	/* Size of working buffer (byte) */
 	}
 	if (!buf || sz_buf == 0) return FR_NOT_ENOUGH_CORE;
+	for (sz_al = 1; sz_al * 2 <= sz_buf; sz_al *= 2) ;	/* Largest power of 2 that fits in the working buffer */
+	n = 0;	/* Drivers that do not know the AU leave it untouched */
+	if (disk_ioctl(pdrv, GET_AU_SIZE, &n) == RES_OK && n) {	/* Area fill write alignment: the medium's AU, clamped to the buffer */
+		n &= ~(n - 1);			/* Power of 2 part of the AU (12MB and 24MB AUs are not powers of 2) */
+		if (n < sz_al) sz_al = n;
+	}
 
 	/* Determine where the volume to be located (b_vol, sz_vol) */
 	if (FF_MULTI_PARTITION && part != 0) {
@@ -5995,12 +6085,13 @@ FRESULT f_mkfs (
 		/* Initialize the allocation bitmap */
 		sect = b_data; nsect = (szb_bit + ss - 1) / ss;	/* Start of bitmap and number of sectors */
 		nb = tbl[0] + tbl[1] + tbl[2];					/* Number of clusters in-use by system */
+		mem_set(buf, 0, szb_buf);	/* Clear work area once, only the used part is cleared after each write */
 		do {
-			mem_set(buf, 0, szb_buf);
-			for (i = 0; nb >= 8 && i < szb_buf; buf[i++] = 0xFF, nb -= 8) ;
-			for (b = 1; nb != 0 && i < szb_buf; buf[i] |= b, b <<= 1, nb--) ;
-			n = (nsect > sz_buf) ? sz_buf : nsect;		/* Write the buffered data */
-			if (disk_write(pdrv, buf, sect, n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
+			n = mkfs_chunk(sect, nsect, sz_al);
+			for (i = 0; nb >= 8 && i < n * ss; buf[i++] = 0xFF, nb -= 8) ;
+			for (b = 1; nb != 0 && i < n * ss; buf[i] |= b, b <<= 1, nb--) ;
+			if (disk_write(pdrv, buf, sect, n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);	/* Write the buffered data */
+			mem_set(buf, 0, (i < n * ss) ? i + 1 : i);
 			sect += n; nsect -= n;
 		} while (nsect);
 
@@ -6008,25 +6099,24 @@ FRESULT f_mkfs (
 		sect = b_fat; nsect = sz_fat;	/* Start of FAT and number of FAT sectors */
 		j = nb = cl = 0;
 		do {
-			mem_set(buf, 0, szb_buf); i = 0;	/* Clear work area and reset write index */
+			n = mkfs_chunk(sect, nsect, sz_al); i = 0;	/* Get write size and reset write index (work area is clear) */
 			if (cl == 0) {	/* Set entry 0 and 1 */
 				st_dword(buf + i, 0xFFFFFFF8); i += 4; cl++;
 				st_dword(buf + i, 0xFFFFFFFF); i += 4; cl++;
 			}
 			do {			/* Create chains of bitmap, up-case and root dir */
-				while (nb != 0 && i < szb_buf) {			/* Create a chain */
+				while (nb != 0 && i < n * ss) {			/* Create a chain */
 					st_dword(buf + i, (nb > 1) ? cl + 1 : 0xFFFFFFFF);
 					i += 4; cl++; nb--;
 				}
 				if (nb == 0 && j < 3) nb = tbl[j++];	/* Next chain */
-			} while (nb != 0 && i < szb_buf);
-			n = (nsect > sz_buf) ? sz_buf : nsect;	/* Write the buffered data */
-			if (disk_write(pdrv, buf, sect, n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
+			} while (nb != 0 && i < n * ss);
+			if (disk_write(pdrv, buf, sect, n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);	/* Write the buffered data */
+			if (i) mem_set(buf, 0, i);	/* Clear the used part of work area */
 			sect += n; nsect -= n;
 		} while (nsect);
 
-		/* Initialize the root directory */
-		mem_set(buf, 0, szb_buf);
+		/* Initialize the root directory (work area is clear) */
 		buf[SZDIRE * 0 + 0] = ET_VLABEL;		/* Volume label entry */
 		buf[SZDIRE * 1 + 0] = ET_BITMAP;		/* Bitmap entry */
 		st_dword(buf + SZDIRE * 1 + 20, 2);				/* cluster */
@@ -6037,54 +6127,54 @@ FRESULT f_mkfs (
 		st_dword(buf + SZDIRE * 2 + 24, szb_case);		/* size */
 		sect = b_data + au * (tbl[0] + tbl[1]);	nsect = au;	/* Start of the root directory and number of sectors */
 		do {	/* Fill root directory sectors */
-			n = (nsect > sz_buf) ? sz_buf : nsect;
+			n = mkfs_chunk(sect, nsect, sz_al);
 			if (disk_write(pdrv, buf, sect, n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
 			mem_set(buf, 0, ss);
 			sect += n; nsect -= n;
 		} while (nsect);
 
 		/* Create two set of the exFAT VBR blocks */
-		sect = b_vol;
+		sect = b_vol; nsect = 0;	/* Start of the VBR and number of buffered sectors */
 		for (n = 0; n < 2; n++) {
-			/* Main record (+0) */
-			mem_set(buf, 0, ss);
-			mem_cpy(buf + BS_JmpBoot, "\xEB\x76\x90" "EXFAT   ", 11);	/* Boot jump code (x86), OEM name */
-			st_dword(buf + BPB_VolOfsEx, b_vol);					/* Volume offset in the physical drive [sector] */
-			st_dword(buf + BPB_TotSecEx, sz_vol);					/* Volume size [sector] */
-			st_dword(buf + BPB_FatOfsEx, b_fat - b_vol);			/* FAT offset [sector] */
-			st_dword(buf + BPB_FatSzEx, sz_fat);					/* FAT size [sector] */
-			st_dword(buf + BPB_DataOfsEx, b_data - b_vol);			/* Data offset [sector] */
-			st_dword(buf + BPB_NumClusEx, n_clst);					/* Number of clusters */
-			st_dword(buf + BPB_RootClusEx, 2 + tbl[0] + tbl[1]);	/* Root dir cluster # */
-			st_dword(buf + BPB_VolIDEx, GET_FATTIME());				/* VSN */
-			st_word(buf + BPB_FSVerEx, 0x100);						/* Filesystem version (1.00) */
-			for (buf[BPB_BytsPerSecEx] = 0, i = ss; i >>= 1; buf[BPB_BytsPerSecEx]++) ;	/* Log2 of sector size [byte] */
-			for (buf[BPB_SecPerClusEx] = 0, i = au; i >>= 1; buf[BPB_SecPerClusEx]++) ;	/* Log2 of cluster size [sector] */
-			buf[BPB_NumFATsEx] = 1;					/* Number of FATs */
-			buf[BPB_DrvNumEx] = 0x80;				/* Drive number (for int13) */
-			st_word(buf + BS_BootCodeEx, 0xFEEB);	/* Boot code (x86) */
-			st_word(buf + BS_55AA, 0xAA55);			/* Signature (placed here regardless of sector size) */
-			for (i = sum = 0; i < ss; i++) {		/* VBR checksum */
-				if (i != BPB_VolFlagEx && i != BPB_VolFlagEx + 1 && i != BPB_PercInUseEx) sum = xsum32(buf[i], sum);
-			}
-			if (disk_write(pdrv, buf, sect++, 1) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
-			/* Extended bootstrap record (+1..+8) */
-			mem_set(buf, 0, ss);
-			st_word(buf + ss - 2, 0xAA55);	/* Signature (placed at end of sector) */
-			for (j = 1; j < 9; j++) {
-				for (i = 0; i < ss; sum = xsum32(buf[i++], sum)) ;	/* VBR checksum */
-				if (disk_write(pdrv, buf, sect++, 1) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
-			}
-			/* OEM/Reserved record (+9..+10) */
-			mem_set(buf, 0, ss);
-			for ( ; j < 11; j++) {
-				for (i = 0; i < ss; sum = xsum32(buf[i++], sum)) ;	/* VBR checksum */
-				if (disk_write(pdrv, buf, sect++, 1) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
+			for (j = 0; j < 12; j++) {
+				if (nsect == sz_buf) {	/* Write the buffered sectors when buffer full */
+					if (disk_write(pdrv, buf, sect, nsect) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
+					sect += nsect; nsect = 0;
+				}
+				pb = buf + nsect++ * ss;
+				mem_set(pb, 0, ss);
+				if (j == 0) {
+					/* Main record (+0) */
+					mem_cpy(pb + BS_JmpBoot, "\xEB\x76\x90" "EXFAT   ", 11);	/* Boot jump code (x86), OEM name */
+					st_dword(pb + BPB_VolOfsEx, b_vol);					/* Volume offset in the physical drive [sector] */
+					st_dword(pb + BPB_TotSecEx, sz_vol);					/* Volume size [sector] */
+					st_dword(pb + BPB_FatOfsEx, b_fat - b_vol);			/* FAT offset [sector] */
+					st_dword(pb + BPB_FatSzEx, sz_fat);					/* FAT size [sector] */
+					st_dword(pb + BPB_DataOfsEx, b_data - b_vol);			/* Data offset [sector] */
+					st_dword(pb + BPB_NumClusEx, n_clst);					/* Number of clusters */
+					st_dword(pb + BPB_RootClusEx, 2 + tbl[0] + tbl[1]);	/* Root dir cluster # */
+					st_dword(pb + BPB_VolIDEx, GET_FATTIME());				/* VSN */
+					st_word(pb + BPB_FSVerEx, 0x100);						/* Filesystem version (1.00) */
+					for (pb[BPB_BytsPerSecEx] = 0, i = ss; i >>= 1; pb[BPB_BytsPerSecEx]++) ;	/* Log2 of sector size [byte] */
+					for (pb[BPB_SecPerClusEx] = 0, i = au; i >>= 1; pb[BPB_SecPerClusEx]++) ;	/* Log2 of cluster size [sector] */
+					pb[BPB_NumFATsEx] = 1;					/* Number of FATs */
+					pb[BPB_DrvNumEx] = 0x80;				/* Drive number (for int13) */
+					st_word(pb + BS_BootCodeEx, 0xFEEB);	/* Boot code (x86) */
+					st_word(pb + BS_55AA, 0xAA55);			/* Signature (placed here regardless of sector size) */
+					for (i = sum = 0; i < ss; i++) {		/* VBR checksum */
+						if (i != BPB_VolFlagEx && i != BPB_VolFlagEx + 1 && i != BPB_PercInUseEx) sum = xsum32(pb[i], sum);
+					}
+				} else if (j < 11) {
+					/* Extended bootstrap record (+1..+8) and OEM/Reserved record (+9..+10) */
+					if (j < 9) st_word(pb + ss - 2, 0xAA55);	/* Signature (placed at end of sector) */
+					for (i = 0; i < ss; sum = xsum32(pb[i++], sum)) ;	/* VBR checksum */
+				} else {
+					/* Sum record (+11) */
+					for (i = 0; i < ss; i += 4) st_dword(pb + i, sum);	/* Fill with checksum value */
+				}
 			}
-			/* Sum record (+11) */
-			for (i = 0; i < ss; i += 4) st_dword(buf + i, sum);		/* Fill with checksum value */
-			if (disk_write(pdrv, buf, sect++, 1) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
 		}
+		if (disk_write(pdrv, buf, sect, nsect) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);	/* Write the rest of the buffered sectors */
 
 	} else
 #endif	/* FF_FS_EXFAT */
@@ -6201,19 +6291,29 @@ FRESULT f_mkfs (
 			mem_cpy(buf + BS_VolLab, "SWITCH SD  " "FAT     ", 19);	/* Volume label, FAT signature */
 		}
 		st_word(buf + BS_55AA, 0xAA55);					/* Signature (offset is fixed here regardless of sector size) */
-		if (disk_write(pdrv, buf, b_vol, 1) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);	/* Write it to the VBR sector */
+
+		n = (fmt == FS_FAT32 && sz_buf >= 2) ? 2 : 1;	/* Number of sectors to write at the VBR (FSINFO goes along if it fits) */
+		if (n == 1) {
+			if (disk_write(pdrv, buf, b_vol, 1) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);	/* Write it to the VBR sector */
+			if (fmt == FS_FAT32) disk_write(pdrv, buf, b_vol + 6, 1);	/* Write backup VBR (VBR + 6) */
+		}
 
 		/* Create FSINFO record if needed */
 		if (fmt == FS_FAT32) {
-			disk_write(pdrv, buf, b_vol + 6, 1);		/* Write backup VBR (VBR + 6) */
-			mem_set(buf, 0, ss);
-			st_dword(buf + FSI_LeadSig, 0x41615252);
-			st_dword(buf + FSI_StrucSig, 0x61417272);
-			st_dword(buf + FSI_Free_Count, n_clst - 1);	/* Number of free clusters */
-			st_dword(buf + FSI_Nxt_Free, 2);			/* Last allocated cluster# */
-			st_word(buf + BS_55AA, 0xAA55);
-			disk_write(pdrv, buf, b_vol + 7, 1);		/* Write backup FSINFO (VBR + 7) */
-			disk_write(pdrv, buf, b_vol + 1, 1);		/* Write original FSINFO (VBR + 1) */
+			pb = buf + (n - 1) * ss;
+			mem_set(pb, 0, ss);
+			st_dword(pb + FSI_LeadSig, 0x41615252);
+			st_dword(pb + FSI_StrucSig, 0x61417272);
+			st_dword(pb + FSI_Free_Count, n_clst - 1);	/* Number of free clusters */
+			st_dword(pb + FSI_Nxt_Free, 2);			/* Last allocated cluster# */
+			st_word(pb + BS_55AA, 0xAA55);
+			if (n == 2) {
+				disk_write(pdrv, buf, b_vol + 6, 2);		/* Write backup VBR and FSINFO (VBR + 6) */
+				if (disk_write(pdrv, buf, b_vol, 2) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);	/* Write original VBR and FSINFO (VBR + 0) */
+			} else {
+				disk_write(pdrv, buf, b_vol + 7, 1);		/* Write backup FSINFO (VBR + 7) */
+				disk_write(pdrv, buf, b_vol + 1, 1);		/* Write original FSINFO (VBR + 1) */
+			}
 		}
 
 		/* Initialize FAT area */
@@ -6229,7 +6329,7 @@ FRESULT f_mkfs (
 			}
 			nsect = sz_fat;		/* Number of FAT sectors */
 			do {	/* Fill FAT sectors */
-				n = (nsect > sz_buf) ? sz_buf : nsect;
+				n = mkfs_chunk(sect, nsect, sz_al);
 				if (disk_write(pdrv, buf, sect, (UINT)n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
 				mem_set(buf, 0, ss);
 				sect += n; nsect -= n;
@@ -6239,7 +6339,7 @@ FRESULT f_mkfs (
 		/* Initialize root directory (fill with zero) */
 		nsect = (fmt == FS_FAT32) ? pau : sz_dir;	/* Number of root directory sectors */
 		do {
-			n = (nsect > sz_buf) ? sz_buf : nsect;
+			n = mkfs_chunk(sect, nsect, sz_al);
 			if (disk_write(pdrv, buf, sect, (UINT)n) != RES_OK) LEAVE_MKFS(FR_DISK_ERR);
 			sect += n; nsect -= n;
 		} while (nsect);
@@ -278,6 +278,10 @@ FRESULT f_unlink (const TCHAR* path);								/* Delete an existing file or direc
 FRESULT f_rename (const TCHAR* path_old, const TCHAR* path_new);	/* Rename/Move a file or directory */
 FRESULT f_stat (const TCHAR* path, FILINFO* fno);					/* Get file status */
 FRESULT f_chmod (const TCHAR* path, BYTE attr, BYTE mask);			/* Change attribute of a file/dir */
+#if FF_FASTFS
+FRESULT f_chmod_fast (const TCHAR* path, BYTE attr, BYTE mask);	/* Change attribute of a file/dir without flushing */
+FRESULT f_sync_vol (const TCHAR* path);								/* Flush pending changes of the volume */
+#endif
 FRESULT f_utime (const TCHAR* path, const FILINFO* fno);			/* Change timestamp of a file/dir */
 FRESULT f_chdir (const TCHAR* path);								/* Change current directory */
 FRESULT f_chdrive (const TCHAR* path);								/* Change current drive */
@@ -135,6 +135,7 @@
 /*Feature usage*/
 #define USE_LV_ANIMATION        1               /*1: Enable all animations*/
 #define USE_LV_SHADOW           1               /*1: Enable shadows*/
+#define LV_SHADOW_CACHE_SIZE    (64 * 1024)     /*Bytes of `lv_mem` for cached shadow profiles (0: no cache)*/
 #define USE_LV_GROUP            0               /*1: Enable object groups (for keyboards)*/
 #define USE_LV_GPU              0               /*1: Enable GPU interface*/
 #define USE_LV_REAL_DRAW        0               /*1: Enable function which draw directly to the frame buffer instead of VDB (required if LV_VDB_SIZE = 0)*/
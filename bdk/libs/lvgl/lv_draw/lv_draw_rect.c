@@ -9,6 +9,7 @@
 #include "lv_draw_rect.h"
 #include "../lv_misc/lv_circ.h"
 #include "../lv_misc/lv_math.h"
+#include "../lv_misc/lv_mem.h"
 
 /*********************
  *      DEFINES
@@ -17,11 +18,29 @@
 
 #define SHADOW_OPA_EXTRA_PRECISION      8       /*Calculate with 2^x bigger shadow opacity values to avoid rounding errors*/
 #define SHADOW_BOTTOM_AA_EXTRA_RADIUS   3       /*Add extra radius with LV_SHADOW_BOTTOM to cover anti-aliased corners*/
+#define SHADOW_CACHE_ENTRIES            16      /*Max number of cached shadow profiles*/
 
 /**********************
  *      TYPEDEFS
  **********************/
 
+#if USE_LV_SHADOW && LV_VDB_SIZE
+/*Everything of a shadow which does not depend on its position*/
+typedef struct
+{
+    uint8_t type;
+    lv_opa_t opa;
+    lv_coord_t radius;          /*Radius after correction, without anti-aliasing extras*/
+    lv_coord_t swidth;
+    uint32_t size;
+    uint32_t last_use;
+    bool cached;
+    lv_coord_t * curve_x;       /*'x' coordinates of a quarter circle*/
+    uint16_t * cols;            /*LV_SHADOW_FULL: number of pixels in each line*/
+    lv_opa_t * blur;            /*LV_SHADOW_FULL: 2D blur lines. LV_SHADOW_BOTTOM: 1D blur*/
+} lv_shadow_profile_t;
+#endif
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
@@ -35,6 +54,8 @@ static void lv_draw_shadow(const lv_area_t * coords, const lv_area_t * mask, con
 static void lv_draw_shadow_full(const lv_area_t * coords, const lv_area_t * mask, const  lv_style_t * style, lv_opa_t opa_scale);
 static void lv_draw_shadow_bottom(const lv_area_t * coords, const lv_area_t * mask, const lv_style_t * style, lv_opa_t opa_scale);
 static void lv_draw_shadow_full_straight(const lv_area_t * coords, const lv_area_t * mask, const lv_style_t * style, const lv_opa_t * map);
+static lv_shadow_profile_t * lv_shadow_profile_get(uint8_t type, lv_coord_t radius, lv_coord_t swidth, lv_opa_t opa);
+static void lv_shadow_profile_release(lv_shadow_profile_t * profile);
 #endif
 
 static uint16_t lv_draw_cont_radius_corr(uint16_t r, lv_coord_t w, lv_coord_t h);
@@ -46,6 +67,11 @@ static lv_opa_t antialias_get_opa_circ(lv_coord_t seg, lv_coord_t px_id, lv_opa_
 /**********************
  *  STATIC VARIABLES
  **********************/
+#if USE_LV_SHADOW && LV_VDB_SIZE && LV_SHADOW_CACHE_SIZE
+static lv_shadow_profile_t * shadow_cache[SHADOW_CACHE_ENTRIES];
+static uint32_t shadow_cache_size;
+static uint32_t shadow_cache_tick;
+#endif
 
 /**********************
  *      MACROS
@@ -1063,18 +1089,6 @@ static void lv_draw_shadow(const lv_area_t * coords, const lv_area_t * mask, con
 
 static void lv_draw_shadow_full(const lv_area_t * coords, const lv_area_t * mask, const lv_style_t * style, lv_opa_t opa_scale)
 {
-
-    /* KNOWN ISSUE
-     * The algorithm calculates the shadow only above the middle point of the radius (speaking about the left top corner).
-     * It causes an error because it doesn't consider how long the straight edge is which effects the value of bottom of the corner shadow.
-     * In addition the straight shadow is drawn from the middles point of the radius however
-     * the ends of the straight parts still should be effected by the corner shadow.
-     * It also causes an issue in opacity. A smaller radius means smaller average shadow opacity.
-     * The solution should be to start `line` from `- swidth` and handle if the straight part is short (or zero) and the value is taken from
-     * the other corner. `col` also should start from `- swidth`
-     */
-
-
     lv_coord_t radius = style->body.radius;
     lv_coord_t swidth = style->body.shadow.width;
 
@@ -1083,55 +1097,14 @@ static void lv_draw_shadow_full(const lv_area_t * coords, const lv_area_t * mask
 
     radius = lv_draw_cont_radius_corr(radius, width, height);
 
+    lv_opa_t opa = opa_scale == LV_OPA_COVER ? style->body.opa : (uint16_t)((uint16_t) style->body.opa * opa_scale) >> 8;
+    lv_shadow_profile_t * profile = lv_shadow_profile_get(LV_SHADOW_FULL, radius, swidth, opa);
+
     radius += LV_ANTIALIAS;
 
-#if LV_COMPILER_VLA_SUPPORTED
-    lv_coord_t curve_x[radius + swidth + 1];     /*Stores the 'x' coordinates of a quarter circle.*/
-#else
-# if LV_HOR_RES > LV_VER_RES
-    lv_coord_t curve_x[LV_HOR_RES];
-# else
-    lv_coord_t curve_x[LV_VER_RES];
-# endif
-#endif
-    memset(curve_x, 0, sizeof(curve_x));
-    lv_point_t circ;
-    lv_coord_t circ_tmp;
-    lv_circ_init(&circ, &circ_tmp, radius);
-    while(lv_circ_cont(&circ)) {
-        curve_x[LV_CIRC_OCT1_Y(circ)] = LV_CIRC_OCT1_X(circ);
-        curve_x[LV_CIRC_OCT2_Y(circ)] = LV_CIRC_OCT2_X(circ);
-        lv_circ_next(&circ, &circ_tmp);
-    }
+    const lv_coord_t * curve_x = profile->curve_x;
     int16_t line;
 
-    int16_t filter_width = 2 * swidth + 1;
-#if LV_COMPILER_VLA_SUPPORTED
-    uint32_t line_1d_blur[filter_width];
-#else
-# if LV_HOR_RES > LV_VER_RES
-    uint32_t line_1d_blur[LV_HOR_RES];
-# else
-    uint32_t line_1d_blur[LV_VER_RES];
-# endif
-#endif
-    /*1D Blur horizontally*/
-    lv_opa_t opa = opa_scale == LV_OPA_COVER ? style->body.opa : (uint16_t)((uint16_t) style->body.opa * opa_scale) >> 8;
-    for(line = 0; line < filter_width; line++) {
-        line_1d_blur[line] = (uint32_t)((uint32_t)(filter_width - line) * (opa * 2)  << SHADOW_OPA_EXTRA_PRECISION) / (filter_width * filter_width);
-    }
-
-    uint16_t col;
-#if LV_COMPILER_VLA_SUPPORTED
-    lv_opa_t line_2d_blur[radius + swidth + 1];
-#else
-# if LV_HOR_RES > LV_VER_RES
-    lv_opa_t line_2d_blur[LV_HOR_RES];
-# else
-    lv_opa_t line_2d_blur[LV_VER_RES];
-# endif
-#endif
-
     lv_point_t point_rt;
     lv_point_t point_rb;
     lv_point_t point_lt;
@@ -1151,40 +1124,9 @@ static void lv_draw_shadow_full(const lv_area_t * coords, const lv_area_t * mask
 
     ofs_lt.x = coords->x1 + radius + LV_ANTIALIAS;
     ofs_lt.y = coords->y1 + radius + LV_ANTIALIAS;
-    bool line_ready;
-    for(line = 0; line <= radius + swidth; line++) {        /*Check all rows and make the 1D blur to 2D*/
-        line_ready = false;
-        for(col = 0; col <= radius + swidth; col++) {        /*Check all pixels in a 1D blur line (from the origo to last shadow pixel (radius + swidth))*/
-
-            /*Sum the opacities from the lines above and below this 'row'*/
-            int16_t line_rel;
-            uint32_t px_opa_sum = 0;
-            for(line_rel = -swidth; line_rel <= swidth; line_rel ++) {
-                /*Get the relative x position of the 'line_rel' to 'line'*/
-                int16_t col_rel;
-                if(line + line_rel < 0) {                       /*Below the radius, here is the blur of the edge */
-                    col_rel = radius - curve_x[line] - col;
-                } else if(line + line_rel > radius) {           /*Above the radius, here won't be more 1D blur*/
-                    break;
-                } else {                                        /*Blur from the curve*/
-                    col_rel = curve_x[line + line_rel] - curve_x[line] - col;
-                }
-
-                /*Add the value of the 1D blur on 'col_rel' position*/
-                if(col_rel < -swidth) {                         /*Outside of the blurred area. */
-                    if(line_rel == -swidth) line_ready = true;  /*If no data even on the very first line then it wont't be anything else in this line*/
-                    break;                                      /*Break anyway because only smaller 'col_rel' values will come */
-                } else if(col_rel > swidth) px_opa_sum += line_1d_blur[0];      /*Inside the not blurred area*/
-                else px_opa_sum += line_1d_blur[swidth - col_rel];              /*On the 1D blur (+ swidth to align to the center)*/
-            }
-
-            line_2d_blur[col] = px_opa_sum >> SHADOW_OPA_EXTRA_PRECISION;
-            if(line_ready) {
-                col++;      /*To make this line to the last one ( drawing will go to '< col')*/
-                break;
-            }
-
-        }
+    for(line = 0; line <= radius + swidth; line++) {        /*Draw the blurred lines of the profile*/
+        const lv_opa_t * line_2d_blur = &profile->blur[line * (radius + swidth + 1)];
+        uint16_t col = profile->cols[line];
 
         /*Flush the line*/
         point_rt.x = curve_x[line] + ofs_rt.x + 1;
@@ -1230,6 +1172,8 @@ static void lv_draw_shadow_full(const lv_area_t * coords, const lv_area_t * mask
          * but is is simple, fast and gives a good enough result*/
         if(line == 0) lv_draw_shadow_full_straight(coords, mask, style, line_2d_blur);
     }
+
+    lv_shadow_profile_release(profile);
 }
 
 
@@ -1241,41 +1185,16 @@ static void lv_draw_shadow_bottom(const lv_area_t * coords, const lv_area_t * ma
     lv_coord_t height = lv_area_get_height(coords);
 
     radius = lv_draw_cont_radius_corr(radius, width, height);
+
+    lv_opa_t opa = opa_scale == LV_OPA_COVER ? style->body.opa : (uint16_t)((uint16_t) style->body.opa * opa_scale) >> 8;
+    lv_shadow_profile_t * profile = lv_shadow_profile_get(LV_SHADOW_BOTTOM, radius, swidth, opa);
+
     radius += LV_ANTIALIAS * SHADOW_BOTTOM_AA_EXTRA_RADIUS;
     swidth += LV_ANTIALIAS;
-#if LV_COMPILER_VLA_SUPPORTED
-    lv_coord_t curve_x[radius + 1];             /*Stores the 'x' coordinates of a quarter circle.*/
-#else
-# if LV_HOR_RES > LV_VER_RES
-    lv_coord_t curve_x[LV_HOR_RES];
-# else
-    lv_coord_t curve_x[LV_VER_RES];
-# endif
-#endif
-    lv_point_t circ;
-    lv_coord_t circ_tmp;
-    lv_circ_init(&circ, &circ_tmp, radius);
-    while(lv_circ_cont(&circ)) {
-        curve_x[LV_CIRC_OCT1_Y(circ)] = LV_CIRC_OCT1_X(circ);
-        curve_x[LV_CIRC_OCT2_Y(circ)] = LV_CIRC_OCT2_X(circ);
-        lv_circ_next(&circ, &circ_tmp);
-    }
 
+    const lv_coord_t * curve_x = profile->curve_x;
+    const lv_opa_t * line_1d_blur = profile->blur;
     int16_t col;
-#if LV_COMPILER_VLA_SUPPORTED
-    lv_opa_t line_1d_blur[swidth];
-#else
-# if LV_HOR_RES > LV_VER_RES
-    lv_opa_t line_1d_blur[LV_HOR_RES];
-# else
-    lv_opa_t line_1d_blur[LV_VER_RES];
-# endif
-#endif
-
-    lv_opa_t opa = opa_scale == LV_OPA_COVER ? style->body.opa : (uint16_t)((uint16_t) style->body.opa * opa_scale) >> 8;
-    for(col = 0; col < swidth; col++) {
-        line_1d_blur[col] = (uint32_t)((uint32_t)(swidth - col) * opa / 2) / (swidth);
-    }
 
     lv_point_t point_l;
     lv_point_t point_r;
@@ -1304,7 +1223,8 @@ static void lv_draw_shadow_bottom(const lv_area_t * coords, const lv_area_t * ma
             if(diff == 0) {
                 px_opa = line_1d_blur[d];
             } else {
-                px_opa = (uint16_t)((uint16_t)line_1d_blur[d] + line_1d_blur[d - diff]) >> 1;
+                /*The previous column starts above this one. Use its first pixel there*/
+                px_opa = (uint16_t)((uint16_t)line_1d_blur[d] + line_1d_blur[d < diff ? 0 : d - diff]) >> 1;
             }
             px_fp(point_l.x, point_l.y, mask, style->body.shadow.color, px_opa);
             point_l.y ++;
@@ -1329,6 +1249,216 @@ static void lv_draw_shadow_bottom(const lv_area_t * coords, const lv_area_t * ma
         area_mid.y1 ++;
         area_mid.y2 ++;
     }
+
+    lv_shadow_profile_release(profile);
+}
+
+/**
+ * Calculate the blurred lines of a full shadow corner
+ * @param profile the profile to fill. `radius`, `swidth` and `opa` are set and the buffers allocated.
+ */
+static void lv_shadow_profile_calc_full(lv_shadow_profile_t * profile)
+{
+
+    /* KNOWN ISSUE
+     * The algorithm calculates the shadow only above the middle point of the radius (speaking about the left top corner).
+     * It causes an error because it doesn't consider how long the straight edge is which effects the value of bottom of the corner shadow.
+     * In addition the straight shadow is drawn from the middles point of the radius however
+     * the ends of the straight parts still should be effected by the corner shadow.
+     * It also causes an issue in opacity. A smaller radius means smaller average shadow opacity.
+     * The solution should be to start `line` from `- swidth` and handle if the straight part is short (or zero) and the value is taken from
+     * the other corner. `col` also should start from `- swidth`
+     */
+
+    lv_coord_t radius = profile->radius + LV_ANTIALIAS;
+    lv_coord_t swidth = profile->swidth;
+    lv_opa_t opa = profile->opa;
+
+    lv_coord_t * curve_x = profile->curve_x;     /*Stores the 'x' coordinates of a quarter circle.*/
+    memset(curve_x, 0, (radius + swidth + 1) * sizeof(lv_coord_t));
+    lv_point_t circ;
+    lv_coord_t circ_tmp;
+    lv_circ_init(&circ, &circ_tmp, radius);
+    while(lv_circ_cont(&circ)) {
+        curve_x[LV_CIRC_OCT1_Y(circ)] = LV_CIRC_OCT1_X(circ);
+        curve_x[LV_CIRC_OCT2_Y(circ)] = LV_CIRC_OCT2_X(circ);
+        lv_circ_next(&circ, &circ_tmp);
+    }
+    int16_t line;
+
+    int16_t filter_width = 2 * swidth + 1;
+#if LV_COMPILER_VLA_SUPPORTED
+    uint32_t line_1d_blur[filter_width];
+#else
+# if LV_HOR_RES > LV_VER_RES
+    uint32_t line_1d_blur[LV_HOR_RES];
+# else
+    uint32_t line_1d_blur[LV_VER_RES];
+# endif
+#endif
+    /*1D Blur horizontally*/
+    for(line = 0; line < filter_width; line++) {
+        line_1d_blur[line] = (uint32_t)((uint32_t)(filter_width - line) * (opa * 2)  << SHADOW_OPA_EXTRA_PRECISION) / (filter_width * filter_width);
+    }
+
+    uint16_t col;
+    bool line_ready;
+    for(line = 0; line <= radius + swidth; line++) {        /*Check all rows and make the 1D blur to 2D*/
+        lv_opa_t * line_2d_blur = &profile->blur[line * (radius + swidth + 1)];
+        line_ready = false;
+        for(col = 0; col <= radius + swidth; col++) {        /*Check all pixels in a 1D blur line (from the origo to last shadow pixel (radius + swidth))*/
+
+            /*Sum the opacities from the lines above and below this 'row'*/
+            int16_t line_rel;
+            uint32_t px_opa_sum = 0;
+            for(line_rel = -swidth; line_rel <= swidth; line_rel ++) {
+                /*Get the relative x position of the 'line_rel' to 'line'*/
+                int16_t col_rel;
+                if(line + line_rel < 0) {                       /*Below the radius, here is the blur of the edge */
+                    col_rel = radius - curve_x[line] - col;
+                } else if(line + line_rel > radius) {           /*Above the radius, here won't be more 1D blur*/
+                    break;
+                } else {                                        /*Blur from the curve*/
+                    col_rel = curve_x[line + line_rel] - curve_x[line] - col;
+                }
+
+                /*Add the value of the 1D blur on 'col_rel' position*/
+                if(col_rel < -swidth) {                         /*Outside of the blurred area. */
+                    if(line_rel == -swidth) line_ready = true;  /*If no data even on the very first line then it wont't be anything else in this line*/
+                    break;                                      /*Break anyway because only smaller 'col_rel' values will come */
+                } else if(col_rel > swidth) px_opa_sum += line_1d_blur[0];      /*Inside the not blurred area*/
+                else px_opa_sum += line_1d_blur[swidth - col_rel];              /*On the 1D blur (+ swidth to align to the center)*/
+            }
+
+            line_2d_blur[col] = px_opa_sum >> SHADOW_OPA_EXTRA_PRECISION;
+            if(line_ready) {
+                col++;      /*To make this line to the last one ( drawing will go to '< col')*/
+                break;
+            }
+
+        }
+
+        profile->cols[line] = col;
+    }
+}
+
+/**
+ * Calculate the corner curve and 1D blur of a bottom shadow
+ * @param profile the profile to fill. `radius`, `swidth` and `opa` are set and the buffers allocated.
+ */
+static void lv_shadow_profile_calc_bottom(lv_shadow_profile_t * profile)
+{
+    lv_coord_t radius = profile->radius + LV_ANTIALIAS * SHADOW_BOTTOM_AA_EXTRA_RADIUS;
+    lv_coord_t swidth = profile->swidth + LV_ANTIALIAS;
+    lv_opa_t opa = profile->opa;
+
+    lv_coord_t * curve_x = profile->curve_x;     /*Stores the 'x' coordinates of a quarter circle.*/
+    memset(curve_x, 0, (radius + 1) * sizeof(lv_coord_t));
+    lv_point_t circ;
+    lv_coord_t circ_tmp;
+    lv_circ_init(&circ, &circ_tmp, radius);
+    while(lv_circ_cont(&circ)) {
+        curve_x[LV_CIRC_OCT1_Y(circ)] = LV_CIRC_OCT1_X(circ);
+        curve_x[LV_CIRC_OCT2_Y(circ)] = LV_CIRC_OCT2_X(circ);
+        lv_circ_next(&circ, &circ_tmp);
+    }
+
+    int16_t col;
+    for(col = 0; col < swidth; col++) {
+        profile->blur[col] = (uint32_t)((uint32_t)(swidth - col) * opa / 2) / (swidth);
+    }
+}
+
+/**
+ * Get the profile of a shadow from the cache or calculate it.
+ * The least recently used profiles are dropped to stay in `LV_SHADOW_CACHE_SIZE`.
+ * @param type LV_SHADOW_FULL or LV_SHADOW_BOTTOM
+ * @param radius corrected radius of the object
+ * @param swidth shadow width
+ * @param opa shadow opacity
+ * @return pointer to the profile. Release it with `lv_shadow_profile_release`.
+ */
+static lv_shadow_profile_t * lv_shadow_profile_get(uint8_t type, lv_coord_t radius, lv_coord_t swidth, lv_opa_t opa)
+{
+#if LV_SHADOW_CACHE_SIZE
+    uint32_t i;
+    for(i = 0; i < SHADOW_CACHE_ENTRIES; i++) {
+        lv_shadow_profile_t * profile = shadow_cache[i];
+        if(profile && profile->type == type && profile->radius == radius &&
+                profile->swidth == swidth && profile->opa == opa) {
+            profile->last_use = ++shadow_cache_tick;
+            return profile;
+        }
+    }
+#endif
+
+    /*Get the sizes of the buffers*/
+    uint32_t curve_len;
+    uint32_t cols_len = 0;
+    uint32_t blur_len;
+    if(type == LV_SHADOW_FULL) {
+        lv_coord_t len = radius + LV_ANTIALIAS + swidth + 1;
+        curve_len = len;
+        cols_len = len;
+        blur_len = len * len;
+    } else {
+        curve_len = radius + LV_ANTIALIAS * SHADOW_BOTTOM_AA_EXTRA_RADIUS + 1;
+        blur_len = swidth + LV_ANTIALIAS;
+    }
+
+    uint32_t size = sizeof(lv_shadow_profile_t) + (curve_len + cols_len) * sizeof(uint16_t) + blur_len;
+    lv_shadow_profile_t * profile = lv_mem_alloc(size);
+    lv_mem_assert(profile);
+
+    profile->type = type;
+    profile->opa = opa;
+    profile->radius = radius;
+    profile->swidth = swidth;
+    profile->size = size;
+    profile->cached = false;
+    profile->curve_x = (lv_coord_t *)(profile + 1);
+    profile->cols = (uint16_t *)(profile->curve_x + curve_len);
+    profile->blur = (lv_opa_t *)(profile->cols + cols_len);
+
+    if(type == LV_SHADOW_FULL) lv_shadow_profile_calc_full(profile);
+    else lv_shadow_profile_calc_bottom(profile);
+
+#if LV_SHADOW_CACHE_SIZE
+    if(size > LV_SHADOW_CACHE_SIZE) return profile;
+
+    /*Make room by dropping the least recently used profiles*/
+    while(true) {
+        uint32_t free_slot = SHADOW_CACHE_ENTRIES;
+        uint32_t lru = SHADOW_CACHE_ENTRIES;
+        for(i = 0; i < SHADOW_CACHE_ENTRIES; i++) {
+            if(shadow_cache[i] == NULL) free_slot = i;
+            else if(lru == SHADOW_CACHE_ENTRIES || shadow_cache[i]->last_use < shadow_cache[lru]->last_use) lru = i;
+        }
+
+        if(free_slot != SHADOW_CACHE_ENTRIES && shadow_cache_size + size <= LV_SHADOW_CACHE_SIZE) {
+            profile->cached = true;
+            profile->last_use = ++shadow_cache_tick;
+            shadow_cache[free_slot] = profile;
+            shadow_cache_size += size;
+            break;
+        }
+
+        shadow_cache_size -= shadow_cache[lru]->size;
+        lv_mem_free(shadow_cache[lru]);
+        shadow_cache[lru] = NULL;
+    }
+#endif
+
+    return profile;
+}
+
+/**
+ * Release a shadow profile got with `lv_shadow_profile_get`
+ * @param profile pointer to the profile
+ */
+static void lv_shadow_profile_release(lv_shadow_profile_t * profile)
+{
+    if(!profile->cached) lv_mem_free(profile);
 }
 
 static void lv_draw_shadow_full_straight(const lv_area_t * coords, const lv_area_t * mask, const lv_style_t * style, const lv_opa_t * map)
@@ -42,7 +42,7 @@ lv_font_t hekate_symbol_120 =
     .unicode_first = LV_SYMBOL_GLYPH_FIRST,	/*First Unicode letter in this font*/
     .unicode_last = LV_SYMBOL_GLYPH_LAST,	/*Last Unicode letter in this font*/
     .h_px = 120,				/*Font height in pixels*/
-    .glyph_bitmap = (const uint8_t *)(NYX_RES_ADDR + 0x36E00),	/*Bitmap of glyphs*/
+    .glyph_bitmap = (const uint8_t *)(NYX_RES_ADDR + NYX_RES_SYMBOL_120_OFF),	/*Bitmap of glyphs*/
     .glyph_dsc = hekate_symbol_120_glyph_dsc,		/*Description of glyphs*/
     .glyph_cnt = 4,			/*Number of glyphs in the font*/
     .unicode_list = NULL,	/*List of unicode characters*/
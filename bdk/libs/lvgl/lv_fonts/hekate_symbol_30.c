@@ -141,7 +141,7 @@ lv_font_t hekate_symbol_30 =
     .unicode_last = LV_SYMBOL_GLYPH_LAST,	/*Last Unicode letter in this font*/
     .h_px = 30,				/*Font height in pixels*/
     //.glyph_bitmap = hekate_symbol_30_glyph_bitmap,	/*Bitmap of glyphs*/
-    .glyph_bitmap = (const uint8_t *)(NYX_RES_ADDR + 0x14200),
+    .glyph_bitmap = (const uint8_t *)(NYX_RES_ADDR + NYX_RES_SYMBOL_30_OFF),
     .glyph_dsc = hekate_symbol_30_glyph_dsc,		/*Description of glyphs*/
     .glyph_cnt = 50,			/*Number of glyphs in the font*/
     .unicode_list = NULL,	/*List of unicode characters*/
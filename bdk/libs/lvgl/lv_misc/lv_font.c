@@ -7,24 +7,42 @@
  *      INCLUDES
  *********************/
 #include <stddef.h>
+#include <string.h>
 #include "lv_font.h"
 #include "lv_log.h"
+#include "lv_mem.h"
 
 /*********************
  *      DEFINES
  *********************/
+#define LV_FONT_CACHE_SIZE  128     /*Glyph lookup cache entries. Must be a power of 2*/
 
 /**********************
  *      TYPEDEFS
  **********************/
 
+/*A resolved glyph: the font page which has it, its width and bitmap*/
+typedef struct
+{
+    const lv_font_t * font;     /*Font the lookup was started from*/
+    const lv_font_t * page;     /*Font page containing the glyph*/
+    const uint8_t * bitmap;
+    uint32_t letter;
+    int16_t w;
+} lv_font_cache_t;
+
 /**********************
  *  STATIC PROTOTYPES
  **********************/
+static void lv_font_build_index(lv_font_t * font);
+static const lv_font_cache_t * lv_font_lookup(const lv_font_t * font_p, uint32_t letter);
+static int32_t lv_font_sparse_index(const lv_font_t * font, uint32_t unicode_letter);
 
 /**********************
  *  STATIC VARIABLES
  **********************/
+static void (*bitmap_loader)(const void *, uint32_t) = NULL;
+static lv_font_cache_t font_cache[LV_FONT_CACHE_SIZE];
 
 /**********************
  * GLOBAL PROTOTYPES
@@ -46,6 +64,17 @@ void lv_font_init(void)
     lv_font_builtin_init();
 }
 
+/**
+ * Set a callback that makes sure a glyph bitmap is loaded before it's used.
+ * Allows font bitmaps to be unpacked on demand.
+ * @param loader called with the bitmap address and size of every glyph fetched. NULL to disable.
+ */
+void lv_font_set_bitmap_loader(void (*loader)(const void *, uint32_t))
+{
+    bitmap_loader = loader;
+    memset(font_cache, 0, sizeof(font_cache));
+}
+
 /**
  * Add a font to an other to extend the character set.
  * @param child the font to add
@@ -53,6 +82,9 @@ void lv_font_init(void)
  */
 void lv_font_add(lv_font_t * child, lv_font_t * parent)
 {
+    lv_font_build_index(child);
+    memset(font_cache, 0, sizeof(font_cache));
+
     if(parent == NULL) return;
 
     while(parent->next_page != NULL) {
@@ -78,6 +110,7 @@ void lv_font_remove(lv_font_t * child, lv_font_t * parent)
     }
 
     parent->next_page = child->next_page;
+    memset(font_cache, 0, sizeof(font_cache));
 }
 
 
@@ -89,20 +122,10 @@ void lv_font_remove(lv_font_t * child, lv_font_t * parent)
  */
 bool lv_font_is_monospace(const lv_font_t * font_p, uint32_t letter)
 {
-    const lv_font_t * font_i = font_p;
-    int16_t w;
-    while(font_i != NULL) {
-        w = font_i->get_width(font_i, letter);
-        if(w >= 0) {
-            /*Glyph found*/
-            if(font_i->monospace) return true;
-            return false;
-        }
-
-        font_i = font_i->next_page;
-    }
+    const lv_font_cache_t * glyph = lv_font_lookup(font_p, letter);
+    if(glyph == NULL) return false;
 
-    return 0;
+    return glyph->page->monospace ? true : false;
 }
 
 /**
@@ -113,15 +136,10 @@ bool lv_font_is_monospace(const lv_font_t * font_p, uint32_t letter)
  */
 const uint8_t * lv_font_get_bitmap(const lv_font_t * font_p, uint32_t letter)
 {
-    const lv_font_t * font_i = font_p;
-    while(font_i != NULL) {
-        const uint8_t * bitmap = font_i->get_bitmap(font_i, letter);
-        if(bitmap) return bitmap;
-
-        font_i = font_i->next_page;
-    }
+    const lv_font_cache_t * glyph = lv_font_lookup(font_p, letter);
+    if(glyph == NULL) return NULL;
 
-    return NULL;
+    return glyph->bitmap;
 }
 
 /**
@@ -132,22 +150,13 @@ const uint8_t * lv_font_get_bitmap(const lv_font_t * font_p, uint32_t letter)
  */
 uint8_t lv_font_get_width(const lv_font_t * font_p, uint32_t letter)
 {
-    const lv_font_t * font_i = font_p;
-    int16_t w;
-    while(font_i != NULL) {
-        w = font_i->get_width(font_i, letter);
-        if(w >= 0) {
-            /*Glyph found*/
-            uint8_t m = font_i->monospace;
-            if(m) w = m;
-            return w;
-        }
+    const lv_font_cache_t * glyph = lv_font_lookup(font_p, letter);
+    if(glyph == NULL) return 0;
 
-        font_i = font_i->next_page;
-    }
-
-    return 0;
+    uint8_t m = glyph->page->monospace;
+    if(m) return m;
 
+    return glyph->w;
 }
 
 /**
@@ -158,16 +167,10 @@ uint8_t lv_font_get_width(const lv_font_t * font_p, uint32_t letter)
  */
 uint8_t lv_font_get_real_width(const lv_font_t * font_p, uint32_t letter)
 {
-    const lv_font_t * font_i = font_p;
-    int16_t w;
-    while(font_i != NULL) {
-        w = font_i->get_width(font_i, letter);
-        if(w >= 0) return w;
-
-        font_i = font_i->next_page;
-    }
+    const lv_font_cache_t * glyph = lv_font_lookup(font_p, letter);
+    if(glyph == NULL) return 0;
 
-    return 0;
+    return glyph->w;
 }
 
 /**
@@ -213,17 +216,10 @@ const uint8_t * lv_font_get_bitmap_continuous(const lv_font_t * font, uint32_t u
  */
 const uint8_t * lv_font_get_bitmap_sparse(const lv_font_t * font, uint32_t unicode_letter)
 {
-    /*Check the range*/
-    if(unicode_letter < font->unicode_first || unicode_letter > font->unicode_last) return NULL;
-
-    uint32_t i;
-    for(i = 0; font->unicode_list[i] != 0; i++) {
-        if(font->unicode_list[i] == unicode_letter) {
-            return &font->glyph_bitmap[font->glyph_dsc[i].glyph_index];
-        }
-    }
+    int32_t i = lv_font_sparse_index(font, unicode_letter);
+    if(i < 0) return NULL;
 
-    return NULL;
+    return &font->glyph_bitmap[font->glyph_dsc[i].glyph_index];
 }
 
 /**
@@ -250,20 +246,123 @@ int16_t lv_font_get_width_continuous(const lv_font_t * font, uint32_t unicode_le
  * @return width of the glyph or -1 if not found
  */
 int16_t lv_font_get_width_sparse(const lv_font_t * font, uint32_t unicode_letter)
+{
+    int32_t i = lv_font_sparse_index(font, unicode_letter);
+    if(i < 0) return -1;
+
+    return font->glyph_dsc[i].w_px;
+}
+
+/**********************
+ *   STATIC FUNCTIONS
+ **********************/
+
+/**
+ * Prepare binary search for a sparse font.
+ * A sorted `unicode_list` is searched directly, otherwise a sorted index is allocated.
+ * @param font pointer to a font
+ */
+static void lv_font_build_index(lv_font_t * font)
+{
+    if(font == NULL || font->unicode_list == NULL || font->indexed) return;
+
+    uint32_t cnt;
+    bool sorted = true;
+    for(cnt = 0; font->unicode_list[cnt] != 0; cnt++) {
+        if(cnt && font->unicode_list[cnt] <= font->unicode_list[cnt - 1]) sorted = false;
+    }
+
+    /*Keep the linear scan if the glyph count does not match the list*/
+    if(cnt != font->glyph_cnt) return;
+
+    if(!sorted) {
+        uint16_t * idx = lv_mem_alloc(cnt * sizeof(uint16_t));
+        lv_mem_assert(idx);
+
+        /*Insertion sort, done once per font*/
+        uint32_t i;
+        for(i = 0; i < cnt; i++) {
+            uint32_t j = i;
+            while(j && font->unicode_list[idx[j - 1]] > font->unicode_list[i]) {
+                idx[j] = idx[j - 1];
+                j--;
+            }
+            idx[j] = i;
+        }
+
+        font->unicode_idx = idx;
+    }
+
+    font->indexed = 1;
+}
+
+/**
+ * Find the glyph index of a letter in a sparse font.
+ * @param font pointer to font
+ * @param unicode_letter an unicode letter
+ * @return index in `unicode_list` and `glyph_dsc` or -1 if not found
+ */
+static int32_t lv_font_sparse_index(const lv_font_t * font, uint32_t unicode_letter)
 {
     /*Check the range*/
     if(unicode_letter < font->unicode_first || unicode_letter > font->unicode_last) return -1;
 
-    uint32_t i;
-    for(i = 0; font->unicode_list[i] != 0; i++) {
-        if(font->unicode_list[i] == unicode_letter) {
-            return font->glyph_dsc[i].w_px;
+    if(!font->indexed) {
+        uint32_t i;
+        for(i = 0; font->unicode_list[i] != 0; i++) {
+            if(font->unicode_list[i] == unicode_letter) return i;
         }
+
+        return -1;
+    }
+
+    int32_t first = 0;
+    int32_t last = font->glyph_cnt - 1;
+    while(first <= last) {
+        int32_t mid = (first + last) / 2;
+        int32_t i = font->unicode_idx ? font->unicode_idx[mid] : mid;
+        uint32_t unicode = font->unicode_list[i];
+
+        if(unicode == unicode_letter) return i;
+        else if(unicode < unicode_letter) first = mid + 1;
+        else last = mid - 1;
     }
 
     return -1;
 }
 
-/**********************
- *   STATIC FUNCTIONS
- **********************/
+/**
+ * Find the font page with a letter, through a direct mapped cache.
+ * The bitmap loader runs once, when the glyph enters the cache.
+ * @param font_p pointer to a font
+ * @param letter an UNICODE character code
+ * @return the resolved glyph or NULL if no page has the letter
+ */
+static const lv_font_cache_t * lv_font_lookup(const lv_font_t * font_p, uint32_t letter)
+{
+    if(font_p == NULL) return NULL;
+
+    uint32_t slot = (letter ^ ((uintptr_t)font_p >> 4)) & (LV_FONT_CACHE_SIZE - 1);
+    lv_font_cache_t * glyph = &font_cache[slot];
+    if(glyph->font == font_p && glyph->letter == letter) return glyph;
+
+    const lv_font_t * font_i = font_p;
+    while(font_i != NULL) {
+        int16_t w = font_i->get_width(font_i, letter);
+        if(w >= 0) {
+            /*Glyph found*/
+            glyph->font = font_p;
+            glyph->page = font_i;
+            glyph->letter = letter;
+            glyph->w = w;
+            glyph->bitmap = font_i->get_bitmap(font_i, letter);
+            if(glyph->bitmap && bitmap_loader) bitmap_loader(glyph->bitmap, ((w * font_i->bpp + 7) >> 3) * font_i->h_px);
+
+            return glyph;
+        }
+
+        font_i = font_i->next_page;
+    }
+
+    return NULL;
+}
@@ -52,12 +52,14 @@ typedef struct _lv_font_struct
     const uint8_t * glyph_bitmap;
     const lv_font_glyph_dsc_t * glyph_dsc;
     const uint32_t * unicode_list;
+    const uint16_t * unicode_idx;          /*Glyph indexes sorted by unicode if `unicode_list` is not sorted*/
     const uint8_t * (*get_bitmap)(const struct _lv_font_struct *,uint32_t);     /*Get a glyph's  bitmap from a font*/
     int16_t (*get_width)(const struct _lv_font_struct *,uint32_t);        /*Get a glyph's with with a given font*/
     struct _lv_font_struct * next_page;    /*Pointer to a font extension*/
     uint32_t h_px       :8;
     uint32_t bpp        :4;                /*Bit per pixel: 1, 2 or 4*/
     uint32_t monospace  :8;                /*Fix width (0: normal width)*/
+    uint32_t indexed    :1;                /*Sparse lookups can binary search (set by `lv_font_add`)*/
     uint16_t glyph_cnt;                    /*Number of glyphs (letters) in the font*/
 } lv_font_t;
 
@@ -70,6 +72,12 @@ typedef struct _lv_font_struct
  */
 void lv_font_init(void);
 
+/**
+ * Set a callback that makes sure a glyph bitmap is loaded before it's used.
+ * @param loader called with the bitmap address and size of every glyph fetched. NULL to disable.
+ */
+void lv_font_set_bitmap_loader(void (*loader)(const void *, uint32_t));
+
 /**
  * Add a font to an other to extend the character set.
  * @param child the font to add
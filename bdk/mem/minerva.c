@@ -18,19 +18,87 @@
 #include <stdlib.h>
 
 #include "minerva.h"
+#include "minerva_cache.h"
 
 #include <soc/clock.h>
 #include <ianos/ianos.h>
+#include <libs/fatfs/ff.h>
+#include <mem/heap.h>
 #include <soc/clock.h>
 #include <soc/fuse.h>
 #include <soc/hw_init.h>
 #include <soc/t210.h>
+#include <storage/nx_sd.h>
 #include <utils/util.h>
 
+#define MINERVA_LIB_PATH   "bootloader/sys/libsys_minerva.bso"
+#define MINERVA_CACHE_PATH "bootloader/sys/mtc_cache.bin"
+
 extern volatile nyx_storage_t *nyx_str;
 
 void (*minerva_cfg)(mtc_config_t *mtc_cfg, void *);
 
+static bool _minerva_cache_key(mtc_cache_key_t *key, mtc_config_t *mtc_cfg)
+{
+	memset(key, 0, sizeof(mtc_cache_key_t));
+
+	key->sdram_id = mtc_cfg->sdram_id;
+	key->hidrev = APB_MISC(APB_MISC_GP_HIDREV);
+	key->lot_code = FUSE(FUSE_OPT_LOT_CODE_0);
+	key->wafer_id = FUSE(FUSE_OPT_WAFER_ID);
+	key->x_coord = FUSE(FUSE_OPT_X_COORDINATE);
+	key->y_coord = FUSE(FUSE_OPT_Y_COORDINATE);
+	key->soc_speedo = FUSE(FUSE_SOC_SPEEDO_0_CALIB);
+	key->table_entries = mtc_cfg->table_entries;
+
+	// Module is identified by the hash of the image ianos already read.
+	key->module_crc32 = ianos_get_crc32();
+
+	return key->module_crc32 != 0;
+}
+
+static bool _minerva_cache_load(const mtc_cache_key_t *key, mtc_config_t *mtc_cfg)
+{
+	FIL fp;
+	bool res = false;
+
+	if (f_open(&fp, MINERVA_CACHE_PATH, FA_READ))
+		return false;
+
+	// Check size first, so a stale cache is not read in full.
+	u32 size = f_size(&fp);
+	if (size != mtc_cache_size(key->table_entries))
+		goto out;
+
+	void *buf = malloc(size);
+	if (!f_read(&fp, buf, size, NULL) && mtc_cache_check(buf, size, key) == MTC_CACHE_OK)
+	{
+		memcpy(mtc_cfg->mtc_table, mtc_cache_get_tables(buf), key->table_entries * sizeof(emc_table_t));
+		res = true;
+	}
+	free(buf);
+
+out:
+	f_close(&fp);
+
+	return res;
+}
+
+static void _minerva_cache_save(const mtc_cache_key_t *key, mtc_config_t *mtc_cfg)
+{
+	FIL fp;
+
+	if (f_open(&fp, MINERVA_CACHE_PATH, FA_CREATE_ALWAYS | FA_WRITE))
+		return;
+
+	void *buf = malloc(mtc_cache_size(key->table_entries));
+	u32 size = mtc_cache_build(buf, key, mtc_cfg->mtc_table);
+	f_write(&fp, buf, size, NULL);
+	f_close(&fp);
+
+	free(buf);
+}
+
 u32 minerva_init()
 {
 	u32 curr_ram_idx = 0;
@@ -50,7 +118,7 @@ u32 minerva_init()
 	if (mtc_cfg->init_done == MTC_INIT_MAGIC)
 	{
 		mtc_cfg->train_mode = OP_PERIODIC_TRAIN; // Retrain if needed.
-		u32 ep_addr = ianos_loader("bootloader/sys/libsys_minerva.bso", DRAM_LIB, (void *)mtc_cfg);
+		u32 ep_addr = ianos_loader(MINERVA_LIB_PATH, DRAM_LIB, (void *)mtc_cfg);
 		minerva_cfg = (void *)ep_addr;
 
 		return !minerva_cfg ? 1 : 0;
@@ -63,7 +131,7 @@ u32 minerva_init()
 		mtc_tmp.sdram_id = (fuse_read_odm(4) >> 3) & 0x1F;
 		mtc_tmp.init_done = MTC_NEW_MAGIC;
 
-		u32 ep_addr = ianos_loader("bootloader/sys/libsys_minerva.bso", DRAM_LIB, (void *)&mtc_tmp);
+		u32 ep_addr = ianos_loader(MINERVA_LIB_PATH, DRAM_LIB, (void *)&mtc_tmp);
 
 		// Ensure that Minerva is new.
 		if (mtc_tmp.init_done == MTC_INIT_MAGIC)
@@ -84,7 +152,7 @@ u32 minerva_init()
 	mtc_cfg->sdram_id = (fuse_read_odm(4) >> 3) & 0x1F;
 	mtc_cfg->init_done = MTC_NEW_MAGIC; // Initialize mtc table.
 
-	u32 ep_addr = ianos_loader("bootloader/sys/libsys_minerva.bso", DRAM_LIB, (void *)mtc_cfg);
+	u32 ep_addr = ianos_loader(MINERVA_LIB_PATH, DRAM_LIB, (void *)mtc_cfg);
 
 	// Ensure that Minerva is new.
 	if (mtc_cfg->init_done == MTC_INIT_MAGIC)
@@ -104,13 +172,23 @@ u32 minerva_init()
 	}
 
 	mtc_cfg->rate_from = mtc_cfg->mtc_table[curr_ram_idx].rate_khz;
-	mtc_cfg->rate_to = 204000;
-	mtc_cfg->train_mode = OP_TRAIN;
-	minerva_cfg(mtc_cfg, NULL);
-	mtc_cfg->rate_to = 800000;
-	minerva_cfg(mtc_cfg, NULL);
-	mtc_cfg->rate_to = 1600000;
-	minerva_cfg(mtc_cfg, NULL);
+
+	// Use cached training results if they match this DRAM, SoC and module. Otherwise train.
+	mtc_cache_key_t key;
+	bool key_valid = _minerva_cache_key(&key, mtc_cfg);
+	if (!key_valid || !_minerva_cache_load(&key, mtc_cfg))
+	{
+		mtc_cfg->rate_to = 204000;
+		mtc_cfg->train_mode = OP_TRAIN;
+		minerva_cfg(mtc_cfg, NULL);
+		mtc_cfg->rate_to = 800000;
+		minerva_cfg(mtc_cfg, NULL);
+		mtc_cfg->rate_to = 1600000;
+		minerva_cfg(mtc_cfg, NULL);
+
+		if (key_valid)
+			_minerva_cache_save(&key, mtc_cfg);
+	}
 
 	// FSP WAR.
 	mtc_cfg->train_mode = OP_SWITCH;
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "minerva_cache.h"
+#include <utils/util.h>
+
+u32 mtc_cache_size(u32 table_entries)
+{
+	return sizeof(mtc_cache_hdr_t) + table_entries * sizeof(emc_table_t);
+}
+
+u32 mtc_cache_build(void *buf, const mtc_cache_key_t *key, const emc_table_t *tables)
+{
+	mtc_cache_hdr_t *hdr = (mtc_cache_hdr_t *)buf;
+	u32 tables_size = key->table_entries * sizeof(emc_table_t);
+
+	memcpy((u8 *)buf + sizeof(mtc_cache_hdr_t), tables, tables_size);
+
+	hdr->magic = MTC_CACHE_MAGIC;
+	hdr->version = MTC_CACHE_VERSION;
+	hdr->size = mtc_cache_size(key->table_entries);
+	hdr->crc32 = crc32_calc(0, (const u8 *)buf + sizeof(mtc_cache_hdr_t), tables_size);
+	memcpy(&hdr->key, key, sizeof(mtc_cache_key_t));
+
+	return hdr->size;
+}
+
+int mtc_cache_check(const void *buf, u32 size, const mtc_cache_key_t *key)
+{
+	const mtc_cache_hdr_t *hdr = (const mtc_cache_hdr_t *)buf;
+
+	if (!buf || size < sizeof(mtc_cache_hdr_t))
+		return MTC_CACHE_ERR_SIZE;
+
+	if (hdr->magic != MTC_CACHE_MAGIC || hdr->version != MTC_CACHE_VERSION)
+		return MTC_CACHE_ERR_MAGIC;
+
+	// Any hardware or module change invalidates the trained values.
+	if (memcmp(&hdr->key, key, sizeof(mtc_cache_key_t)))
+		return MTC_CACHE_ERR_KEY;
+
+	if (hdr->size != size || size != mtc_cache_size(key->table_entries))
+		return MTC_CACHE_ERR_SIZE;
+
+	u32 crc = crc32_calc(0, (const u8 *)buf + sizeof(mtc_cache_hdr_t), size - sizeof(mtc_cache_hdr_t));
+	if (hdr->crc32 != crc)
+		return MTC_CACHE_ERR_CRC;
+
+	return MTC_CACHE_OK;
+}
+
+const emc_table_t *mtc_cache_get_tables(const void *buf)
+{
+	return (const emc_table_t *)((const u8 *)buf + sizeof(mtc_cache_hdr_t));
+}
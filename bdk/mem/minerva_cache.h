@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MINERVA_CACHE_H_
+#define _MINERVA_CACHE_H_
+
+#include "mtc_table.h"
+#include <utils/types.h>
+
+// Trained MTC tables cache. Only valid for the DRAM, SoC and Minerva module it was made with.
+
+#define MTC_CACHE_MAGIC   0x4843544D // "MTCH".
+#define MTC_CACHE_VERSION 3
+
+enum
+{
+	MTC_CACHE_OK        = 0,
+	MTC_CACHE_ERR_SIZE  = 1,
+	MTC_CACHE_ERR_MAGIC = 2,
+	MTC_CACHE_ERR_KEY   = 3,
+	MTC_CACHE_ERR_CRC   = 4
+};
+
+typedef struct _mtc_cache_key_t
+{
+	u32 sdram_id;
+	u32 hidrev;
+	u32 lot_code;
+	u32 wafer_id;
+	u32 x_coord;
+	u32 y_coord;
+	u32 soc_speedo;
+	u32 table_entries;
+	u32 module_crc32; // libsys_minerva.bso CRC32.
+} mtc_cache_key_t;
+
+typedef struct _mtc_cache_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 size;  // Header and tables.
+	u32 crc32; // Of tables.
+	mtc_cache_key_t key;
+} mtc_cache_hdr_t;
+
+u32 mtc_cache_size(u32 table_entries);
+u32 mtc_cache_build(void *buf, const mtc_cache_key_t *key, const emc_table_t *tables);
+int mtc_cache_check(const void *buf, u32 size, const mtc_cache_key_t *key);
+const emc_table_t *mtc_cache_get_tables(const void *buf);
+
+#endif
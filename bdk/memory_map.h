@@ -67,6 +67,16 @@
 #define NYX_RES_ADDR     0xEE000000
 #define  NYX_RES_SZ       0x1000000 // 16MB.
 
+// Nyx resources layout. The Nyx build splits res.pak on these, one entry per resource.
+#define  NYX_RES_UBUNTU_MONO_OFF  0x0
+#define  NYX_RES_INTERUI_20_OFF   0x3A00
+#define  NYX_RES_INTERUI_30_OFF   0x7900
+#define  NYX_RES_SYMBOL_20_OFF    0xFC00
+#define  NYX_RES_SYMBOL_30_OFF    0x14200
+#define  NYX_RES_HEKATE_LOGO_OFF  0x1D900
+#define  NYX_RES_CTCAER_LOGO_OFF  0x2BF00
+#define  NYX_RES_SYMBOL_120_OFF   0x36E00
+
 // SDMMC DMA buffers 2
 #define SDXC_BUF_ALIGNED   0xEF000000
 #define MIXD_BUF_ALIGNED   0xF0000000
@@ -93,6 +103,14 @@
 /* ---   Hole: 129MB 0xF6A00000 - 0xFEB3FFFF --- */
 #define DRAM_START2       0xFEB40000
 
+// SDMMC ADMA2 descriptor tables.
+#define SDMMC_ADMA_ADDR   0xFEB40000
+#define  SDMMC_ADMA_SZ      0x4000 // 16KB per controller.
+
+// SDMMC bounce buffers for unaligned head and tail bytes.
+#define SDMMC_BOUNCE_ADDR 0xFEB50000
+#define  SDMMC_BOUNCE_SZ     0x100 // Per controller.
+
 // NX BIS driver sector cache.
 #define NX_BIS_CACHE_ADDR 0xFEE00000
 #define  NX_BIS_CACHE_SZ    0x100000
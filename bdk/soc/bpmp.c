@@ -23,6 +23,7 @@
 #include <utils/util.h>
 
 #define BPMP_MMU_CACHE_LINE_SIZE        0x20
+#define BPMP_MMU_MAINT_RANGE_MAX        0x4000 // Bigger ranges use a whole cache operation.
 
 #define BPMP_CACHE_CONFIG               0x0
 #define  CFG_ENABLE_CACHE               BIT(0)
@@ -124,11 +125,8 @@ bpmp_mmu_entry_t mmu_entries[] =
 	{ IRAM_BASE,  0x4003FFFF, MMU_EN_READ | MMU_EN_WRITE | MMU_EN_EXEC | MMU_EN_CACHED, true }
 };
 
-void bpmp_mmu_maintenance(u32 op, bool force)
+static void _bpmp_mmu_maintenance_req(u32 op)
 {
-	if (!force && !(BPMP_CACHE_CTRL(BPMP_CACHE_CONFIG) & CFG_ENABLE_CACHE))
-		return;
-
 	BPMP_CACHE_CTRL(BPMP_CACHE_INT_CLEAR) = INT_MAINT_DONE;
 
 	// This is a blocking operation.
@@ -140,6 +138,48 @@ void bpmp_mmu_maintenance(u32 op, bool force)
 	BPMP_CACHE_CTRL(BPMP_CACHE_INT_CLEAR) = BPMP_CACHE_CTRL(BPMP_CACHE_INT_RAW_EVENT);
 }
 
+void bpmp_mmu_maintenance(u32 op, bool force)
+{
+	if (!force && !(BPMP_CACHE_CTRL(BPMP_CACHE_CONFIG) & CFG_ENABLE_CACHE))
+		return;
+
+	_bpmp_mmu_maintenance_req(op);
+}
+
+void bpmp_mmu_maintenance_range(u32 op, u32 addr, u32 size)
+{
+	if (!size || !(BPMP_CACHE_CTRL(BPMP_CACHE_CONFIG) & CFG_ENABLE_CACHE))
+		return;
+
+	// A whole cache operation is faster than walking big ranges line by line.
+	// Lines outside of the range must not be dropped without being written back.
+	if (size > BPMP_MMU_MAINT_RANGE_MAX)
+	{
+		if (op == BPMP_MMU_MAINT_CLEAN_PHY)
+			_bpmp_mmu_maintenance_req(BPMP_MMU_MAINT_CLEAN_WAY);
+		else
+			_bpmp_mmu_maintenance_req(BPMP_MMU_MAINT_CLN_INV_WAY);
+		return;
+	}
+
+	u32 end = addr + size;
+	u32 line = addr & ~(BPMP_MMU_CACHE_LINE_SIZE - 1);
+	u32 lines = (((end - 1) & ~(BPMP_MMU_CACHE_LINE_SIZE - 1)) - line) / BPMP_MMU_CACHE_LINE_SIZE + 1;
+
+	while (lines--)
+	{
+		// Partial lines also hold data outside of the range. Write them back before invalidation.
+		u32 line_op = op;
+		if (op == BPMP_MMU_MAINT_INVALID_PHY && (line < addr || line + BPMP_MMU_CACHE_LINE_SIZE > end))
+			line_op = BPMP_MMU_MAINT_CLEAN_INVALID_PHY;
+
+		BPMP_CACHE_CTRL(BPMP_CACHE_MAINT_ADDR) = line;
+		_bpmp_mmu_maintenance_req(line_op);
+
+		line += BPMP_MMU_CACHE_LINE_SIZE;
+	}
+}
+
 void bpmp_mmu_set_entry(int idx, bpmp_mmu_entry_t *entry, bool apply)
 {
 	if (idx > 31)
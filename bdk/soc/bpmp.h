@@ -56,6 +56,7 @@ typedef enum
 #define BPMP_CLK_DEFAULT_BOOST BPMP_CLK_HYPER_BOOST
 
 void bpmp_mmu_maintenance(u32 op, bool force);
+void bpmp_mmu_maintenance_range(u32 op, u32 addr, u32 size); // Takes *_PHY ops.
 void bpmp_mmu_set_entry(int idx, bpmp_mmu_entry_t *entry, bool apply);
 void bpmp_mmu_enable();
 void bpmp_mmu_disable();
@@ -694,6 +694,23 @@ void clock_sdmmc_get_card_clock_div(u32 *pclock, u16 *pdivisor, u32 type)
 	}
 }
 
+u32 clock_sdmmc_get_clock_source(u32 id)
+{
+	switch (id)
+	{
+	case SDMMC_1:
+		return CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_SDMMC1);
+	case SDMMC_2:
+		return CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_SDMMC2);
+	case SDMMC_3:
+		return CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_SDMMC3);
+	case SDMMC_4:
+		return CLOCK(CLK_RST_CONTROLLER_CLK_SOURCE_SDMMC4);
+	}
+
+	return 0;
+}
+
 int clock_sdmmc_is_not_reset_and_enabled(u32 id)
 {
 	return !_clock_sdmmc_is_reset(id) && _clock_sdmmc_is_enabled(id);
@@ -0,0 +1,89 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mmc_seq.h"
+#include <storage/mmc.h>
+#include <storage/sdmmc_driver.h>
+
+static int _mmc_seq_check_status(const mmc_seq_t *seq, u32 *resp)
+{
+	return seq->ops->cmd_r1(seq->ctx, MMC_SEND_STATUS, seq->rca << 16, 0, resp);
+}
+
+int mmc_seq_wait_ready(const mmc_seq_t *seq, u32 timeout_ms)
+{
+	u32 resp;
+	u32 timeout = seq->ops->get_ms() + timeout_ms;
+
+	// Card stays in programming state until the erase or flush is done.
+	while (true)
+	{
+		if (!_mmc_seq_check_status(seq, &resp))
+			return 0;
+
+		if ((resp & R1_READY_FOR_DATA) && R1_CURRENT_STATE(resp) == R1_STATE_TRAN)
+			return 1;
+
+		if (seq->ops->get_ms() > timeout)
+			return 0;
+
+		seq->ops->sleep_ms(1);
+	}
+}
+
+int mmc_seq_flush(const mmc_seq_t *seq, u32 timeout_ms)
+{
+	u32 resp;
+
+	// Flushing can outlast the controller's busy timeout. Poll status instead.
+	if (!seq->ops->cmd_r1(seq->ctx, MMC_SWITCH, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_FLUSH_CACHE, 1), 0, &resp))
+		return 0;
+
+	return mmc_seq_wait_ready(seq, timeout_ms);
+}
+
+int mmc_seq_cache_ctrl(const mmc_seq_t *seq, int enable)
+{
+	u32 resp;
+
+	if (!seq->ops->cmd_r1(seq->ctx, MMC_SWITCH, SDMMC_SWITCH(MMC_SWITCH_MODE_WRITE_BYTE, EXT_CSD_CACHE_CTRL, !!enable), 1, &resp))
+		return 0;
+
+	// A rejected switch is only reported on the next status.
+	if (!_mmc_seq_check_status(seq, &resp))
+		return 0;
+
+	return R1_CURRENT_STATE(resp) == R1_STATE_TRAN;
+}
+
+int mmc_seq_set_block_count(const mmc_seq_t *seq, u32 blkcnt, u32 *fails)
+{
+	u32 resp;
+
+	// A card that keeps rejecting it gets open-ended transfers until re-init.
+	if (*fails >= MMC_SEQ_CMD23_MAX_FAILS)
+		return 0;
+
+	if (!seq->ops->cmd_r1(seq->ctx, MMC_SET_BLOCK_COUNT, blkcnt, 0, &resp) || R1_CURRENT_STATE(resp) != R1_STATE_TRAN)
+	{
+		(*fails)++;
+		return 0;
+	}
+
+	*fails = 0;
+
+	return 1;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _MMC_SEQ_H_
+#define _MMC_SEQ_H_
+
+#include <utils/types.h>
+
+/*
+ * eMMC command sequencing for cache control, flush and pre-defined transfers.
+ * Only issues commands through mmc_seq_ops_t, so a host card model can check it.
+ */
+
+#define MMC_SEQ_CMD23_MAX_FAILS 3 // Consecutive CMD23 rejections before falling back until re-init.
+
+typedef struct _mmc_seq_ops_t
+{
+	// Issues an R1/R1b command. Returns 0 if it failed or the status has error bits.
+	int  (*cmd_r1)(void *ctx, u32 cmd, u32 arg, u32 check_busy, u32 *resp);
+	u32  (*get_ms)();
+	void (*sleep_ms)(u32 ms);
+} mmc_seq_ops_t;
+
+typedef struct _mmc_seq_t
+{
+	const mmc_seq_ops_t *ops;
+	void *ctx;
+	u32 rca;
+} mmc_seq_t;
+
+// Polls CMD13 until the card is in transfer state and ready for data.
+int mmc_seq_wait_ready(const mmc_seq_t *seq, u32 timeout_ms);
+// Writes the volatile cache back. Returns 1 when the card is done.
+int mmc_seq_flush(const mmc_seq_t *seq, u32 timeout_ms);
+// Sets EXT_CSD CACHE_CTRL. Caller must flush before disabling.
+int mmc_seq_cache_ctrl(const mmc_seq_t *seq, int enable);
+// Sends CMD23 for the next transfer. Returns 1 if it is pre-defined, 0 if it must be open-ended.
+int mmc_seq_set_block_count(const mmc_seq_t *seq, u32 blkcnt, u32 *fails);
+
+#endif
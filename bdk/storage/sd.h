@@ -24,6 +24,8 @@
 /* class 5 */
 #define SD_ERASE_WR_BLK_START    32   /* ac   [31:0] data addr   R1  */
 #define SD_ERASE_WR_BLK_END      33   /* ac   [31:0] data addr   R1  */
+#define SD_ERASE_ARG             0x00000000
+#define SD_DISCARD_ARG           0x00000001
 
 /* Application commands */
 #define SD_APP_SET_BUS_WIDTH      6   /* ac   [1:0] bus width    R1  */
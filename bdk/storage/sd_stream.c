@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "sd_stream.h"
+#include <mem/heap.h>
+
+int sd_stream_open(sd_stream_t *st, const char *path, u32 window)
+{
+	memset(st, 0, sizeof(sd_stream_t));
+
+	int res = f_open(&st->fp, path, FA_READ);
+	if (res)
+		return res;
+	st->opened = true;
+
+#if FF_USE_FASTSEEK
+	// Resolve the cluster chain once. Files with more fragments keep walking the FAT.
+	st->clmt[0] = SD_STREAM_CLMT_SZ;
+	st->fp.cltbl = st->clmt;
+	if (f_lseek(&st->fp, CREATE_LINKMAP))
+		st->fp.cltbl = NULL;
+#endif
+
+	if (window)
+	{
+		// Keep the window in whole sectors, so refills stay sector aligned in the file.
+		window = MIN(window, f_size(&st->fp));
+		st->buf_size = ALIGN(window ? window : 1, 512);
+		st->buf = (u8 *)malloc(st->buf_size);
+		if (!st->buf)
+		{
+			sd_stream_close(st);
+
+			return FR_NOT_ENOUGH_CORE;
+		}
+	}
+
+	return FR_OK;
+}
+
+static int _sd_stream_fill(sd_stream_t *st)
+{
+	UINT got = 0;
+
+	int res = f_read(&st->fp, st->buf, st->buf_size, &got);
+	st->pos = 0;
+	st->len = got;
+
+	return res;
+}
+
+int sd_stream_read(sd_stream_t *st, void *buf, u32 size, u32 *br)
+{
+	u8 *dst = (u8 *)buf;
+	u32 done = 0;
+	int res = FR_OK;
+
+	// No window. Whole reads go straight to the destination.
+	if (!st->buf)
+		return f_read(&st->fp, buf, size, br);
+
+	while (size)
+	{
+		if (st->pos == st->len)
+		{
+			// Window is empty. Big reads bypass it, as whole sectors.
+			if (size >= st->buf_size && !(f_tell(&st->fp) % 512))
+			{
+				UINT got = 0;
+				res = f_read(&st->fp, dst, size & ~511, &got);
+				dst += got;
+				done += got;
+				size -= got;
+				if (res || !got)
+					break;
+
+				continue;
+			}
+
+			res = _sd_stream_fill(st);
+			if (res || !st->len)
+				break;
+		}
+
+		u32 cnt = MIN(size, st->len - st->pos);
+		memcpy(dst, st->buf + st->pos, cnt);
+		st->pos += cnt;
+		dst += cnt;
+		done += cnt;
+		size -= cnt;
+	}
+
+	if (br)
+		*br = done;
+
+	return res;
+}
+
+// Same line split as f_gets() with FF_USE_STRFUNC 2. Needs a window.
+char *sd_stream_gets(sd_stream_t *st, char *buf, u32 len)
+{
+	u32 n = 0;
+
+	if (!st->buf || !len)
+		return NULL;
+
+	while (n < len - 1)
+	{
+		if (st->pos == st->len && (_sd_stream_fill(st) || !st->len))
+			break;
+
+		char c = st->buf[st->pos++];
+		if (c == '\r')
+			continue;
+
+		buf[n++] = c;
+		if (c == '\n')
+			break;
+	}
+	buf[n] = 0;
+
+	return n ? buf : NULL;
+}
+
+bool sd_stream_eof(sd_stream_t *st)
+{
+	return st->pos == st->len && f_eof(&st->fp);
+}
+
+void sd_stream_close(sd_stream_t *st)
+{
+	if (st->opened)
+		f_close(&st->fp);
+	st->opened = false;
+
+	free(st->buf);
+	st->buf = NULL;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SD_STREAM_H_
+#define _SD_STREAM_H_
+
+#include <libs/fatfs/ff.h>
+#include <utils/types.h>
+
+/*
+ * Sequential file reader.
+ *
+ * The cluster chain is resolved once on open, if fast seek is built in, so reads
+ * do not walk the FAT again. Without a window, reads go straight to the destination.
+ * With a window, small reads are served from it and it is refilled with one big f_read.
+ */
+
+#define SD_STREAM_WINDOW_DEF 0x100000 // 1MB.
+#define SD_STREAM_CLMT_SZ    64       // Link map for up to 31 fragments.
+
+typedef struct _sd_stream_t
+{
+	FIL fp;
+	bool opened;
+	u8 *buf;
+	u32 buf_size;
+	u32 pos; // Read position in window.
+	u32 len; // Valid bytes in window.
+#if FF_USE_FASTSEEK
+	DWORD clmt[SD_STREAM_CLMT_SZ];
+#endif
+} sd_stream_t;
+
+int   sd_stream_open(sd_stream_t *st, const char *path, u32 window);
+int   sd_stream_read(sd_stream_t *st, void *buf, u32 size, u32 *br);
+char *sd_stream_gets(sd_stream_t *st, char *buf, u32 len);
+bool  sd_stream_eof(sd_stream_t *st);
+void  sd_stream_close(sd_stream_t *st);
+
+#endif
@@ -18,8 +18,10 @@
 #include <string.h>
 #include <storage/sdmmc.h>
 #include <storage/mmc.h>
+#include <storage/mmc_seq.h>
 #include <storage/nx_sd.h>
 #include <storage/sd.h>
+#include <storage/sdmmc_telemetry.h>
 #include <memory_map.h>
 #include <gfx_utils.h>
 #include <mem/heap.h>
@@ -30,6 +32,18 @@
 
 u32 sd_power_cycle_time_start;
 
+// Max time for an eMMC cache flush in ms.
+#define SDMMC_FLUSH_TIMEOUT 30000
+
+// Max sectors per erase command.
+#define SDMMC_ERASE_MAX_SCTS 0x100000 // 512MB.
+
+// Max sectors per unaligned buffer transfer.
+#define SDMMC_UNALIGNED_MAX_SCTS 0x8000 // 16MB.
+
+// Per controller asynchronous request.
+static sdmmc_async_t _sdmmc_async[4];
+
 static inline u32 unstuff_bits(u32 *resp, u32 start, u32 size)
 {
 	const u32 mask = (size < 32 ? 1 << size : 0) - 1;
@@ -86,6 +100,24 @@ static int _sdmmc_storage_execute_cmd_type1(sdmmc_storage_t *storage, u32 cmd, u
 	return _sdmmc_storage_execute_cmd_type1_ex(storage, &tmp, cmd, arg, check_busy, expected_state, 0);
 }
 
+static int _sdmmc_storage_seq_cmd_r1(void *ctx, u32 cmd, u32 arg, u32 check_busy, u32 *resp)
+{
+	return _sdmmc_storage_execute_cmd_type1_ex((sdmmc_storage_t *)ctx, resp, cmd, arg, check_busy, 0x10, 0);
+}
+
+static const mmc_seq_ops_t _sdmmc_storage_seq_ops = {
+	.cmd_r1   = _sdmmc_storage_seq_cmd_r1,
+	.get_ms   = get_tmr_ms,
+	.sleep_ms = msleep
+};
+
+static void _sdmmc_storage_seq(sdmmc_storage_t *storage, mmc_seq_t *seq)
+{
+	seq->ops = &_sdmmc_storage_seq_ops;
+	seq->ctx = storage;
+	seq->rca = storage->rca;
+}
+
 static int _sdmmc_storage_go_idle_state(sdmmc_storage_t *storage)
 {
 	sdmmc_cmd_t cmd;
@@ -139,34 +171,171 @@ static int _sdmmc_storage_check_status(sdmmc_storage_t *storage)
 	return _sdmmc_storage_get_status(storage, &tmp, 0);
 }
 
-static int _sdmmc_storage_readwrite_ex(sdmmc_storage_t *storage, u32 *blkcnt_out, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+static int _sdmmc_storage_readwrite_start(sdmmc_async_t *req)
 {
-	u32 tmp = 0;
 	sdmmc_cmd_t cmdbuf;
 	sdmmc_req_t reqbuf;
+	sdmmc_storage_t *storage = req->storage;
+	u32 blkcnt = MIN(req->num_sectors - req->done, 0xFFFF);
 
-	sdmmc_init_cmd(&cmdbuf, is_write ? MMC_WRITE_MULTIPLE_BLOCK : MMC_READ_MULTIPLE_BLOCK, sector, SDMMC_RSP_TYPE_1, 0);
+	// Pre-define the transfer size, so no stop command is needed. Fall back to open-ended if rejected.
+	int predefined = 0;
+	if (storage->has_set_block_count)
+	{
+		mmc_seq_t seq;
+		_sdmmc_storage_seq(storage, &seq);
+		predefined = mmc_seq_set_block_count(&seq, blkcnt, &storage->set_block_count_fails);
+	}
 
-	reqbuf.buf = buf;
-	reqbuf.num_sectors = num_sectors;
+	sdmmc_init_cmd(&cmdbuf, req->is_write ? MMC_WRITE_MULTIPLE_BLOCK : MMC_READ_MULTIPLE_BLOCK,
+		req->sector + req->done, SDMMC_RSP_TYPE_1, 0);
+
+	reqbuf.buf = NULL;
+	reqbuf.num_sectors = blkcnt;
 	reqbuf.blksize = 512;
-	reqbuf.is_write = is_write;
+	reqbuf.is_write = req->is_write;
 	reqbuf.is_multi_block = 1;
-	reqbuf.is_auto_cmd12 = 1;
+	reqbuf.is_auto_cmd12 = !predefined;
+	reqbuf.sg = req->sg;
+	reqbuf.sg_cnt = req->sg_cnt;
+	reqbuf.sg_offset = req->done * 512;
 
-	if (!sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, blkcnt_out))
-	{
-		sdmmc_stop_transmission(storage->sdmmc, &tmp);
-		_sdmmc_storage_get_status(storage, &tmp, 0);
+	req->deadline = get_tmr_ms() + 1500;
+
+	return sdmmc_execute_cmd_start(storage->sdmmc, &cmdbuf, &reqbuf);
+}
 
+static int _sdmmc_storage_readwrite_reinit(sdmmc_async_t *req)
+{
+	int res;
+
+	// Disk IO failure! Reinit SD Card to a lower speed.
+	if (req->storage->sdmmc->id != SDMMC_1)
 		return 0;
+
+	sd_error_count_increment(SD_ERROR_RW_FAIL);
+	sdmmc_telem_event(SDMMC_1, SDMMC_TELEM_CNT_REINIT);
+
+	if (req->first_reinit)
+		res = sd_initialize(true);
+	else
+	{
+		res = sd_init_retry(true);
+		if (!res)
+			sd_error_count_increment(SD_ERROR_INIT_FAIL);
 	}
 
-	return 1;
+	// Reset values for a retry.
+	req->retries = 3;
+	req->first_reinit = false;
+
+	// If succesful reinit, restart xfer.
+	if (res)
+		req->done = 0;
+
+	return res;
+}
+
+static void _sdmmc_storage_readwrite_record(sdmmc_async_t *req)
+{
+	sdmmc_telem_request(req->storage->sdmmc->id, req->is_write ? SDMMC_TELEM_OP_WRITE : SDMMC_TELEM_OP_READ,
+		req->sector, req->num_sectors, get_tmr_us() - req->start_us, req->state == SDMMC_ASYNC_DONE);
+}
+
+static void _sdmmc_storage_readwrite_advance(sdmmc_async_t *req, int ok, u32 blkcnt)
+{
+	u32 tmp = 0;
+
+	while (true)
+	{
+		if (ok)
+		{
+			req->done += blkcnt;
+			req->retries = 5; // Retry 5 times if failed.
+
+			if (req->done == req->num_sectors)
+			{
+				req->state = SDMMC_ASYNC_DONE;
+				_sdmmc_storage_readwrite_record(req);
+				return;
+			}
+		}
+		else
+		{
+			sdmmc_stop_transmission(req->storage->sdmmc, &tmp);
+			_sdmmc_storage_get_status(req->storage, &tmp, 0);
+
+			req->retries--;
+			sd_error_count_increment(SD_ERROR_RW_RETRY);
+			sdmmc_telem_event(req->storage->sdmmc->id, SDMMC_TELEM_CNT_RETRY);
+
+			msleep(50);
+
+			if (!req->retries && !_sdmmc_storage_readwrite_reinit(req))
+			{
+				req->state = SDMMC_ASYNC_ERROR;
+				_sdmmc_storage_readwrite_record(req);
+				return;
+			}
+		}
+
+		// Start next chunk or retry.
+		if (_sdmmc_storage_readwrite_start(req))
+		{
+			req->state = SDMMC_ASYNC_BUSY;
+			return;
+		}
+		ok = 0;
+	}
+}
+
+static void _sdmmc_storage_readwrite_submit(sdmmc_async_t *req, sdmmc_storage_t *storage, u32 sector, u32 num_sectors,
+	sdmmc_sg_t *sg, u32 sg_cnt, u32 is_write)
+{
+	req->storage = storage;
+	req->sg = sg;
+	req->sg_cnt = sg_cnt;
+	req->sector = sector;
+	req->num_sectors = num_sectors;
+	req->is_write = is_write;
+	req->done = 0;
+	req->retries = 5;
+	req->first_reinit = true;
+	req->start_us = get_tmr_us();
+
+	if (!num_sectors)
+	{
+		req->state = SDMMC_ASYNC_DONE;
+		return;
+	}
+
+	if (_sdmmc_storage_readwrite_start(req))
+		req->state = SDMMC_ASYNC_BUSY;
+	else
+		_sdmmc_storage_readwrite_advance(req, 0, 0);
+}
+
+static void _sdmmc_storage_readwrite_complete(sdmmc_async_t *req)
+{
+	u32 blkcnt = 0;
+	int ok = sdmmc_execute_cmd_finish(req->storage->sdmmc, &blkcnt);
+
+	_sdmmc_storage_readwrite_advance(req, ok, blkcnt);
+}
+
+static int _sdmmc_storage_readwrite_wait(sdmmc_async_t *req)
+{
+	while (req->state == SDMMC_ASYNC_BUSY)
+		_sdmmc_storage_readwrite_complete(req);
+
+	return req->state == SDMMC_ASYNC_DONE;
 }
 
 int sdmmc_storage_end(sdmmc_storage_t *storage)
 {
+	// Volatile cache is lost on idle state.
+	sdmmc_storage_flush(storage);
+
 	if (!_sdmmc_storage_go_idle_state(storage))
 		return 0;
 
@@ -177,109 +346,341 @@ int sdmmc_storage_end(sdmmc_storage_t *storage)
 	return 1;
 }
 
-static int _sdmmc_storage_readwrite(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+static int _sdmmc_storage_readwrite(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, sdmmc_sg_t *sg, u32 sg_cnt, u32 is_write)
 {
-	u8 *bbuf = (u8 *)buf;
-	u32 sct_off = sector;
-	u32 sct_total = num_sectors;
-	bool first_reinit = true;
+	sdmmc_async_t req;
 
 	// Exit if not initialized.
 	if (!storage->initialized)
 		return 0;
 
-	while (sct_total)
+	// Finish any request in flight. Its result is kept for its owner.
+	_sdmmc_storage_readwrite_wait(&_sdmmc_async[storage->sdmmc->id]);
+
+	_sdmmc_storage_readwrite_submit(&req, storage, sector, num_sectors, sg, sg_cnt, is_write);
+
+	return _sdmmc_storage_readwrite_wait(&req);
+}
+
+static int _sdmmc_storage_readwrite_buf(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	sdmmc_sg_t sg;
+	sg.buf = buf;
+	sg.size = num_sectors * 512;
+
+	return _sdmmc_storage_readwrite(storage, sector, num_sectors, &sg, 1, is_write);
+}
+
+static int _sdmmc_storage_readwrite_unaligned(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, u8 *buf, u32 is_write)
+{
+	u8 *bounce = (u8 *)(SDMMC_BOUNCE_ADDR + storage->sdmmc->id * SDMMC_BOUNCE_SZ);
+	u32 head = SDMMC_ADMA_ALIGN - ((u32)buf % SDMMC_ADMA_ALIGN);
+	u32 tail = SDMMC_ADMA_ALIGN - head;
+
+	while (num_sectors)
 	{
-		u32 blkcnt = 0;
-		// Retry 5 times if failed.
-		u32 retries = 5;
-		do
+		// Chunks stay under the 0xFFFF block limit, so the middle is never split at an unaligned address.
+		u32 blkcnt = MIN(num_sectors, SDMMC_UNALIGNED_MAX_SCTS);
+		u32 size = blkcnt * 512;
+
+		// DMA the aligned middle directly. Only the edges go through the bounce buffer.
+		sdmmc_sg_t sg[3];
+		sg[0].buf  = bounce;
+		sg[0].size = head;
+		sg[1].buf  = buf + head;
+		sg[1].size = size - SDMMC_ADMA_ALIGN;
+		sg[2].buf  = bounce + SDMMC_ADMA_ALIGN;
+		sg[2].size = tail;
+
+		if (is_write)
 		{
-reinit_try:
-			if (_sdmmc_storage_readwrite_ex(storage, &blkcnt, sct_off, MIN(sct_total, 0xFFFF), bbuf, is_write))
-				goto out;
-			else
-				retries--;
-
-			sd_error_count_increment(SD_ERROR_RW_RETRY);
+			memcpy(sg[0].buf, buf, head);
+			memcpy(sg[2].buf, buf + size - tail, tail);
+		}
 
-			msleep(50);
-		} while (retries);
+		if (!_sdmmc_storage_readwrite(storage, sector, blkcnt, sg, 3, is_write))
+			return 0;
 
-		// Disk IO failure! Reinit SD Card to a lower speed.
-		if (storage->sdmmc->id == SDMMC_1)
+		if (!is_write)
 		{
-			int res;
+			memcpy(buf, sg[0].buf, head);
+			memcpy(buf + size - tail, sg[2].buf, tail);
+		}
 
-			sd_error_count_increment(SD_ERROR_RW_FAIL);
+		sector += blkcnt;
+		num_sectors -= blkcnt;
+		buf += size;
+	}
 
-			if (first_reinit)
-				res = sd_initialize(true);
-			else
-			{
-				res = sd_init_retry(true);
-				if (!res)
-					sd_error_count_increment(SD_ERROR_INIT_FAIL);
-			}
+	return 1;
+}
 
-			// Reset values for a retry.
-			blkcnt = 0;
-			retries = 3;
-			first_reinit = false;
+static int _sdmmc_storage_readwrite_bounce(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, u8 *buf, u32 is_write)
+{
+	u8 *bounce = (u8 *)SDMMC_UPPER_BUFFER;
 
-			// If succesful reinit, restart xfer.
-			if (res)
-			{
-				bbuf = (u8 *)buf;
-				sct_off = sector;
-				sct_total = num_sectors;
+	while (num_sectors)
+	{
+		u32 blkcnt = MIN(num_sectors, SDMMC_UP_BUF_SZ / 512);
 
-				goto reinit_try;
-			}
-		}
+		if (is_write)
+			memcpy(bounce, buf, blkcnt * 512);
 
-		// Failed.
-		return 0;
+		if (!_sdmmc_storage_readwrite_buf(storage, sector, blkcnt, bounce, is_write))
+			return 0;
 
-out:
-		sct_off += blkcnt;
-		sct_total -= blkcnt;
-		bbuf += 512 * blkcnt;
+		if (!is_write)
+			memcpy(buf, bounce, blkcnt * 512);
+
+		sector += blkcnt;
+		num_sectors -= blkcnt;
+		buf += blkcnt * 512;
 	}
 
 	return 1;
 }
 
+static int _sdmmc_storage_readwrite_any(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	// Buffers outside of DRAM can't be DMA targets.
+	if ((u32)buf < DRAM_START)
+		return _sdmmc_storage_readwrite_bounce(storage, sector, num_sectors, buf, is_write);
+
+	if ((u32)buf % SDMMC_ADMA_ALIGN)
+		return _sdmmc_storage_readwrite_unaligned(storage, sector, num_sectors, buf, is_write);
+
+	return _sdmmc_storage_readwrite_buf(storage, sector, num_sectors, buf, is_write);
+}
+
 int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
 {
+	return _sdmmc_storage_readwrite_any(storage, sector, num_sectors, buf, 0);
+}
+
+int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return _sdmmc_storage_readwrite_any(storage, sector, num_sectors, buf, 1);
+}
+
+static int _sdmmc_storage_readwrite_sg(sdmmc_storage_t *storage, u32 sector, sdmmc_sg_t *sg, u32 sg_cnt, u32 is_write)
+{
+	u32 size = 0;
+
+	// Ensure that all buffers reside in DRAM. Alignment is checked when building the ADMA table.
+	for (u32 i = 0; i < sg_cnt; i++)
+	{
+		if ((u32)sg[i].buf < DRAM_START)
+			return 0;
+		size += sg[i].size;
+	}
+
+	if (!size || (size % 512))
+		return 0;
+
+	return _sdmmc_storage_readwrite(storage, sector, size / 512, sg, sg_cnt, is_write);
+}
+
+int sdmmc_storage_read_sg(sdmmc_storage_t *storage, u32 sector, sdmmc_sg_t *sg, u32 sg_cnt)
+{
+	return _sdmmc_storage_readwrite_sg(storage, sector, sg, sg_cnt, 0);
+}
+
+int sdmmc_storage_write_sg(sdmmc_storage_t *storage, u32 sector, sdmmc_sg_t *sg, u32 sg_cnt)
+{
+	return _sdmmc_storage_readwrite_sg(storage, sector, sg, sg_cnt, 1);
+}
+
+int sdmmc_storage_submit(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write)
+{
+	// Exit if not initialized.
+	if (!storage->initialized)
+		return 0;
+
 	// Ensure that buffer resides in DRAM and it's DMA aligned.
-	if (((u32)buf >= DRAM_START) && !((u32)buf % 8))
-		return _sdmmc_storage_readwrite(storage, sector, num_sectors, buf, 0);
+	if (((u32)buf < DRAM_START) || ((u32)buf % 8))
+		return 0;
 
-	if (num_sectors > (SDMMC_UP_BUF_SZ / 512))
+	// Only one request per controller.
+	sdmmc_async_t *req = &_sdmmc_async[storage->sdmmc->id];
+	if (req->state == SDMMC_ASYNC_BUSY)
 		return 0;
 
-	u8 *tmp_buf = (u8 *)SDMMC_UPPER_BUFFER;
-	if (_sdmmc_storage_readwrite(storage, sector, num_sectors, tmp_buf, 0))
+	req->sg_buf.buf = buf;
+	req->sg_buf.size = num_sectors * 512;
+	_sdmmc_storage_readwrite_submit(req, storage, sector, num_sectors, &req->sg_buf, 1, is_write);
+
+	return 1;
+}
+
+int sdmmc_storage_poll(sdmmc_storage_t *storage)
+{
+	sdmmc_async_t *req = &_sdmmc_async[storage->sdmmc->id];
+
+	// Complete the chunk if it ended or if it's taking too long. The latter either finishes or times out.
+	if (req->state == SDMMC_ASYNC_BUSY &&
+		(sdmmc_execute_cmd_done(storage->sdmmc) || get_tmr_ms() > req->deadline))
+		_sdmmc_storage_readwrite_complete(req);
+
+	return req->state;
+}
+
+int sdmmc_storage_wait(sdmmc_storage_t *storage)
+{
+	sdmmc_async_t *req = &_sdmmc_async[storage->sdmmc->id];
+
+	if (req->state == SDMMC_ASYNC_IDLE)
+		return 0;
+
+	int res = _sdmmc_storage_readwrite_wait(req);
+	req->state = SDMMC_ASYNC_IDLE;
+
+	return res;
+}
+
+static int _sdmmc_storage_wait_ready(sdmmc_storage_t *storage, u32 timeout_ms)
+{
+	mmc_seq_t seq;
+	_sdmmc_storage_seq(storage, &seq);
+
+	return mmc_seq_wait_ready(&seq, timeout_ms);
+}
+
+static u32 _sdmmc_storage_erase_timeout(sdmmc_storage_t *storage, u32 arg, u32 sector, u32 num_sectors)
+{
+	u32 timeout;
+
+	if (storage->sdmmc->id == SDMMC_4)
 	{
-		memcpy(buf, tmp_buf, 512 * num_sectors);
-		return 1;
+		// Timeouts are in 300ms units per erase group touched.
+		u32 grp = storage->csd.erase_size;
+		u32 qty = (sector + num_sectors - 1) / grp - sector / grp + 1;
+		u32 mult = (arg == MMC_ERASE_ARG) ? storage->ext_csd.erase_tmo_mult : storage->ext_csd.trim_mult;
+
+		timeout = 300 * MAX(mult, 1) * qty;
 	}
-	return 0;
+	else if (arg == SD_DISCARD_ARG)
+		timeout = 250;
+	else
+	{
+		// Timeouts are per AU touched. Erase timeout and offset are in seconds.
+		u32 au = storage->ssr.au_size ? storage->ssr.au_size : 0x2000;
+		u32 qty = (sector + num_sectors - 1) / au - sector / au + 1;
+
+		if (storage->ssr.erase_size && storage->ssr.erase_timeout)
+			timeout = storage->ssr.erase_timeout * 1000 * qty / storage->ssr.erase_size +
+				storage->ssr.erase_offset * 1000;
+		else
+			timeout = 250 * qty;
+	}
+
+	return MAX(timeout, 1000);
 }
 
-int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf)
+static int _sdmmc_storage_erase_range_inner(sdmmc_storage_t *storage, u32 arg, u32 sector, u32 num_sectors)
 {
-	// Ensure that buffer resides in DRAM and it's DMA aligned.
-	if (((u32)buf >= DRAM_START) && !((u32)buf % 8))
-		return _sdmmc_storage_readwrite(storage, sector, num_sectors, buf, 1);
+	bool is_emmc = storage->sdmmc->id == SDMMC_4;
+	u32 cmd_start = is_emmc ? MMC_ERASE_GROUP_START : SD_ERASE_WR_BLK_START;
+	u32 cmd_end = is_emmc ? MMC_ERASE_GROUP_END : SD_ERASE_WR_BLK_END;
+
+	if (!_sdmmc_storage_execute_cmd_type1(storage, cmd_start, sector, 0, R1_STATE_TRAN))
+		return 0;
+
+	if (!_sdmmc_storage_execute_cmd_type1(storage, cmd_end, sector + num_sectors - 1, 0, R1_STATE_TRAN))
+		return 0;
 
-	if (num_sectors > (SDMMC_UP_BUF_SZ / 512))
+	// Busy is polled via status, since it can outlast the controller's busy timeout.
+	if (!_sdmmc_storage_execute_cmd_type1(storage, MMC_ERASE, arg, 0, 0x10))
 		return 0;
 
-	u8 *tmp_buf = (u8 *)SDMMC_UPPER_BUFFER;
-	memcpy(tmp_buf, buf, 512 * num_sectors);
-	return _sdmmc_storage_readwrite(storage, sector, num_sectors, tmp_buf, 1);
+	return _sdmmc_storage_wait_ready(storage, _sdmmc_storage_erase_timeout(storage, arg, sector, num_sectors));
+}
+
+static int _sdmmc_storage_erase_range(sdmmc_storage_t *storage, u32 arg, u32 sector, u32 num_sectors)
+{
+	u32 start_us = get_tmr_us();
+	int res = _sdmmc_storage_erase_range_inner(storage, arg, sector, num_sectors);
+
+	sdmmc_telem_request(storage->sdmmc->id, SDMMC_TELEM_OP_ERASE, sector, num_sectors, get_tmr_us() - start_us, res);
+
+	return res;
+}
+
+int sdmmc_storage_erase(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, u32 type)
+{
+	u32 arg;
+	u32 grp = storage->csd.erase_size ? storage->csd.erase_size : 1;
+	bool is_emmc = storage->sdmmc->id == SDMMC_4;
+
+	// Exit if not initialized or erase commands are not supported.
+	if (!storage->initialized || !storage->has_sector_access || !(storage->csd.cmdclass & CCC_ERASE))
+		return 0;
+
+	if (!num_sectors)
+		return 1;
+
+	// Pick the finest erase the card supports, within the requested type.
+	if (type == SDMMC_ERASE_DISCARD && is_emmc && storage->ext_csd.rev >= 6)
+		arg = MMC_DISCARD_ARG;
+	else if (type == SDMMC_ERASE_DISCARD && !is_emmc && storage->ssr.discard)
+		arg = SD_DISCARD_ARG;
+	else if (type <= SDMMC_ERASE_TRIM && is_emmc && (storage->ext_csd.sec_feature & EXT_CSD_SEC_GB_CL_EN))
+		arg = MMC_TRIM_ARG;
+	else if (type <= SDMMC_ERASE_TRIM && !is_emmc && grp == 1)
+		arg = SD_ERASE_ARG;
+	else if (type != SDMMC_ERASE_TRIM)
+		arg = MMC_ERASE_ARG;
+	else
+		return 0;
+
+	// Plain erase works on whole groups. Shrink range to them, so nothing outside of it is lost.
+	if (arg == MMC_ERASE_ARG && grp > 1)
+	{
+		u32 end = ((sector + num_sectors) / grp) * grp;
+		sector = ALIGN(sector, grp);
+		if (end <= sector)
+			return 1;
+		num_sectors = end - sector;
+	}
+	else
+		grp = 1;
+
+	// Finish any request in flight. Its result is kept for its owner.
+	_sdmmc_storage_readwrite_wait(&_sdmmc_async[storage->sdmmc->id]);
+
+	// Split into commands with sane busy timeouts.
+	u32 max_sct = (SDMMC_ERASE_MAX_SCTS / grp) * grp;
+	while (num_sectors)
+	{
+		u32 num = MIN(num_sectors, max_sct);
+
+		if (!_sdmmc_storage_erase_range(storage, arg, sector, num))
+			return 0;
+
+		sector += num;
+		num_sectors -= num;
+	}
+
+	return 1;
+}
+
+int sdmmc_storage_flush(sdmmc_storage_t *storage)
+{
+	// Only eMMC has a volatile cache that is enabled by us.
+	if (!storage->initialized || !storage->ext_csd.cache_ctrl)
+		return 1;
+
+	// Finish any request in flight. Its result is kept for its owner.
+	_sdmmc_storage_readwrite_wait(&_sdmmc_async[storage->sdmmc->id]);
+
+	mmc_seq_t seq;
+	_sdmmc_storage_seq(storage, &seq);
+
+	u32 start_us = get_tmr_us();
+	int res = mmc_seq_flush(&seq, SDMMC_FLUSH_TIMEOUT);
+
+	sdmmc_telem_request(storage->sdmmc->id, SDMMC_TELEM_OP_FLUSH, 0, 0, get_tmr_us() - start_us, res);
+
+	return res;
 }
 
 /*
@@ -396,7 +797,13 @@ static void _mmc_storage_parse_csd(sdmmc_storage_t *storage)
 	storage->csd.structure = unstuff_bits(raw_csd, 126, 2);
 	storage->csd.cmdclass = unstuff_bits(raw_csd, 84, 12);
 	storage->csd.read_blkbits = unstuff_bits(raw_csd, 80, 4);
+	storage->csd.write_blkbits = unstuff_bits(raw_csd, 22, 4);
 	storage->csd.capacity = (1 + unstuff_bits(raw_csd, 62, 12)) << (unstuff_bits(raw_csd, 47, 3) + 2);
+
+	// Legacy erase group size. Replaced by the high capacity one if enabled.
+	storage->csd.erase_size = (unstuff_bits(raw_csd, 42, 5) + 1) * (unstuff_bits(raw_csd, 37, 5) + 1);
+	if (storage->csd.write_blkbits > 9)
+		storage->csd.erase_size <<= storage->csd.write_blkbits - 9;
 }
 
 static void _mmc_storage_parse_ext_csd(sdmmc_storage_t *storage, u8 *buf)
@@ -416,6 +823,18 @@ static void _mmc_storage_parse_ext_csd(sdmmc_storage_t *storage, u8 *buf)
 	storage->ext_csd.dev_life_est_a = buf[EXT_CSD_DEVICE_LIFE_TIME_EST_TYP_A];
 	storage->ext_csd.dev_life_est_b = buf[EXT_CSD_DEVICE_LIFE_TIME_EST_TYP_B];
 
+	storage->ext_csd.erase_grp_def = buf[EXT_CSD_ERASE_GROUP_DEF];
+	storage->ext_csd.erase_tmo_mult = buf[EXT_CSD_ERASE_TIMEOUT_MULT];
+	storage->ext_csd.hc_erase_grp_size = buf[EXT_CSD_HC_ERASE_GRP_SIZE];
+	storage->ext_csd.sec_feature = buf[EXT_CSD_SEC_FEATURE_SUPPORT];
+	storage->ext_csd.trim_mult = buf[EXT_CSD_TRIM_MULT];
+	storage->ext_csd.cache_size = *(u32 *)&buf[EXT_CSD_CACHE_SIZE];
+	storage->ext_csd.cache_ctrl = buf[EXT_CSD_CACHE_CTRL];
+
+	// High capacity erase groups are in 512KB units.
+	if ((storage->ext_csd.erase_grp_def & 1) && storage->ext_csd.hc_erase_grp_size)
+		storage->csd.erase_size = storage->ext_csd.hc_erase_grp_size << 10;
+
 	storage->sec_cnt  = *(u32 *)&buf[EXT_CSD_SEC_CNT];
 }
 
@@ -431,6 +850,7 @@ static int _mmc_storage_get_ext_csd(sdmmc_storage_t *storage, void *buf)
 	reqbuf.is_write = 0;
 	reqbuf.is_multi_block = 0;
 	reqbuf.is_auto_cmd12 = 0;
+	reqbuf.sg = NULL;
 
 	if (!sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, 0))
 		return 0;
@@ -644,6 +1064,9 @@ DPRINTF("[MMC] BKOPS enabled\n");
 		return 0;
 DPRINTF("[MMC] succesfully switched to HS mode\n");
 
+	// CMD23 is supported since v3.1.
+	storage->has_set_block_count = storage->csd.mmca_vsn >= CSD_SPEC_VER_3;
+
 	sdmmc_card_clock_powersave(storage->sdmmc, SDMMC_POWER_SAVE_ENABLE);
 
 	storage->initialized = 1;
@@ -664,6 +1087,30 @@ int sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition)
 	return 1;
 }
 
+int sdmmc_storage_set_mmc_cache(sdmmc_storage_t *storage, int enable)
+{
+	enable = !!enable;
+
+	if (!storage->ext_csd.cache_size)
+		return !enable;
+
+	if (storage->ext_csd.cache_ctrl == enable)
+		return 1;
+
+	// Write back cached data before disabling.
+	if (!enable && !sdmmc_storage_flush(storage))
+		return 0;
+
+	mmc_seq_t seq;
+	_sdmmc_storage_seq(storage, &seq);
+	if (!mmc_seq_cache_ctrl(&seq, enable))
+		return 0;
+
+	storage->ext_csd.cache_ctrl = enable;
+
+	return 1;
+}
+
 /*
 * SD specific functions.
 */
@@ -821,6 +1268,7 @@ int _sd_storage_get_scr(sdmmc_storage_t *storage, u8 *buf)
 	reqbuf.is_write = 0;
 	reqbuf.is_multi_block = 0;
 	reqbuf.is_auto_cmd12 = 0;
+	reqbuf.sg = NULL;
 
 	if (!_sd_storage_execute_app_cmd(storage, R1_STATE_TRAN, 0, &cmdbuf, &reqbuf, 0))
 		return 0;
@@ -853,6 +1301,7 @@ int _sd_storage_switch_get(sdmmc_storage_t *storage, void *buf)
 	reqbuf.is_write = 0;
 	reqbuf.is_multi_block = 0;
 	reqbuf.is_auto_cmd12 = 0;
+	reqbuf.sg = NULL;
 
 	if (!sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, 0))
 		return 0;
@@ -877,6 +1326,7 @@ int _sd_storage_switch(sdmmc_storage_t *storage, void *buf, int mode, int group,
 	reqbuf.is_write = 0;
 	reqbuf.is_multi_block = 0;
 	reqbuf.is_auto_cmd12 = 0;
+	reqbuf.sg = NULL;
 
 	if (!sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, 0))
 		return 0;
@@ -1057,6 +1507,12 @@ int _sd_storage_enable_hs_high_volt(sdmmc_storage_t *storage, u8 *buf)
 	return sdmmc_setup_clock(storage->sdmmc, SDHCI_TIMING_SD_HS25);
 }
 
+// AU sizes in sectors.
+static const u32 _sd_au_size[16] = {
+	0,      0x20,   0x40,   0x80,   0x100,  0x200,  0x400,  0x800,
+	0x1000, 0x2000, 0x4000, 0x6000, 0x8000, 0xC000, 0x10000, 0x20000
+};
+
 static void _sd_storage_parse_ssr(sdmmc_storage_t *storage)
 {
 	// unstuff_bits supports only 4 u32 so break into 2 x 16byte groups
@@ -1106,6 +1562,12 @@ static void _sd_storage_parse_ssr(sdmmc_storage_t *storage)
 	storage->ssr.video_class = unstuff_bits(raw_ssr1, 384 - 384, 8);
 
 	storage->ssr.app_class = unstuff_bits(raw_ssr2, 336 - 256, 4);
+
+	storage->ssr.au_size = _sd_au_size[unstuff_bits(raw_ssr1, 428 - 384, 4)];
+	storage->ssr.erase_size = unstuff_bits(raw_ssr1, 408 - 384, 16);
+	storage->ssr.erase_timeout = unstuff_bits(raw_ssr1, 402 - 384, 6);
+	storage->ssr.erase_offset = unstuff_bits(raw_ssr1, 400 - 384, 2);
+	storage->ssr.discard = unstuff_bits(raw_ssr2, 313 - 256, 1);
 }
 
 static int _sd_storage_get_ssr(sdmmc_storage_t *storage, u8 *buf)
@@ -1120,6 +1582,7 @@ static int _sd_storage_get_ssr(sdmmc_storage_t *storage, u8 *buf)
 	reqbuf.is_write = 0;
 	reqbuf.is_multi_block = 0;
 	reqbuf.is_auto_cmd12 = 0;
+	reqbuf.sg = NULL;
 
 	if (!(storage->csd.cmdclass & CCC_APP_SPEC))
 	{
@@ -1176,12 +1639,24 @@ static void _sd_storage_parse_csd(sdmmc_storage_t *storage)
 	{
 	case 0:
 		storage->csd.capacity = (1 + unstuff_bits(raw_csd, 62, 12)) << (unstuff_bits(raw_csd, 47, 3) + 2);
+		storage->csd.write_blkbits = unstuff_bits(raw_csd, 22, 4);
+		// Erase is block granular if ERASE_BLK_EN is set. Otherwise in SECTOR_SIZE units.
+		if (unstuff_bits(raw_csd, 46, 1))
+			storage->csd.erase_size = 1;
+		else
+		{
+			storage->csd.erase_size = unstuff_bits(raw_csd, 39, 7) + 1;
+			if (storage->csd.write_blkbits > 9)
+				storage->csd.erase_size <<= storage->csd.write_blkbits - 9;
+		}
 		break;
 
 	case 1:
 		storage->csd.c_size = (1 + unstuff_bits(raw_csd, 48, 22));
 		storage->csd.capacity = storage->csd.c_size << 10;
 		storage->csd.read_blkbits = 9;
+		storage->csd.write_blkbits = 9;
+		storage->csd.erase_size = 1;
 		break;
 	}
 }
@@ -1350,6 +1825,120 @@ DPRINTF("[SD] got sd status\n");
 	return 1;
 }
 
+int sdmmc_storage_save_sd_handoff(sdmmc_storage_t *storage, sdmmc_handoff_t *ho)
+{
+	if (!storage->initialized || storage->sdmmc->id != SDMMC_1 || storage->sdmmc->clock_stopped)
+		return 0;
+
+	// Card must be idle in transfer state.
+	_sdmmc_storage_readwrite_wait(&_sdmmc_async[storage->sdmmc->id]);
+	if (!_sdmmc_storage_check_status(storage))
+		return 0;
+
+	memset(ho, 0, sizeof(sdmmc_handoff_t));
+
+	ho->rca = storage->rca;
+	ho->sec_cnt = storage->sec_cnt;
+	ho->has_sector_access = storage->has_sector_access;
+	ho->is_low_voltage = storage->is_low_voltage;
+	ho->busspeed = storage->csd.busspeed;
+	memcpy(ho->raw_cid, storage->raw_cid, sizeof(ho->raw_cid));
+	memcpy(ho->raw_csd, storage->raw_csd, sizeof(ho->raw_csd));
+	memcpy(ho->raw_scr, storage->raw_scr, sizeof(ho->raw_scr));
+	memcpy(ho->raw_ssr, storage->raw_ssr, sizeof(ho->raw_ssr));
+
+	sdmmc_save_handoff(storage->sdmmc, ho);
+
+	sdmmc_handoff_seal(ho);
+
+	return 1;
+}
+
+static int _sd_storage_handoff_type_ok(u32 ho_type, u32 type)
+{
+	if (ho_type == type)
+		return 1;
+
+	if (type != SDHCI_TIMING_UHS_SDR104 && type != SDHCI_TIMING_UHS_SDR82)
+		return 0;
+
+	// A full init would also fall back to these, if card lacks SDR104.
+	switch (ho_type)
+	{
+	case SDHCI_TIMING_UHS_SDR104:
+	case SDHCI_TIMING_UHS_SDR82:
+	case SDHCI_TIMING_UHS_SDR50:
+	case SDHCI_TIMING_UHS_SDR25:
+	case SDHCI_TIMING_UHS_SDR12:
+		return 1;
+	}
+
+	return 0;
+}
+
+int sdmmc_storage_init_sd_handoff(sdmmc_storage_t *storage, sdmmc_t *sdmmc, const sdmmc_handoff_t *ho, u32 type)
+{
+	memset(storage, 0, sizeof(sdmmc_storage_t));
+	storage->sdmmc = sdmmc;
+
+	// The SD may still be powered by the previous stage, even if its state is unusable.
+	if (sdmmc_handoff_check(ho) != SDMMC_HANDOFF_OK || ho->id != SDMMC_1)
+	{
+		sdmmc_reject_handoff(sdmmc, SDMMC_1);
+		return 0;
+	}
+
+	if (!sdmmc_init_handoff(sdmmc, ho))
+		return 0;
+
+	storage->rca = ho->rca;
+	storage->sec_cnt = ho->sec_cnt;
+	storage->has_sector_access = ho->has_sector_access;
+	storage->is_low_voltage = ho->is_low_voltage;
+	memcpy(storage->raw_cid, ho->raw_cid, sizeof(storage->raw_cid));
+	memcpy(storage->raw_csd, ho->raw_csd, sizeof(storage->raw_csd));
+	memcpy(storage->raw_scr, ho->raw_scr, sizeof(storage->raw_scr));
+	memcpy(storage->raw_ssr, ho->raw_ssr, sizeof(storage->raw_ssr));
+
+	_sd_storage_parse_cid(storage);
+	_sd_storage_parse_csd(storage);
+	_sd_storage_parse_scr(storage);
+	_sd_storage_parse_ssr(storage);
+	storage->csd.busspeed = ho->busspeed;
+
+	if (!_sd_storage_handoff_type_ok(ho->type, type))
+		goto out;
+
+	// Card must still be selected at the same address and in transfer state.
+	if (!_sdmmc_storage_check_status(storage))
+		goto out;
+DPRINTF("[SD] handoff: card in tran state\n");
+
+	// SDR82 is SDR104 with a lower clock. Only the host side must be reconfigured and retuned.
+	if (ho->type != type && (ho->type == SDHCI_TIMING_UHS_SDR104 || ho->type == SDHCI_TIMING_UHS_SDR82))
+	{
+		if (!sdmmc_setup_clock(sdmmc, type))
+			goto out;
+		if (!sdmmc_tuning_execute(sdmmc, type, MMC_SEND_TUNING_BLOCK))
+			goto out;
+		if (!_sdmmc_storage_check_status(storage))
+			goto out;
+
+		storage->csd.busspeed = type == SDHCI_TIMING_UHS_SDR104 ? 104 : 82;
+DPRINTF("[SD] handoff: retuned for type %d\n", type);
+	}
+
+	storage->initialized = 1;
+
+	return 1;
+
+out:
+	// Card state is unknown. Power it off so a full init can start clean.
+	sdmmc_end(sdmmc);
+
+	return 0;
+}
+
 /*
 * Gamecard specific functions.
 */
@@ -1367,6 +1956,7 @@ int _gc_storage_custom_cmd(sdmmc_storage_t *storage, void *buf)
 	reqbuf.is_write = 1;
 	reqbuf.is_multi_block = 0;
 	reqbuf.is_auto_cmd12 = 0;
+	reqbuf.sg = NULL;
 
 	if (!sdmmc_execute_cmd(storage->sdmmc, &cmdbuf, &reqbuf, 0))
 	{
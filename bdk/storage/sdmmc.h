@@ -78,6 +78,13 @@ typedef struct _mmc_ext_csd
 	u8  boot_mult;
 	u8  rpmb_mult;
 	u16 dev_version;
+	u8  erase_grp_def;     /* 175 */
+	u8  erase_tmo_mult;    /* 223 */
+	u8  hc_erase_grp_size; /* 224 */
+	u8  sec_feature;       /* 231 */
+	u8  trim_mult;         /* 232 */
+	u8  cache_ctrl;        /* 33 */
+	u32 cache_size;        /* 249, in KB */
 } mmc_ext_csd_t;
 
 typedef struct _sd_scr
@@ -96,6 +103,11 @@ typedef struct _sd_ssr
 	u8 video_class;
 	u8 app_class;
 	u32 protected_size;
+	u32 au_size;      /* In sectors */
+	u16 erase_size;   /* In AUs */
+	u8  erase_timeout;
+	u8  erase_offset;
+	u8  discard;
 } sd_ssr_t;
 
 /*! SDMMC storage context. */
@@ -104,6 +116,8 @@ typedef struct _sdmmc_storage_t
 	sdmmc_t *sdmmc;
 	u32 rca;
 	int has_sector_access;
+	int has_set_block_count;
+	u32 set_block_count_fails; // Consecutive CMD23 rejections. Cleared on init.
 	u32 sec_cnt;
 	int is_low_voltage;
 	u32 partition;
@@ -119,13 +133,52 @@ typedef struct _sdmmc_storage_t
 	int initialized;
 } sdmmc_storage_t;
 
+/*! SDMMC erase types. Discarded contents are undefined, trimmed or erased ones read as erased. */
+#define SDMMC_ERASE_DISCARD 0 // Best effort. Falls back to TRIM or erase. Unaligned edges may be kept.
+#define SDMMC_ERASE_TRIM    1 // Sector granular.
+#define SDMMC_ERASE_ERASE   2 // Erase group granular. Unaligned edges are kept.
+
+/*! SDMMC asynchronous request states. */
+#define SDMMC_ASYNC_IDLE  0
+#define SDMMC_ASYNC_BUSY  1
+#define SDMMC_ASYNC_DONE  2
+#define SDMMC_ASYNC_ERROR 3
+
+/*! SDMMC asynchronous request. */
+typedef struct _sdmmc_async_t
+{
+	sdmmc_storage_t *storage;
+	sdmmc_sg_t sg_buf;
+	sdmmc_sg_t *sg;
+	u32 sg_cnt;
+	u32 sector;
+	u32 num_sectors;
+	u32 done;
+	u32 retries;
+	u32 deadline;
+	u32 start_us;
+	int is_write;
+	bool first_reinit;
+	u32 state;
+} sdmmc_async_t;
+
 int sdmmc_storage_end(sdmmc_storage_t *storage);
 int sdmmc_storage_read(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
 int sdmmc_storage_write(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf);
+int sdmmc_storage_read_sg(sdmmc_storage_t *storage, u32 sector, sdmmc_sg_t *sg, u32 sg_cnt);
+int sdmmc_storage_write_sg(sdmmc_storage_t *storage, u32 sector, sdmmc_sg_t *sg, u32 sg_cnt);
+int sdmmc_storage_submit(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, void *buf, u32 is_write);
+int sdmmc_storage_poll(sdmmc_storage_t *storage);
+int sdmmc_storage_wait(sdmmc_storage_t *storage);
+int sdmmc_storage_erase(sdmmc_storage_t *storage, u32 sector, u32 num_sectors, u32 type);
+int sdmmc_storage_flush(sdmmc_storage_t *storage);
 int sdmmc_storage_init_mmc(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
 int sdmmc_storage_set_mmc_partition(sdmmc_storage_t *storage, u32 partition);
+int sdmmc_storage_set_mmc_cache(sdmmc_storage_t *storage, int enable);
 void sdmmc_storage_init_wait_sd();
 int sdmmc_storage_init_sd(sdmmc_storage_t *storage, sdmmc_t *sdmmc, u32 bus_width, u32 type);
+int sdmmc_storage_save_sd_handoff(sdmmc_storage_t *storage, sdmmc_handoff_t *ho);
+int sdmmc_storage_init_sd_handoff(sdmmc_storage_t *storage, sdmmc_t *sdmmc, const sdmmc_handoff_t *ho, u32 type);
 int sdmmc_storage_init_gc(sdmmc_storage_t *storage, sdmmc_t *sdmmc);
 
 #endif
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <storage/sdmmc_adma.h>
+
+/*
+ * Builds an ADMA2 descriptor table that transfers size bytes from the sg list,
+ * starting offset bytes into it. Entries are split at SDMMC_ADMA_MAX_LEN.
+ * Returns the number of descriptors used or 0 if the list is too short,
+ * has a misaligned address or does not fit in desc_max descriptors.
+ */
+u32 sdmmc_adma_build(sdmmc_adma_desc_t *desc, u32 desc_max, const sdmmc_sg_t *sg, u32 sg_cnt, u32 offset, u32 size)
+{
+	u32 cnt = 0;
+
+	if (!size)
+		return 0;
+
+	// Skip already transferred entries.
+	while (sg_cnt && offset >= sg->size)
+	{
+		offset -= sg->size;
+		sg++;
+		sg_cnt--;
+	}
+
+	while (size)
+	{
+		if (!sg_cnt)
+			return 0;
+
+		u32 addr = (u32)sg->buf + offset;
+		u32 len = MIN(sg->size - offset, size);
+
+		// Check alignment. Only addresses need it, lengths can be any byte count.
+		if (addr & (SDMMC_ADMA_ALIGN - 1))
+			return 0;
+
+		size -= len;
+		while (len)
+		{
+			if (cnt == desc_max)
+				return 0;
+
+			u32 chunk = MIN(len, SDMMC_ADMA_MAX_LEN);
+
+			desc[cnt].attr    = SDMMC_ADMA_ATTR_TRAN | SDMMC_ADMA_ATTR_VALID;
+			desc[cnt].len     = chunk;
+			desc[cnt].addr_lo = addr;
+			desc[cnt].addr_hi = 0;
+			desc[cnt].rsvd    = 0;
+
+			addr += chunk;
+			len  -= chunk;
+			cnt++;
+		}
+
+		offset = 0;
+		sg++;
+		sg_cnt--;
+	}
+
+	desc[cnt - 1].attr |= SDMMC_ADMA_ATTR_END;
+
+	return cnt;
+}
@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SDMMC_ADMA_H_
+#define _SDMMC_ADMA_H_
+
+#include <utils/types.h>
+
+/*! ADMA2 descriptor attributes. */
+#define SDMMC_ADMA_ATTR_VALID BIT(0)
+#define SDMMC_ADMA_ATTR_END   BIT(1)
+#define SDMMC_ADMA_ATTR_INT   BIT(2)
+#define SDMMC_ADMA_ATTR_TRAN  (2 << 4)
+
+/*! ADMA2 limits. Length 0 (64KB) is never used, max keeps the next address aligned. */
+#define SDMMC_ADMA_MAX_LEN 0xFFF8
+#define SDMMC_ADMA_ALIGN   8
+
+/*! ADMA2 64-bit descriptor. 128-bit sized in Host Version 4 mode. */
+typedef struct _sdmmc_adma_desc_t
+{
+	u16 attr;
+	u16 len;
+	u32 addr_lo;
+	u32 addr_hi;
+	u32 rsvd;
+} sdmmc_adma_desc_t;
+
+/*! Scatter-gather list entry. */
+typedef struct _sdmmc_sg_t
+{
+	void *buf;
+	u32 size;
+} sdmmc_sg_t;
+
+u32 sdmmc_adma_build(sdmmc_adma_desc_t *desc, u32 desc_max, const sdmmc_sg_t *sg, u32 sg_cnt, u32 offset, u32 size);
+
+#endif
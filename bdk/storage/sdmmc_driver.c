@@ -17,8 +17,10 @@
 
 #include <string.h>
 
+#include <memory_map.h>
 #include <storage/mmc.h>
 #include <storage/sdmmc.h>
+#include <storage/sdmmc_telemetry.h>
 #include <gfx_utils.h>
 #include <power/max7762x.h>
 #include <soc/bpmp.h>
@@ -318,6 +320,8 @@ int sdmmc_setup_clock(sdmmc_t *sdmmc, u32 type)
 
 	_sdmmc_reset(sdmmc);
 
+	sdmmc->timing = type;
+
 	switch (type)
 	{
 	case SDHCI_TIMING_MMC_ID:
@@ -795,14 +799,14 @@ static int _sdmmc_autocal_config_offset(sdmmc_t *sdmmc, u32 power)
 static void _sdmmc_enable_interrupts(sdmmc_t *sdmmc)
 {
 	sdmmc->regs->norintstsen |= SDHCI_INT_DMA_END | SDHCI_INT_DATA_END | SDHCI_INT_RESPONSE;
-	sdmmc->regs->errintstsen |= SDHCI_ERR_INT_ALL_EXCEPT_ADMA_BUSPWR;
+	sdmmc->regs->errintstsen |= SDHCI_ERR_INT_ALL_EXCEPT_ADMA_BUSPWR | SDHCI_ERR_INT_ADMA_ERROR;
 	sdmmc->regs->norintsts = sdmmc->regs->norintsts;
 	sdmmc->regs->errintsts = sdmmc->regs->errintsts;
 }
 
 static void _sdmmc_mask_interrupts(sdmmc_t *sdmmc)
 {
-	sdmmc->regs->errintstsen &= ~SDHCI_ERR_INT_ALL_EXCEPT_ADMA_BUSPWR;
+	sdmmc->regs->errintstsen &= ~(SDHCI_ERR_INT_ALL_EXCEPT_ADMA_BUSPWR | SDHCI_ERR_INT_ADMA_ERROR);
 	sdmmc->regs->norintstsen &= ~(SDHCI_INT_DMA_END | SDHCI_INT_DATA_END | SDHCI_INT_RESPONSE);
 }
 
@@ -916,18 +920,34 @@ static int _sdmmc_config_dma(sdmmc_t *sdmmc, u32 *blkcnt_out, sdmmc_req_t *req)
 	u32 blkcnt = req->num_sectors;
 	if (blkcnt >= 0xFFFF)
 		blkcnt = 0xFFFF;
-	u32 admaaddr = (u32)req->buf;
 
-	// Check alignment.
-	if (admaaddr & 7)
+	// Use a single entry list for plain buffers.
+	sdmmc_sg_t sg_buf;
+	const sdmmc_sg_t *sg = req->sg;
+	u32 sg_cnt = req->sg_cnt;
+	u32 sg_offset = req->sg_offset;
+	if (!sg)
+	{
+		sg_buf.buf = req->buf;
+		sg_buf.size = blkcnt * req->blksize;
+		sg = &sg_buf;
+		sg_cnt = 1;
+		sg_offset = 0;
+	}
+
+	// Build the ADMA2 descriptor table. This also checks alignment.
+	sdmmc_adma_desc_t *desc = (sdmmc_adma_desc_t *)(SDMMC_ADMA_ADDR + sdmmc->id * SDMMC_ADMA_SZ);
+	sdmmc->xfer_desc_cnt = sdmmc_adma_build(desc, SDMMC_ADMA_SZ / sizeof(sdmmc_adma_desc_t), sg, sg_cnt, sg_offset, blkcnt * req->blksize);
+	if (!sdmmc->xfer_desc_cnt)
 		return 0;
+	sdmmc->xfer_is_read = !req->is_write;
 
-	sdmmc->regs->admaaddr = admaaddr;
+	// Select ADMA2. 64-bit descriptors are implied by Host Version 4 64-bit addressing.
+	sdmmc->regs->hostctl = (sdmmc->regs->hostctl & ~SDHCI_CTRL_DMA_MASK) | SDHCI_CTRL_ADMA32;
+	sdmmc->regs->admaaddr = (u32)desc;
 	sdmmc->regs->admaaddr_hi = 0;
 
-	sdmmc->dma_addr_next = (admaaddr + 0x80000) & 0xFFF80000;
-
-	sdmmc->regs->blksize = req->blksize | 0x7000; // DMA 512KB (Detects A18 carry out).
+	sdmmc->regs->blksize = req->blksize;
 	sdmmc->regs->blkcnt = blkcnt;
 
 	if (blkcnt_out)
@@ -955,42 +975,50 @@ static int _sdmmc_update_dma(sdmmc_t *sdmmc)
 		u32 timeout = get_tmr_ms() + 1500;
 		do
 		{
-			int result = 0;
-			while (true)
-			{
-				u16 intr = 0;
-				result = _sdmmc_check_mask_interrupt(sdmmc, &intr,
-					SDHCI_INT_DATA_END | SDHCI_INT_DMA_END);
-				if (result < 0)
-					break;
-
-				if (intr & SDHCI_INT_DATA_END)
-					return 1; // Transfer complete.
-
-				if (intr & SDHCI_INT_DMA_END)
-				{
-					// Update DMA.
-					sdmmc->regs->admaaddr = sdmmc->dma_addr_next;
-					sdmmc->regs->admaaddr_hi = 0;
-					sdmmc->dma_addr_next += 0x80000;
-				}
-			}
+			// ADMA2 walks the whole descriptor table. Only wait for completion.
+			int result = _sdmmc_check_mask_interrupt(sdmmc, NULL, SDHCI_INT_DATA_END);
+			if (result == SDMMC_MASKINT_MASKED)
+				return 1; // Transfer complete.
+
 			if (result != SDMMC_MASKINT_NOERROR)
 			{
 #ifdef ERROR_EXTRA_PRINTING
-				EPRINTFARGS("%08X!", result);
+				EPRINTFARGS("%08X! ADMA %02X", result, sdmmc->regs->admaerr);
 #endif
+				sdmmc_telem_event(sdmmc->id, SDMMC_TELEM_CNT_DMA_ERROR);
 				_sdmmc_reset(sdmmc);
 				return 0;
 			}
 		} while (get_tmr_ms() < timeout);
 	} while (sdmmc->regs->blkcnt != blkcnt);
 
+	sdmmc_telem_event(sdmmc->id, SDMMC_TELEM_CNT_DMA_TIMEOUT);
 	_sdmmc_reset(sdmmc);
 	return 0;
 }
 
-static int _sdmmc_execute_cmd_inner(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out)
+static void _sdmmc_dma_cache_maintenance(sdmmc_t *sdmmc, u32 op)
+{
+	const sdmmc_adma_desc_t *desc = (sdmmc_adma_desc_t *)(SDMMC_ADMA_ADDR + sdmmc->id * SDMMC_ADMA_SZ);
+
+	// Merge contiguous descriptors, so split big buffers are done in one go.
+	u32 addr = desc[0].addr_lo;
+	u32 size = 0;
+	for (u32 i = 0; i < sdmmc->xfer_desc_cnt; i++)
+	{
+		u32 len = desc[i].len;
+		if (desc[i].addr_lo != addr + size)
+		{
+			bpmp_mmu_maintenance_range(op, addr, size);
+			addr = desc[i].addr_lo;
+			size = 0;
+		}
+		size += len;
+	}
+	bpmp_mmu_maintenance_range(op, addr, size);
+}
+
+static int _sdmmc_execute_cmd_start(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req)
 {
 	int has_req_or_check_busy = req || cmd->check_busy;
 	if (!_sdmmc_wait_cmd_data_inhibit(sdmmc, has_req_or_check_busy))
@@ -1008,12 +1036,19 @@ static int _sdmmc_execute_cmd_inner(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_
 			return 0;
 		}
 
-		// Flush cache before starting the transfer.
-		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+		// Flush descriptors and buffers before starting the transfer.
+		bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_PHY, SDMMC_ADMA_ADDR + sdmmc->id * SDMMC_ADMA_SZ,
+			sdmmc->xfer_desc_cnt * sizeof(sdmmc_adma_desc_t));
+		_sdmmc_dma_cache_maintenance(sdmmc, sdmmc->xfer_is_read ? BPMP_MMU_MAINT_CLEAN_INVALID_PHY : BPMP_MMU_MAINT_CLEAN_PHY);
 
 		is_data_present = true;
 	}
 
+	sdmmc->xfer_blkcnt = blkcnt;
+	sdmmc->xfer_has_req = req != NULL;
+	sdmmc->xfer_check_busy = cmd->check_busy;
+	sdmmc->xfer_auto_cmd12 = req && req->is_auto_cmd12;
+
 	_sdmmc_enable_interrupts(sdmmc);
 
 	if (!_sdmmc_send_cmd(sdmmc, cmd, is_data_present))
@@ -1033,28 +1068,36 @@ static int _sdmmc_execute_cmd_inner(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_
 	}
 DPRINTF("rsp(%d): %08X, %08X, %08X, %08X\n", result,
 		sdmmc->regs->rspreg0, sdmmc->regs->rspreg1, sdmmc->regs->rspreg2, sdmmc->regs->rspreg3);
-	if (result)
+	if (result && cmd->rsp_type)
 	{
-		if (cmd->rsp_type)
+		sdmmc->expected_rsp_type = cmd->rsp_type;
+		result = _sdmmc_cache_rsp(sdmmc, sdmmc->rsp, 0x10, cmd->rsp_type);
+		if (!result)
 		{
-			sdmmc->expected_rsp_type = cmd->rsp_type;
-			result = _sdmmc_cache_rsp(sdmmc, sdmmc->rsp, 0x10, cmd->rsp_type);
-			if (!result)
-			{
 #ifdef ERROR_EXTRA_PRINTING
-				EPRINTF("SDMMC: Unknown response type!");
+			EPRINTF("SDMMC: Unknown response type!");
 #endif
-			}
 		}
-		if (req && result)
+	}
+
+	if (!result)
+		_sdmmc_mask_interrupts(sdmmc);
+
+	return result;
+}
+
+static int _sdmmc_execute_cmd_finish(sdmmc_t *sdmmc, u32 *blkcnt_out)
+{
+	int result = 1;
+
+	if (sdmmc->xfer_has_req)
+	{
+		result = _sdmmc_update_dma(sdmmc);
+		if (!result)
 		{
-			result = _sdmmc_update_dma(sdmmc);
-			if (!result)
-			{
 #ifdef ERROR_EXTRA_PRINTING
-				EPRINTFARGS("SDMMC: DMA Update failed (%08X)!", result);
+			EPRINTFARGS("SDMMC: DMA Update failed (%08X)!", result);
 #endif
-			}
 		}
 	}
 
@@ -1062,19 +1105,20 @@ DPRINTF("rsp(%d): %08X, %08X, %08X, %08X\n", result,
 
 	if (result)
 	{
-		if (req)
+		if (sdmmc->xfer_has_req)
 		{
-			// Flush cache after transfer.
-			bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+			// Drop stale lines of the received data.
+			if (sdmmc->xfer_is_read)
+				_sdmmc_dma_cache_maintenance(sdmmc, BPMP_MMU_MAINT_INVALID_PHY);
 
 			if (blkcnt_out)
-				*blkcnt_out = blkcnt;
+				*blkcnt_out = sdmmc->xfer_blkcnt;
 
-			if (req->is_auto_cmd12)
+			if (sdmmc->xfer_auto_cmd12)
 				sdmmc->rsp3 = sdmmc->regs->rspreg3;
 		}
 
-		if (cmd->check_busy || req)
+		if (sdmmc->xfer_check_busy || sdmmc->xfer_has_req)
 		{
 			result = _sdmmc_wait_card_busy(sdmmc);
 			if (!result)
@@ -1082,6 +1126,7 @@ DPRINTF("rsp(%d): %08X, %08X, %08X, %08X\n", result,
 #ifdef ERROR_EXTRA_PRINTING
 				EPRINTF("SDMMC: Busy timeout!");
 #endif
+				sdmmc_telem_event(sdmmc->id, SDMMC_TELEM_CNT_BUSY_TIMEOUT);
 			}
 			return result;
 		}
@@ -1090,6 +1135,14 @@ DPRINTF("rsp(%d): %08X, %08X, %08X, %08X\n", result,
 	return result;
 }
 
+static int _sdmmc_execute_cmd_inner(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out)
+{
+	if (!_sdmmc_execute_cmd_start(sdmmc, cmd, req))
+		return 0;
+
+	return _sdmmc_execute_cmd_finish(sdmmc, blkcnt_out);
+}
+
 bool sdmmc_get_sd_inserted()
 {
 	return (!gpio_read(GPIO_PORT_Z, GPIO_PIN_1));
@@ -1376,6 +1429,75 @@ void sdmmc1_disable_power()
 	PINMUX_AUX(PINMUX_AUX_SDMMC1_CLK) |= PINMUX_PULL_DOWN;
 }
 
+void sdmmc_save_handoff(sdmmc_t *sdmmc, sdmmc_handoff_t *ho)
+{
+	ho->id = sdmmc->id;
+	ho->bus_width = sdmmc_get_bus_width(sdmmc);
+	ho->type = sdmmc->timing;
+	ho->divisor = sdmmc->divisor;
+	ho->clk_source = clock_sdmmc_get_clock_source(sdmmc->id);
+	ho->clkcon_div = sdmmc->regs->clkcon & (SDHCI_DIV_MASK | SDHCI_DIV_HI_MASK);
+	ho->manual_cal = sdmmc->manual_cal;
+	ho->powersave_enabled = sdmmc->powersave_enabled;
+	ho->venclkctl = sdmmc->regs->venclkctl >> 16;
+}
+
+void sdmmc_reject_handoff(sdmmc_t *sdmmc, u32 id)
+{
+	memset(sdmmc, 0, sizeof(sdmmc_t));
+
+	sdmmc->regs = (t210_sdmmc_t *)_sdmmc_bases[id];
+	sdmmc->id = id;
+
+	// Registers are only accessible while the controller is clocked.
+	if (clock_sdmmc_is_not_reset_and_enabled(id))
+		sdmmc_end(sdmmc);
+	else
+	{
+		if (id == SDMMC_1)
+			sdmmc1_disable_power();
+		sdmmc->clock_stopped = 1;
+	}
+}
+
+int sdmmc_init_handoff(sdmmc_t *sdmmc, const sdmmc_handoff_t *ho)
+{
+	// A bad id can't name the controller. Only SD power can be left on by a previous stage.
+	if (ho->id > SDMMC_4 || ho->id == SDMMC_3)
+	{
+		sdmmc_reject_handoff(sdmmc, SDMMC_1);
+		return 0;
+	}
+
+	// The controller must have been left running, with the same host clock.
+	if (!clock_sdmmc_is_not_reset_and_enabled(ho->id) || clock_sdmmc_get_clock_source(ho->id) != ho->clk_source)
+	{
+		sdmmc_reject_handoff(sdmmc, ho->id);
+		return 0;
+	}
+
+	memset(sdmmc, 0, sizeof(sdmmc_t));
+
+	sdmmc->regs = (t210_sdmmc_t *)_sdmmc_bases[ho->id];
+	sdmmc->id = ho->id;
+	sdmmc->t210b01 = hw_get_chip_id() == GP_HIDREV_MAJOR_T210B01;
+	sdmmc->divisor = ho->divisor;
+	sdmmc->timing = ho->type;
+	sdmmc->manual_cal = ho->manual_cal;
+	sdmmc->powersave_enabled = ho->powersave_enabled;
+	sdmmc->card_clock_enabled = 1;
+
+	// Check that card clock, bus and tuning were not reconfigured since.
+	if ((sdmmc->regs->clkcon & (SDHCI_DIV_MASK | SDHCI_DIV_HI_MASK)) != ho->clkcon_div ||
+		sdmmc_get_bus_width(sdmmc) != ho->bus_width || (sdmmc->regs->venclkctl >> 16) != ho->venclkctl)
+	{
+		sdmmc_end(sdmmc);
+		return 0;
+	}
+
+	return 1;
+}
+
 void sdmmc_end(sdmmc_t *sdmmc)
 {
 	if (!sdmmc->clock_stopped)
@@ -1402,7 +1524,7 @@ void sdmmc_init_cmd(sdmmc_cmd_t *cmdbuf, u16 cmd, u32 arg, u32 rsp_type, u32 che
 	cmdbuf->check_busy = check_busy;
 }
 
-int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out)
+static int _sdmmc_card_clock_begin(sdmmc_t *sdmmc)
 {
 	if (!sdmmc->card_clock_enabled)
 		return 0;
@@ -1411,20 +1533,63 @@ int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *b
 	if (sdmmc->manual_cal && sdmmc->powersave_enabled)
 		_sdmmc_autocal_execute(sdmmc, sdmmc_get_io_power(sdmmc));
 
-	int should_disable_sd_clock = 0;
+	sdmmc->xfer_clk_disable = 0;
 	if (!(sdmmc->regs->clkcon & SDHCI_CLOCK_CARD_EN))
 	{
-		should_disable_sd_clock = 1;
+		sdmmc->xfer_clk_disable = 1;
 		sdmmc->regs->clkcon |= SDHCI_CLOCK_CARD_EN;
 		_sdmmc_commit_changes(sdmmc);
 		usleep((8000 + sdmmc->divisor - 1) / sdmmc->divisor);
 	}
 
-	int result = _sdmmc_execute_cmd_inner(sdmmc, cmd, req, blkcnt_out);
+	return 1;
+}
+
+static void _sdmmc_card_clock_end(sdmmc_t *sdmmc)
+{
 	usleep((8000 + sdmmc->divisor - 1) / sdmmc->divisor);
 
-	if (should_disable_sd_clock)
+	if (sdmmc->xfer_clk_disable)
 		sdmmc->regs->clkcon &= ~SDHCI_CLOCK_CARD_EN;
+}
+
+int sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out)
+{
+	if (!_sdmmc_card_clock_begin(sdmmc))
+		return 0;
+
+	int result = _sdmmc_execute_cmd_inner(sdmmc, cmd, req, blkcnt_out);
+
+	_sdmmc_card_clock_end(sdmmc);
+
+	return result;
+}
+
+int sdmmc_execute_cmd_start(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req)
+{
+	if (!_sdmmc_card_clock_begin(sdmmc))
+		return 0;
+
+	if (!_sdmmc_execute_cmd_start(sdmmc, cmd, req))
+	{
+		_sdmmc_card_clock_end(sdmmc);
+		return 0;
+	}
+
+	return 1;
+}
+
+bool sdmmc_execute_cmd_done(sdmmc_t *sdmmc)
+{
+	// Transfer ended or errored out. Status is consumed by sdmmc_execute_cmd_finish.
+	return !!(sdmmc->regs->norintsts & (SDHCI_INT_DATA_END | SDHCI_INT_ERROR));
+}
+
+int sdmmc_execute_cmd_finish(sdmmc_t *sdmmc, u32 *blkcnt_out)
+{
+	int result = _sdmmc_execute_cmd_finish(sdmmc, blkcnt_out);
+
+	_sdmmc_card_clock_end(sdmmc);
 
 	return result;
 }
@@ -19,6 +19,8 @@
 #define _SDMMC_DRIVER_H_
 
 #include <utils/types.h>
+#include <storage/sdmmc_adma.h>
+#include <storage/sdmmc_handoff.h>
 #include <storage/sdmmc_t210.h>
 
 /*! SDMMC controller IDs. */
@@ -212,6 +214,7 @@ typedef struct _sdmmc_t
 	t210_sdmmc_t *regs;
 	u32 id;
 	u32 divisor;
+	u32 timing;
 	u32 clock_stopped;
 	int powersave_enabled;
 	int manual_cal;
@@ -219,7 +222,13 @@ typedef struct _sdmmc_t
 	int venclkctl_set;
 	u32 venclkctl_tap;
 	u32 expected_rsp_type;
-	u32 dma_addr_next;
+	u32 xfer_blkcnt;
+	u32 xfer_desc_cnt;
+	int xfer_is_read;
+	int xfer_has_req;
+	int xfer_check_busy;
+	int xfer_auto_cmd12;
+	int xfer_clk_disable;
 	u32 rsp[4];
 	u32 rsp3;
 	int t210b01;
@@ -243,6 +252,9 @@ typedef struct _sdmmc_req_t
 	int is_write;
 	int is_multi_block;
 	int is_auto_cmd12;
+	sdmmc_sg_t *sg;   // If set, used instead of buf.
+	u32 sg_cnt;
+	u32 sg_offset;    // Bytes of sg already transferred.
 } sdmmc_req_t;
 
 int  sdmmc_get_io_power(sdmmc_t *sdmmc);
@@ -256,9 +268,15 @@ int  sdmmc_tuning_execute(sdmmc_t *sdmmc, u32 type, u32 cmd);
 int  sdmmc_stop_transmission(sdmmc_t *sdmmc, u32 *rsp);
 bool sdmmc_get_sd_inserted();
 int  sdmmc_init(sdmmc_t *sdmmc, u32 id, u32 power, u32 bus_width, u32 type, int powersave_enable);
+int  sdmmc_init_handoff(sdmmc_t *sdmmc, const sdmmc_handoff_t *ho);
+void sdmmc_reject_handoff(sdmmc_t *sdmmc, u32 id);
+void sdmmc_save_handoff(sdmmc_t *sdmmc, sdmmc_handoff_t *ho);
 void sdmmc_end(sdmmc_t *sdmmc);
 void sdmmc_init_cmd(sdmmc_cmd_t *cmdbuf, u16 cmd, u32 arg, u32 rsp_type, u32 check_busy);
 int  sdmmc_execute_cmd(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req, u32 *blkcnt_out);
+int  sdmmc_execute_cmd_start(sdmmc_t *sdmmc, sdmmc_cmd_t *cmd, sdmmc_req_t *req);
+bool sdmmc_execute_cmd_done(sdmmc_t *sdmmc);
+int  sdmmc_execute_cmd_finish(sdmmc_t *sdmmc, u32 *blkcnt_out);
 int  sdmmc_enable_low_voltage(sdmmc_t *sdmmc);
 
 #endif
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sdmmc_handoff.h"
+#include <utils/util.h>
+
+#define HANDOFF_HDR_SIZE 0x10
+
+void sdmmc_handoff_seal(sdmmc_handoff_t *ho)
+{
+	ho->magic = SDMMC_HANDOFF_MAGIC;
+	ho->version = SDMMC_HANDOFF_VERSION;
+	ho->size = sizeof(sdmmc_handoff_t);
+	ho->crc32 = crc32_calc(0, (const u8 *)ho + HANDOFF_HDR_SIZE, sizeof(sdmmc_handoff_t) - HANDOFF_HDR_SIZE);
+}
+
+int sdmmc_handoff_check(const sdmmc_handoff_t *ho)
+{
+	if (ho->magic != SDMMC_HANDOFF_MAGIC || ho->version != SDMMC_HANDOFF_VERSION)
+		return SDMMC_HANDOFF_ERR_MAGIC;
+
+	if (ho->size != sizeof(sdmmc_handoff_t))
+		return SDMMC_HANDOFF_ERR_SIZE;
+
+	u32 crc = crc32_calc(0, (const u8 *)ho + HANDOFF_HDR_SIZE, sizeof(sdmmc_handoff_t) - HANDOFF_HDR_SIZE);
+	if (ho->crc32 != crc)
+		return SDMMC_HANDOFF_ERR_CRC;
+
+	return SDMMC_HANDOFF_OK;
+}
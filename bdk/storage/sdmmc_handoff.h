@@ -0,0 +1,73 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SDMMC_HANDOFF_H_
+#define _SDMMC_HANDOFF_H_
+
+#include <utils/types.h>
+
+/*
+ * Initialized SDMMC card and controller state, passed from one stage to the next.
+ * Lets the next stage skip the full card init, if the card is still in transfer state.
+ */
+
+#define SDMMC_HANDOFF_MAGIC   0x464F4448 // "HDOF".
+#define SDMMC_HANDOFF_VERSION 2
+
+enum
+{
+	SDMMC_HANDOFF_OK        = 0,
+	SDMMC_HANDOFF_ERR_MAGIC = 1,
+	SDMMC_HANDOFF_ERR_SIZE  = 2,
+	SDMMC_HANDOFF_ERR_CRC   = 3
+};
+
+typedef struct _sdmmc_handoff_t
+{
+	u32 magic;
+	u32 version;
+	u32 size;  // Of the whole block.
+	u32 crc32; // Of everything after the header.
+
+	// Card identity.
+	u32 rca;
+	u32 sec_cnt;
+	u32 has_sector_access;
+	u32 is_low_voltage;
+	u32 busspeed;
+	u8  raw_cid[0x10];
+	u8  raw_csd[0x10];
+	u8  raw_scr[8];
+	u8  raw_ssr[0x40];
+
+	// Negotiated bus.
+	u32 id;
+	u32 bus_width;
+	u32 type;
+
+	// Controller state.
+	u32 divisor;
+	u32 clk_source; // CLK_RST_CONTROLLER_CLK_SOURCE_SDMMCx.
+	u32 clkcon_div; // Card clock divider bits of CLKCON.
+	u32 manual_cal;
+	u32 powersave_enabled;
+	u32 venclkctl; // Trimmer and tuned tap value (VENCLKCTL[31:16]).
+} sdmmc_handoff_t;
+
+void sdmmc_handoff_seal(sdmmc_handoff_t *ho);
+int  sdmmc_handoff_check(const sdmmc_handoff_t *ho);
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "sdmmc_telemetry.h"
+#include <utils/sprintf.h>
+
+static const char *_op_names[SDMMC_TELEM_OP_MAX] = { "read", "write", "erase", "flush" };
+static const char *_size_names[SDMMC_TELEM_SZ_MAX] = { "4K", "64K", "1M", "huge" };
+static const char *_cnt_names[SDMMC_TELEM_CNT_MAX] = {
+	"retries", "reinits", "fails", "dma_timeouts", "dma_errors", "busy_timeouts"
+};
+
+u32 sdmmc_telem_bin(u32 lat_us)
+{
+	if (lat_us < 2)
+		return 0;
+
+	u32 bin = 31 - __builtin_clz(lat_us);
+
+	return MIN(bin, SDMMC_TELEM_HIST_BINS - 1);
+}
+
+u32 sdmmc_telem_size_class(u32 num_sectors)
+{
+	if (num_sectors <= 8)
+		return SDMMC_TELEM_SZ_4K;
+	else if (num_sectors <= 128)
+		return SDMMC_TELEM_SZ_64K;
+	else if (num_sectors <= 2048)
+		return SDMMC_TELEM_SZ_1M;
+
+	return SDMMC_TELEM_SZ_HUGE;
+}
+
+void sdmmc_telem_reset(sdmmc_telem_t *t)
+{
+	memset(t, 0, sizeof(sdmmc_telem_t));
+}
+
+static void _sdmmc_telem_add_slow(sdmmc_telem_t *t, u32 op, u32 sector, u32 num_sectors, u32 lat_us, bool ok)
+{
+	sdmmc_telem_slow_t *slow;
+
+	if (t->slow_cnt < SDMMC_TELEM_SLOW_MAX)
+		slow = &t->slow[t->slow_cnt++];
+	else if (lat_us > t->slow[t->slow_min].lat_us)
+		slow = &t->slow[t->slow_min];
+	else
+		return;
+
+	slow->seq = t->seq;
+	slow->sector = sector;
+	slow->num_sectors = num_sectors;
+	slow->lat_us = lat_us;
+	slow->op = op;
+	slow->ok = !!ok;
+
+	// Find the next entry to replace. Only done when a full table changes.
+	if (t->slow_cnt == SDMMC_TELEM_SLOW_MAX)
+	{
+		for (u32 i = 0; i < SDMMC_TELEM_SLOW_MAX; i++)
+			if (t->slow[i].lat_us < t->slow[t->slow_min].lat_us)
+				t->slow_min = i;
+	}
+}
+
+void sdmmc_telem_add(sdmmc_telem_t *t, u32 op, u32 sector, u32 num_sectors, u32 lat_us, bool ok)
+{
+	if (op >= SDMMC_TELEM_OP_MAX)
+		return;
+
+	t->seq++;
+	t->ops[op]++;
+	t->sectors[op] += num_sectors;
+	t->hist[op][sdmmc_telem_size_class(num_sectors)][sdmmc_telem_bin(lat_us)]++;
+	if (lat_us > t->lat_max[op])
+		t->lat_max[op] = lat_us;
+
+	if (!ok)
+		t->counters[SDMMC_TELEM_CNT_FAIL]++;
+
+	_sdmmc_telem_add_slow(t, op, sector, num_sectors, lat_us, ok);
+}
+
+/*
+ * Returns the upper bound of the bin that holds the pct percentile, capped by the max latency.
+ * A size_class of SDMMC_TELEM_SZ_MAX merges all size classes. Returns 0 if there are no requests.
+ */
+u32 sdmmc_telem_percentile(const sdmmc_telem_t *t, u32 op, u32 size_class, u32 pct)
+{
+	u32 bins[SDMMC_TELEM_HIST_BINS] = {0};
+	u32 total = 0;
+
+	for (u32 sz = 0; sz < SDMMC_TELEM_SZ_MAX; sz++)
+	{
+		if (size_class != SDMMC_TELEM_SZ_MAX && sz != size_class)
+			continue;
+
+		for (u32 i = 0; i < SDMMC_TELEM_HIST_BINS; i++)
+		{
+			bins[i] += t->hist[op][sz][i];
+			total += t->hist[op][sz][i];
+		}
+	}
+
+	if (!total)
+		return 0;
+
+	u32 target = MAX((total * pct + 99) / 100, 1);
+	u32 cumul = 0;
+	for (u32 i = 0; i < SDMMC_TELEM_HIST_BINS - 1; i++)
+	{
+		cumul += bins[i];
+		if (cumul >= target)
+			return MIN((2u << i) - 1, t->lat_max[op]);
+	}
+
+	return t->lat_max[op];
+}
+
+// Copies the slow request table sorted by latency, slowest first.
+u32 sdmmc_telem_slowest(const sdmmc_telem_t *t, sdmmc_telem_slow_t *out, u32 max)
+{
+	u32 cnt = MIN(t->slow_cnt, max);
+	bool used[SDMMC_TELEM_SLOW_MAX] = {0};
+
+	for (u32 i = 0; i < cnt; i++)
+	{
+		u32 best = 0;
+		bool found = false;
+		for (u32 j = 0; j < t->slow_cnt; j++)
+		{
+			if (!used[j] && (!found || t->slow[j].lat_us > t->slow[best].lat_us))
+			{
+				best = j;
+				found = true;
+			}
+		}
+
+		used[best] = true;
+		out[i] = t->slow[best];
+	}
+
+	return cnt;
+}
+
+// Writes all telemetry as CSV tables, separated by empty lines. buf must fit SDMMC_TELEM_CSV_MAX.
+u32 sdmmc_telem_csv(const sdmmc_telem_t *t, char *buf)
+{
+	char *pos = buf;
+
+	// Latency histograms.
+	strcpy(pos, "op,size,ops,p50_us,p90_us,p99_us");
+	pos += strlen(pos);
+	for (u32 i = 0; i < SDMMC_TELEM_HIST_BINS; i++)
+	{
+		s_printf(pos, ",ge_%dus", i ? (1u << i) : 0);
+		pos += strlen(pos);
+	}
+	strcpy(pos, "\n");
+	pos++;
+
+	for (u32 op = 0; op < SDMMC_TELEM_OP_MAX; op++)
+	{
+		for (u32 sz = 0; sz < SDMMC_TELEM_SZ_MAX; sz++)
+		{
+			u32 ops = 0;
+			for (u32 i = 0; i < SDMMC_TELEM_HIST_BINS; i++)
+				ops += t->hist[op][sz][i];
+
+			if (!ops)
+				continue;
+
+			s_printf(pos, "%s,%s,%d,%d,%d,%d", _op_names[op], _size_names[sz], ops,
+				sdmmc_telem_percentile(t, op, sz, 50), sdmmc_telem_percentile(t, op, sz, 90),
+				sdmmc_telem_percentile(t, op, sz, 99));
+			pos += strlen(pos);
+
+			for (u32 i = 0; i < SDMMC_TELEM_HIST_BINS; i++)
+			{
+				s_printf(pos, ",%d", t->hist[op][sz][i]);
+				pos += strlen(pos);
+			}
+			strcpy(pos, "\n");
+			pos++;
+		}
+	}
+
+	// Totals and error counters.
+	strcpy(pos, "\ncounter,value\n");
+	pos += strlen(pos);
+	for (u32 op = 0; op < SDMMC_TELEM_OP_MAX; op++)
+	{
+		s_printf(pos, "%s_ops,%d\n%s_sectors,%d\n%s_max_us,%d\n", _op_names[op], t->ops[op],
+			_op_names[op], t->sectors[op], _op_names[op], t->lat_max[op]);
+		pos += strlen(pos);
+	}
+	for (u32 i = 0; i < SDMMC_TELEM_CNT_MAX; i++)
+	{
+		s_printf(pos, "%s,%d\n", _cnt_names[i], t->counters[i]);
+		pos += strlen(pos);
+	}
+
+	// Slowest requests.
+	sdmmc_telem_slow_t slow[SDMMC_TELEM_SLOW_MAX];
+	u32 slow_cnt = sdmmc_telem_slowest(t, slow, SDMMC_TELEM_SLOW_MAX);
+
+	strcpy(pos, "\nseq,op,sector,sectors,lat_us,ok\n");
+	pos += strlen(pos);
+	for (u32 i = 0; i < slow_cnt; i++)
+	{
+		s_printf(pos, "%d,%s,0x%08X,%d,%d,%d\n", slow[i].seq, _op_names[slow[i].op],
+			slow[i].sector, slow[i].num_sectors, slow[i].lat_us, slow[i].ok);
+		pos += strlen(pos);
+	}
+
+	return pos - buf;
+}
+
+#ifdef NYX
+static sdmmc_telem_t _sdmmc_telem[4];
+
+sdmmc_telem_t *sdmmc_telem_get(u32 id)
+{
+	return &_sdmmc_telem[id & 3];
+}
+
+void sdmmc_telem_request(u32 id, u32 op, u32 sector, u32 num_sectors, u32 lat_us, bool ok)
+{
+	sdmmc_telem_add(&_sdmmc_telem[id & 3], op, sector, num_sectors, lat_us, ok);
+}
+
+void sdmmc_telem_event(u32 id, u32 counter)
+{
+	if (counter < SDMMC_TELEM_CNT_MAX)
+		_sdmmc_telem[id & 3].counters[counter]++;
+}
+#endif
@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _SDMMC_TELEMETRY_H_
+#define _SDMMC_TELEMETRY_H_
+
+#include <utils/types.h>
+
+/*
+ * Storage request latency and error telemetry.
+ * Only recorded in Nyx. Elsewhere the storage layer hooks are empty.
+ */
+
+#define SDMMC_TELEM_HIST_BINS 20 // Log2 bins in us. Bin n is [2^n, 2^(n+1)), last one is open-ended.
+#define SDMMC_TELEM_SLOW_MAX  16
+#define SDMMC_TELEM_CSV_MAX   0x2000
+
+enum
+{
+	SDMMC_TELEM_OP_READ  = 0,
+	SDMMC_TELEM_OP_WRITE = 1,
+	SDMMC_TELEM_OP_ERASE = 2,
+	SDMMC_TELEM_OP_FLUSH = 3,
+	SDMMC_TELEM_OP_MAX
+};
+
+enum
+{
+	SDMMC_TELEM_SZ_4K   = 0, // Up to 4KB.
+	SDMMC_TELEM_SZ_64K  = 1,
+	SDMMC_TELEM_SZ_1M   = 2,
+	SDMMC_TELEM_SZ_HUGE = 3, // Over 1MB.
+	SDMMC_TELEM_SZ_MAX
+};
+
+enum
+{
+	SDMMC_TELEM_CNT_RETRY        = 0, // Request chunk retried.
+	SDMMC_TELEM_CNT_REINIT       = 1, // Card reinitialized after retries ran out.
+	SDMMC_TELEM_CNT_FAIL         = 2, // Request failed.
+	SDMMC_TELEM_CNT_DMA_TIMEOUT  = 3,
+	SDMMC_TELEM_CNT_DMA_ERROR    = 4,
+	SDMMC_TELEM_CNT_BUSY_TIMEOUT = 5,
+	SDMMC_TELEM_CNT_MAX
+};
+
+typedef struct _sdmmc_telem_slow_t
+{
+	u32 seq; // Request number.
+	u32 sector;
+	u32 num_sectors;
+	u32 lat_us;
+	u8  op;
+	u8  ok;
+	u16 rsvd;
+} sdmmc_telem_slow_t;
+
+typedef struct _sdmmc_telem_t
+{
+	u32 hist[SDMMC_TELEM_OP_MAX][SDMMC_TELEM_SZ_MAX][SDMMC_TELEM_HIST_BINS];
+	u32 ops[SDMMC_TELEM_OP_MAX];
+	u32 sectors[SDMMC_TELEM_OP_MAX];
+	u32 lat_max[SDMMC_TELEM_OP_MAX];
+	u32 counters[SDMMC_TELEM_CNT_MAX];
+	u32 seq;
+	u32 slow_cnt;
+	u32 slow_min; // Index of the fastest entry, once the table is full.
+	sdmmc_telem_slow_t slow[SDMMC_TELEM_SLOW_MAX];
+} sdmmc_telem_t;
+
+u32  sdmmc_telem_bin(u32 lat_us);
+u32  sdmmc_telem_size_class(u32 num_sectors);
+void sdmmc_telem_reset(sdmmc_telem_t *t);
+void sdmmc_telem_add(sdmmc_telem_t *t, u32 op, u32 sector, u32 num_sectors, u32 lat_us, bool ok);
+u32  sdmmc_telem_percentile(const sdmmc_telem_t *t, u32 op, u32 size_class, u32 pct);
+u32  sdmmc_telem_slowest(const sdmmc_telem_t *t, sdmmc_telem_slow_t *out, u32 max);
+u32  sdmmc_telem_csv(const sdmmc_telem_t *t, char *buf);
+
+#ifdef NYX
+sdmmc_telem_t *sdmmc_telem_get(u32 id);
+void sdmmc_telem_request(u32 id, u32 op, u32 sector, u32 num_sectors, u32 lat_us, bool ok);
+void sdmmc_telem_event(u32 id, u32 counter);
+#else
+static inline void sdmmc_telem_request(u32 id, u32 op, u32 sector, u32 num_sectors, u32 lat_us, bool ok) {}
+static inline void sdmmc_telem_event(u32 id, u32 counter) {}
+#endif
+
+#endif
@@ -1315,8 +1315,11 @@ static int _ums_parse_scsi_cmd(usbd_gadget_ums_t *ums, bulk_ctxt_t *bulk_ctxt)
 	case SC_SYNCHRONIZE_CACHE:
 		ums->data_size_from_cmnd = 0;
 		reply = _ums_check_scsi_cmd(ums, 10, DATA_DIR_NONE, (0xf<<2) | (3<<7), 1);
-		if (reply == 0)
-			reply = 0; // Don't bother
+		if (reply == 0 && !sdmmc_storage_flush(ums->lun.storage))
+		{
+			ums->lun.sense_data = SS_WRITE_ERROR;
+			reply = -5; // I/O error.
+		}
 		break;
 
 	case SC_TEST_UNIT_READY:
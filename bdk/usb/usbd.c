@@ -85,6 +85,7 @@ typedef struct _usbd_t
 	volatile dQH_t *qhs;
 	int ep_configured[4];
 	int ep_bytes_requested[4];
+	u8 *ep_buf[4];
 } usbd_t;
 
 typedef struct _usbd_controller_t
@@ -724,6 +725,13 @@ static usb_ep_status_t _usbd_get_ep_status(usb_ep_t endpoint)
 	return USB_EP_STATUS_IDLE;
 }
 
+static void _usbd_ep_invalidate(usb_ep_t endpoint)
+{
+	// Drop stale lines of the received data and of the updated queue head.
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_INVALID_PHY, (u32)usbdaemon->ep_buf[endpoint], usbdaemon->ep_bytes_requested[endpoint]);
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_INVALID_PHY, (u32)&usbdaemon->qhs[endpoint], sizeof(dQH_t));
+}
+
 static int _usbd_ep_operation(usb_ep_t endpoint, u8 *buf, u32 len, bool sync)
 {
 	if (!buf)
@@ -747,6 +755,7 @@ static int _usbd_ep_operation(usb_ep_t endpoint, u8 *buf, u32 len, bool sync)
 
 	usbdaemon->ep_configured[endpoint] = 1;
 	usbdaemon->ep_bytes_requested[endpoint] = len;
+	usbdaemon->ep_buf[endpoint] = buf;
 
 	// Configure dTD.
 	u32 dtd_idx = 0;
@@ -784,13 +793,19 @@ static int _usbd_ep_operation(usb_ep_t endpoint, u8 *buf, u32 len, bool sync)
 	AHB_GIZMO(AHB_AHB_MEM_PREFETCH_CFG1) &= ~MEM_PREFETCH_ENABLE;
 	AHB_GIZMO(AHB_AHB_MEM_PREFETCH_CFG1) |=  MEM_PREFETCH_ENABLE;
 
+	// Flush descriptors and buffer.
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_PHY, (u32)&usbdaemon->dtds[dtd_ep_idx], sizeof(dTD_t) * (dtd_idx + 1));
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_PHY, (u32)&usbdaemon->qhs[endpoint], sizeof(dQH_t));
 	if (direction == USB_DIR_IN)
 	{
 		prime_bit = USB2D_ENDPT_STATUS_TX_OFFSET << actual_ep;
-		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+		bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_PHY, (u32)buf, len);
 	}
 	else
+	{
 		prime_bit = USB2D_ENDPT_STATUS_RX_OFFSET << actual_ep;
+		bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_INVALID_PHY, (u32)buf, len);
+	}
 
 	// Prime endpoint.
 	usbd_otg->regs->endptprime |= prime_bit; // USB2_CONTROLLER_USB2D_ENDPTPRIME.
@@ -826,7 +841,7 @@ out:
 			res = USB_ERROR_XFER_ERROR;
 
 		if (direction == USB_DIR_OUT)
-			bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+			_usbd_ep_invalidate(endpoint);
 	}
 
 	return res;
@@ -1468,9 +1483,9 @@ int usb_device_ep1_out_reading_finish(u32 *pending_bytes, int tries)
 	}
 	while ((ep_status == USB_EP_STATUS_ACTIVE) || (ep_status == USB_EP_STATUS_STALLED));
 
-	*pending_bytes = _usbd_get_ep1_out_bytes_read();
+	_usbd_ep_invalidate(USB_EP_BULK_OUT);
 
-	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+	*pending_bytes = _usbd_get_ep1_out_bytes_read();
 
 	if (ep_status == USB_EP_STATUS_IDLE)
 		return USB_RES_OK;
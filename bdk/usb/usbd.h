@@ -146,6 +146,7 @@ typedef enum _usb_error_t
 	XUSB_ERROR_INVALID_CYCLE        = USB2_ERROR_XFER_EP_DISABLED, // From 8.
 	XUSB_ERROR_SEQ_NUM              = 51,
 	XUSB_ERROR_XFER_DIR             = 52,
+	XUSB_ERROR_RING_FULL            = 53,
 	XUSB_ERROR_PORT_CFG             = 54
 } usb_error_t;
 
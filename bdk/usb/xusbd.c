@@ -21,6 +21,7 @@
 #include <usb/usbd.h>
 #include <usb/usb_descriptor_types.h>
 #include <usb/usb_t210.h>
+#include <usb/xusbd_ring.h>
 
 #include <gfx_utils.h>
 #include <mem/mc.h>
@@ -35,7 +36,6 @@
 #include <memory_map.h>
 
 #define XUSB_TRB_SLOTS 16 //! TODO: Consider upping it.
-#define XUSB_LINK_TRB_IDX (XUSB_TRB_SLOTS - 1)
 #define XUSB_LAST_TRB_IDX (XUSB_TRB_SLOTS - 1)
 
 #define EP_DONT_RING     0
@@ -83,17 +83,6 @@ typedef enum {
 	// XUSB_SUSPENDED           = ,
 } xusb_dev_state_t;
 
-typedef enum {
-	XUSB_TRB_NONE        = 0,
-	XUSB_TRB_NORMAL      = 1,
-	XUSB_TRB_DATA        = 3,
-	XUSB_TRB_STATUS      = 4,
-	XUSB_TRB_LINK        = 6,
-	XUSB_TRB_TRANSFER    = 32,
-	XUSB_TRB_PORT_CHANGE = 34,
-	XUSB_TRB_SETUP       = 63,
-} xusb_trb_type_t;
-
 typedef enum {
 	XUSB_COMP_INVALID                   = 0,
 	XUSB_COMP_SUCCESS                   = 1,
@@ -204,68 +193,8 @@ typedef struct _status_trb_t
 	u32 rsvd3_2:15;
 } status_trb_t;
 
-typedef struct _normal_trb_t
-{
-	u32 databufptr_lo;
-	u32 databufptr_hi;
 
-	u32 trb_tx_len:17;
-	u32 td_size:5;
-	u32 interrupt_target:10;
 
-	u32 cycle:1;
-	u32 ent:1;
-	u32 isp:1;
-	u32 no_snoop:1;
-	u32 chain:1;
-	u32 ioc:1;
-	u32 idt:1;
-	u32 rsvd0_0:2;
-	u32 bei:1;
-	u32 trb_type:6;
-	u32 rsvd0_1:16;
-} normal_trb_t;
-
-typedef struct _data_trb_t
-{
-	u32 databufptr_lo;
-	u32 databufptr_hi;
-
-	u32 trb_tx_len:17;
-	u32 td_size:5;
-	u32 interrupt_target:10;
-
-	u32 cycle:1;
-	u32 ent:1;
-	u32 isp:1;
-	u32 no_snoop:1;
-	u32 chain:1;
-	u32 ioc:1;
-	u32 rsvd0_0:4;
-	u32 trb_type:6;
-	u32 dir:1;
-	u32 rsvd0_1:15;
-} data_trb_t;
-
-typedef struct _link_trb_t
-{
-	u32 rsvd0_0:4;
-	u32 ring_seg_ptrlo:28;
-
-	u32 ring_seg_ptrhi;
-
-	u32 rsvd1_0:22;
-	u32 interrupt_target:10;
-
-	u32 cycle:1;
-	u32 toggle_cycle:1;
-	u32 rsvd3_0:2;
-	u32 chain:1;
-	u32 ioc:1;
-	u32 rsvd3_1:4;
-	u32 trb_type:6;
-	u32 rsvd3_2:16;
-} link_trb_t;
 
 typedef struct _xusb_ep_ctx_t
 {
@@ -355,21 +284,17 @@ typedef struct _xusb_ep_ctx_t
 
 typedef struct _xusbd_controller_t
 {
-	data_trb_t *cntrl_epenqueue_ptr;
-	data_trb_t *cntrl_epdequeue_ptr;
-	u32 cntrl_producer_cycle;
-	data_trb_t *bulkout_epenqueue_ptr;
-	data_trb_t *bulkout_epdequeue_ptr;
-	u32 bulkout_producer_cycle;
-	data_trb_t *bulkin_epenqueue_ptr;
-	data_trb_t *bulkin_epdequeue_ptr;
-	u32 bulkin_producer_cycle;
+	xusbd_ring_t cntrl_ring;
+	xusbd_ring_t bulkout_ring;
+	xusbd_ring_t bulkin_ring;
 	event_trb_t *event_enqueue_ptr;
 	event_trb_t *event_dequeue_ptr;
 	u32 event_ccs;
 	u32 device_state;
 	u32 bytes_remaining[2];
 	u32 tx_count[2];
+	u8 *out_buf; // Invalidated when reading finishes.
+	u32 out_len;
 	u32 ctrl_seq_num;
 	u32 config_num;
 	u32 interface_num;
@@ -429,6 +354,10 @@ static void _xusbd_ep_init_event_ring()
 	memset(xusb_evtq->xusb_event_ring_seg0, 0, sizeof(xusb_evtq->xusb_event_ring_seg0));
 	memset(xusb_evtq->xusb_event_ring_seg1, 0, sizeof(xusb_evtq->xusb_event_ring_seg1));
 
+	// Write back the cleared rings, so no dirty line can later overwrite an event.
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_INVALID_PHY, (u32)xusb_evtq->xusb_event_ring_seg0,
+		sizeof(xusb_evtq->xusb_event_ring_seg0) + sizeof(xusb_evtq->xusb_event_ring_seg1));
+
 	//! TODO USB3: enable pcie regulators.
 
 	// Set Event Ring Segment 0 Base Address.
@@ -655,8 +584,6 @@ static void _xusb_ep_set_type_and_metrics(u32 ep_idx, volatile xusb_ep_ctx_t *ep
 
 static int _xusb_ep_init_context(u32 ep_idx)
 {
-	link_trb_t *link_trb;
-
 	if (ep_idx > USB_EP_BULK_IN)
 		return USB_ERROR_INIT;
 
@@ -675,54 +602,30 @@ static int _xusb_ep_init_context(u32 ep_idx)
 	switch (ep_idx)
 	{
 	case XUSB_EP_CTRL_IN:
-		usbd_xotg->cntrl_producer_cycle = 1;
-		usbd_xotg->cntrl_epenqueue_ptr = xusb_evtq->xusb_cntrl_event_queue;
-		usbd_xotg->cntrl_epdequeue_ptr = xusb_evtq->xusb_cntrl_event_queue;
+		xusbd_ring_init(&usbd_xotg->cntrl_ring, xusb_evtq->xusb_cntrl_event_queue, XUSB_TRB_SLOTS);
 
 		_xusb_ep_set_type_and_metrics(ep_idx, ep_ctxt);
 
 		ep_ctxt->trd_dequeueptr_lo = (u32)xusb_evtq->xusb_cntrl_event_queue >> 4;
 		ep_ctxt->trd_dequeueptr_hi = 0;
-
-		link_trb = (link_trb_t *)&xusb_evtq->xusb_cntrl_event_queue[XUSB_LINK_TRB_IDX];
-		link_trb->toggle_cycle = 1;
-		link_trb->ring_seg_ptrlo = (u32)xusb_evtq->xusb_cntrl_event_queue >> 4;
-		link_trb->ring_seg_ptrhi = 0;
-		link_trb->trb_type = XUSB_TRB_LINK;
 		break;
 
 	case USB_EP_BULK_OUT:
-		usbd_xotg->bulkout_producer_cycle = 1;
-		usbd_xotg->bulkout_epenqueue_ptr = xusb_evtq->xusb_bulkout_event_queue;
-		usbd_xotg->bulkout_epdequeue_ptr = xusb_evtq->xusb_bulkout_event_queue;
+		xusbd_ring_init(&usbd_xotg->bulkout_ring, xusb_evtq->xusb_bulkout_event_queue, XUSB_TRB_SLOTS);
 
 		_xusb_ep_set_type_and_metrics(ep_idx, ep_ctxt);
 
 		ep_ctxt->trd_dequeueptr_lo = (u32)xusb_evtq->xusb_bulkout_event_queue >> 4;
 		ep_ctxt->trd_dequeueptr_hi = 0;
-
-		link_trb = (link_trb_t *)&xusb_evtq->xusb_bulkout_event_queue[XUSB_LINK_TRB_IDX];
-		link_trb->toggle_cycle = 1;
-		link_trb->ring_seg_ptrlo = (u32)xusb_evtq->xusb_bulkout_event_queue >> 4;
-		link_trb->ring_seg_ptrhi = 0;
-		link_trb->trb_type = XUSB_TRB_LINK;
 		break;
 
 	case USB_EP_BULK_IN:
-		usbd_xotg->bulkin_producer_cycle = 1;
-		usbd_xotg->bulkin_epenqueue_ptr = xusb_evtq->xusb_bulkin_event_queue;
-		usbd_xotg->bulkin_epdequeue_ptr = xusb_evtq->xusb_bulkin_event_queue;
+		xusbd_ring_init(&usbd_xotg->bulkin_ring, xusb_evtq->xusb_bulkin_event_queue, XUSB_TRB_SLOTS);
 
 		_xusb_ep_set_type_and_metrics(ep_idx, ep_ctxt);
 
 		ep_ctxt->trd_dequeueptr_lo = (u32)xusb_evtq->xusb_bulkin_event_queue >> 4;
 		ep_ctxt->trd_dequeueptr_hi = 0;
-
-		link_trb = (link_trb_t *)&xusb_evtq->xusb_bulkin_event_queue[XUSB_LINK_TRB_IDX];
-		link_trb->toggle_cycle = 1;
-		link_trb->ring_seg_ptrlo = (u32)xusb_evtq->xusb_bulkin_event_queue >> 4;
-		link_trb->ring_seg_ptrhi = 0;
-		link_trb->trb_type = XUSB_TRB_LINK;
 		break;
 	}
 
@@ -930,94 +833,70 @@ int xusb_device_init()
 	return USB_RES_OK;
 }
 
-static int _xusb_queue_trb(int ep_idx, void *trb, bool ring_doorbell)
+static xusbd_ring_t *_xusb_get_ring(int ep_idx)
 {
-	int res = USB_RES_OK;
-	data_trb_t *next_trb;
-	link_trb_t *link_trb;
-
-	// Copy TRB and advance Enqueue list.
 	switch (ep_idx)
 	{
 	case XUSB_EP_CTRL_IN:
-		memcpy(usbd_xotg->cntrl_epenqueue_ptr, trb, sizeof(data_trb_t));
-
-		// Advance queue and if Link TRB set index to 0 and toggle cycle bit.
-		next_trb = &usbd_xotg->cntrl_epenqueue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-		{
-			link_trb = (link_trb_t *)next_trb;
-			link_trb->cycle = usbd_xotg->cntrl_producer_cycle & 1;
-			link_trb->toggle_cycle = 1;
-			next_trb = (data_trb_t *)(link_trb->ring_seg_ptrlo << 4);
-			usbd_xotg->cntrl_producer_cycle ^= 1;
-		}
-		usbd_xotg->cntrl_epenqueue_ptr = next_trb;
-		break;
-
+		return &usbd_xotg->cntrl_ring;
 	case USB_EP_BULK_OUT:
-		memcpy(usbd_xotg->bulkout_epenqueue_ptr, trb, sizeof(data_trb_t));
-
-		// Advance queue and if Link TRB set index to 0 and toggle cycle bit.
-		next_trb = &usbd_xotg->bulkout_epenqueue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-		{
-			link_trb = (link_trb_t *)next_trb;
-			link_trb->cycle = usbd_xotg->bulkout_producer_cycle & 1;
-			link_trb->toggle_cycle = 1;
-			next_trb = (data_trb_t *)(link_trb->ring_seg_ptrlo << 4);
-			usbd_xotg->bulkout_producer_cycle ^= 1;
-		}
-		usbd_xotg->bulkout_epenqueue_ptr = next_trb;
-		break;
-
+		return &usbd_xotg->bulkout_ring;
 	case USB_EP_BULK_IN:
-		memcpy(usbd_xotg->bulkin_epenqueue_ptr, trb, sizeof(data_trb_t));
-
-		// Advance queue and if Link TRB set index to 0 and toggle cycle bit.
-		next_trb = &usbd_xotg->bulkin_epenqueue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-		{
-			link_trb = (link_trb_t *)next_trb;
-			link_trb->cycle = usbd_xotg->bulkin_producer_cycle & 1;
-			link_trb->toggle_cycle = 1;
-			next_trb = (data_trb_t *)(link_trb->ring_seg_ptrlo << 4);
-			usbd_xotg->bulkin_producer_cycle ^= 1;
-		}
-		usbd_xotg->bulkin_epenqueue_ptr = next_trb;
-		break;
-
+		return &usbd_xotg->bulkin_ring;
 	case XUSB_EP_CTRL_OUT:
 	default:
-		res = XUSB_ERROR_INVALID_EP;
-		break;
+		return NULL;
 	}
+}
+
+static void _xusb_ring_doorbell(int ep_idx)
+{
+	// Flush rings and endpoint contexts.
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_INVALID_PHY, (u32)xusb_evtq, sizeof(xusbd_event_queues_t));
+	u32 target_id = (ep_idx << 8) & 0xFFFF;
+	if (ep_idx == XUSB_EP_CTRL_IN)
+		target_id |= usbd_xotg->ctrl_seq_num << 16;
+	XUSB_DEV_XHCI(XUSB_DEV_XHCI_DB) = target_id;
+}
+
+static void _xusb_buf_cache_maintenance(u8 *buf, u32 len, usb_dir_t direction)
+{
+	// Write back data to be sent. Also drop lines of buffers to be received.
+	if (direction == USB_DIR_IN)
+		bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_PHY, (u32)buf, len);
+	else
+		bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_CLEAN_INVALID_PHY, (u32)buf, len);
+}
+
+static void _xusb_ep1_out_invalidate()
+{
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_INVALID_PHY, (u32)usbd_xotg->out_buf, usbd_xotg->out_len);
+}
+
+static int _xusb_queue_trb(int ep_idx, void *trb, bool ring_doorbell)
+{
+	xusbd_ring_t *ring = _xusb_get_ring(ep_idx);
+	if (!ring)
+		return XUSB_ERROR_INVALID_EP;
+
+	// Copy TRB and advance Enqueue list.
+	xusbd_ring_queue(ring, trb);
 
-	// Ring doorbell.
 	if (ring_doorbell)
-	{
-		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
-		u32 target_id = (ep_idx << 8) & 0xFFFF;
-		if (ep_idx == XUSB_EP_CTRL_IN)
-			target_id |= usbd_xotg->ctrl_seq_num << 16;
-		XUSB_DEV_XHCI(XUSB_DEV_XHCI_DB) = target_id;
-	}
+		_xusb_ring_doorbell(ep_idx);
 
-	return res;
+	return USB_RES_OK;
 }
 
 static void _xusb_create_status_trb(status_trb_t *trb, usb_dir_t direction)
 {
-	trb->cycle = usbd_xotg->cntrl_producer_cycle & 1;
 	trb->ioc = 1; // Enable interrupt on completion.
 	trb->trb_type = XUSB_TRB_STATUS;
 	trb->dir = direction;
 }
 
-static void _xusb_create_normal_trb(normal_trb_t *trb, u8 *buf, u32 len, usb_dir_t direction)
+static void _xusb_create_normal_trb(normal_trb_t *trb, u8 *buf, u32 len)
 {
-	u8 producer_cycle;
-
 	trb->databufptr_lo = (u32)buf;
 	trb->databufptr_hi = 0;
 
@@ -1027,12 +906,6 @@ static void _xusb_create_normal_trb(normal_trb_t *trb, u8 *buf, u32 len, usb_dir
 	trb->td_size = 0;
 	trb->chain = 0;
 
-	if (direction == USB_DIR_IN)
-		producer_cycle = usbd_xotg->bulkin_producer_cycle & 1;
-	else
-		producer_cycle = usbd_xotg->bulkout_producer_cycle & 1;
-
-	trb->cycle = producer_cycle;
 	trb->isp = 1; // Enable interrupt on short packet.
 	trb->ioc = 1; // Enable interrupt on completion.
 	trb->trb_type = XUSB_TRB_NORMAL;
@@ -1049,7 +922,6 @@ static void _xusb_create_data_trb(data_trb_t *trb, u8 *buf, u32 len, usb_dir_t d
 	trb->td_size = 0;
 	trb->chain = 0;
 
-	trb->cycle = usbd_xotg->cntrl_producer_cycle & 1;
 	trb->isp = 1; // Enable interrupt on short packet.
 	trb->ioc = 1; // Enable interrupt on completion.
 	trb->trb_type = XUSB_TRB_DATA;
@@ -1061,7 +933,7 @@ static int _xusb_issue_status_trb(usb_dir_t direction)
 	int res = USB_RES_OK;
 	status_trb_t trb = {0};
 
-	if (usbd_xotg->cntrl_epenqueue_ptr == usbd_xotg->cntrl_epdequeue_ptr || direction == USB_DIR_OUT)
+	if (usbd_xotg->cntrl_ring.enqueue == usbd_xotg->cntrl_ring.dequeue || direction == USB_DIR_OUT)
 	{
 		_xusb_create_status_trb(&trb, direction);
 		res = _xusb_queue_trb(XUSB_EP_CTRL_IN, &trb, EP_RING_DOORBELL);
@@ -1075,7 +947,8 @@ static int _xusb_issue_normal_trb(u8 *buf, u32 len, usb_dir_t direction)
 {
 	normal_trb_t trb = {0};
 
-	_xusb_create_normal_trb(&trb, buf, len, direction);
+	_xusb_buf_cache_maintenance(buf, len, direction);
+	_xusb_create_normal_trb(&trb, buf, len);
 	int ep_idx = USB_EP_BULK_IN;
 	if (direction == USB_DIR_OUT)
 		ep_idx = USB_EP_BULK_OUT;
@@ -1086,13 +959,33 @@ static int _xusb_issue_normal_trb(u8 *buf, u32 len, usb_dir_t direction)
 	return res;
 }
 
+static int _xusb_queue_normal_td(u8 *buf, u32 len, usb_dir_t direction)
+{
+	normal_trb_t trb = {0};
+
+	_xusb_buf_cache_maintenance(buf, len, direction);
+	_xusb_create_normal_trb(&trb, buf, len);
+	int ep_idx = USB_EP_BULK_IN;
+	if (direction == USB_DIR_OUT)
+		ep_idx = USB_EP_BULK_OUT;
+
+	// Queue TD as chained TRBs. Doorbell is rung by the caller.
+	if (!xusbd_ring_queue_td(_xusb_get_ring(ep_idx), &trb, (u32)buf, len))
+		return XUSB_ERROR_RING_FULL;
+
+	usbd_xotg->wait_for_event_trb = XUSB_TRB_NORMAL;
+
+	return USB_RES_OK;
+}
+
 static int _xusb_issue_data_trb(u8 *buf, u32 len, usb_dir_t direction)
 {
 	data_trb_t trb = {0};
 
 	int res = USB_RES_OK;
-	if (usbd_xotg->cntrl_epenqueue_ptr == usbd_xotg->cntrl_epdequeue_ptr)
+	if (usbd_xotg->cntrl_ring.enqueue == usbd_xotg->cntrl_ring.dequeue)
 	{
+		_xusb_buf_cache_maintenance(buf, len, direction);
 		_xusb_create_data_trb(&trb, buf, len, direction);
 		res = _xusb_queue_trb(XUSB_EP_CTRL_IN, &trb, EP_RING_DOORBELL);
 		if (!res)
@@ -1122,27 +1015,19 @@ int xusb_set_ep_stall(u32 endpoint, int ep_stall)
 
 static int _xusb_handle_transfer_event(transfer_event_trb_t *trb)
 {
+	u32 residue = trb->trb_tx_len;
+
 	// Advance dequeue list.
-	data_trb_t *next_trb;
 	switch (trb->ep_id)
 	{
 	case XUSB_EP_CTRL_IN:
-		next_trb = &usbd_xotg->cntrl_epdequeue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-			next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
-		usbd_xotg->cntrl_epdequeue_ptr = next_trb;
+		xusbd_ring_advance(&usbd_xotg->cntrl_ring);
 		break;
 	case USB_EP_BULK_OUT:
-		next_trb = &usbd_xotg->bulkout_epdequeue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-			next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
-		usbd_xotg->bulkout_epdequeue_ptr = next_trb;
-		break;
 	case USB_EP_BULK_IN:
-		next_trb = &usbd_xotg->bulkin_epdequeue_ptr[1];
-		if (next_trb->trb_type == XUSB_TRB_LINK)
-			next_trb = (data_trb_t *)(next_trb->databufptr_lo & 0xFFFFFFF0);
-		usbd_xotg->bulkin_epdequeue_ptr = next_trb;
+		// Bulk TDs can be chained. Dequeue the whole TD and drop stale events.
+		if (xusbd_ring_complete(_xusb_get_ring(trb->ep_id), (data_trb_t *)(trb->trb_pointer_lo & 0xFFFFFFF0), &residue))
+			return USB_RES_OK;
 		break;
 	default:
 		// Should never happen.
@@ -1173,18 +1058,18 @@ static int _xusb_handle_transfer_event(transfer_event_trb_t *trb)
 			break;
 
 		case USB_EP_BULK_IN:
-			usbd_xotg->bytes_remaining[USB_DIR_IN] -= trb->trb_tx_len;
+			usbd_xotg->bytes_remaining[USB_DIR_IN] -= residue;
 			if (usbd_xotg->tx_count[USB_DIR_IN])///////////
 				usbd_xotg->tx_count[USB_DIR_IN]--;
 
 			// If bytes remaining for a Bulk IN transfer, return error.
-			if (trb->trb_tx_len)
+			if (residue)
 				return XUSB_ERROR_XFER_BULK_IN_RESIDUE;
 			break;
 
 		case USB_EP_BULK_OUT:
 			// If short packet and Bulk OUT, it's not an error because we prime EP for 4KB.
-			usbd_xotg->bytes_remaining[USB_DIR_OUT] -= trb->trb_tx_len;
+			usbd_xotg->bytes_remaining[USB_DIR_OUT] -= residue;
 			if (usbd_xotg->tx_count[USB_DIR_OUT])///////////
 				usbd_xotg->tx_count[USB_DIR_OUT]--;
 			break;
@@ -1703,6 +1588,10 @@ static int _xusb_ep_operation(u32 tries)
 	usbd_xotg->event_enqueue_ptr = (event_trb_t *)(XUSB_DEV_XHCI(XUSB_DEV_XHCI_EREPLO) & 0xFFFFFFF0);
 	event_trb = usbd_xotg->event_dequeue_ptr;
 
+	// Drop stale lines of the event ring. Events are smaller than a cache line.
+	bpmp_mmu_maintenance_range(BPMP_MMU_MAINT_INVALID_PHY, (u32)xusb_evtq->xusb_event_ring_seg0,
+		sizeof(xusb_evtq->xusb_event_ring_seg0) + sizeof(xusb_evtq->xusb_event_ring_seg1));
+
 	// Check if cycle matches.
 	if ((event_trb->cycle & 1) != usbd_xotg->event_ccs)
 		return XUSB_ERROR_INVALID_CYCLE;
@@ -1852,6 +1741,8 @@ int xusb_device_ep1_out_read(u8 *buf, u32 len, u32 *bytes_read, bool sync)
 	int res = USB_RES_OK;
 	usbd_xotg->tx_count[USB_DIR_OUT] = 0;
 	usbd_xotg->bytes_remaining[USB_DIR_OUT] = len;
+	usbd_xotg->out_buf = buf;
+	usbd_xotg->out_len = len;
 	_xusb_issue_normal_trb(buf, len, USB_DIR_OUT);
 	usbd_xotg->tx_count[USB_DIR_OUT]++;
 
@@ -1863,7 +1754,7 @@ int xusb_device_ep1_out_read(u8 *buf, u32 len, u32 *bytes_read, bool sync)
 		if (bytes_read)
 			*bytes_read = res ? 0 : usbd_xotg->bytes_remaining[USB_DIR_OUT];
 
-		bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+		_xusb_ep1_out_invalidate();
 	}
 
 	return res;
@@ -1874,24 +1765,42 @@ int xusb_device_ep1_out_read_big(u8 *buf, u32 len, u32 *bytes_read)
 	if (len > USB_EP_BULK_OUT_MAX_XFER)
 		len = USB_EP_BULK_OUT_MAX_XFER;
 
-	u32 bytes = 0;
+	int res = USB_RES_OK;
 	*bytes_read = 0;
-	u8 *buf_curr = buf;
+	usbd_xotg->tx_count[USB_DIR_OUT] = 0;
+	usbd_xotg->bytes_remaining[USB_DIR_OUT] = 0;
+	usbd_xotg->out_buf = buf;
+	usbd_xotg->out_len = len;
 
-	while (len)
+	// Keep the ring filled with TDs, so the link never idles between them.
+	while (!res && (len || usbd_xotg->tx_count[USB_DIR_OUT]))
 	{
-		u32 len_ep = MIN(len, USB_EP_BUFFER_MAX_SIZE);
+		bool queued = false;
+		while (len)
+		{
+			u32 len_td = MIN(len, USB_EP_BUFFER_MAX_SIZE);
+			if (_xusb_queue_normal_td(buf, len_td, USB_DIR_OUT))
+				break;
 
-		int res = xusb_device_ep1_out_read(buf_curr, len_ep, &bytes, USB_XFER_SYNCED);
-		if (res)
-			return res;
+			usbd_xotg->bytes_remaining[USB_DIR_OUT] += len_td;
+			usbd_xotg->tx_count[USB_DIR_OUT]++;
+			len -= len_td;
+			buf += len_td;
+			queued = true;
+		}
 
-		len -= len_ep;
-		buf_curr += len_ep;
-		*bytes_read = *bytes_read + bytes;
+		// Ring doorbell once for all queued TDs.
+		if (queued)
+			_xusb_ring_doorbell(USB_EP_BULK_OUT);
+
+		res = _xusb_ep_operation(1000000); // 2s timeout.
 	}
 
-	return USB_RES_OK;
+	*bytes_read = res ? 0 : usbd_xotg->bytes_remaining[USB_DIR_OUT];
+
+	_xusb_ep1_out_invalidate();
+
+	return res;
 }
 
 int xusb_device_ep1_out_reading_finish(u32 *pending_bytes, int tries)
@@ -1903,7 +1812,7 @@ int xusb_device_ep1_out_reading_finish(u32 *pending_bytes, int tries)
 	if (pending_bytes)
 		*pending_bytes = res ? 0 : usbd_xotg->bytes_remaining[USB_DIR_OUT];
 
-	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
+	_xusb_ep1_out_invalidate();
 
 	return res;
 }
@@ -1913,8 +1822,6 @@ int xusb_device_ep1_in_write(u8 *buf, u32 len, u32 *bytes_written, bool sync)
 	if (len > USB_EP_BUFFER_MAX_SIZE)
 		len = USB_EP_BUFFER_MAX_SIZE;
 
-	bpmp_mmu_maintenance(BPMP_MMU_MAINT_CLN_INV_WAY, false);
-
 	int res = USB_RES_OK;
 	usbd_xotg->tx_count[USB_DIR_IN] = 0;
 	usbd_xotg->bytes_remaining[USB_DIR_IN] = len;
@@ -0,0 +1,176 @@
+/*
+ * eXtensible USB Device driver (XDCI) transfer ring management
+ *
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include <usb/xusbd_ring.h>
+
+void xusbd_ring_init(xusbd_ring_t *ring, data_trb_t *base, u32 slots)
+{
+	memset(base, 0, sizeof(data_trb_t) * slots);
+
+	ring->base = base;
+	ring->enqueue = base;
+	ring->dequeue = base;
+	ring->slots = slots;
+	ring->producer_cycle = 1;
+	ring->consumer_cycle = 1;
+
+	// Last TRB links back to the start of the ring.
+	link_trb_t *link_trb = (link_trb_t *)&base[slots - 1];
+	link_trb->toggle_cycle = 1;
+	link_trb->ring_seg_ptrlo = (u32)base >> 4;
+	link_trb->ring_seg_ptrhi = 0;
+	link_trb->trb_type = XUSB_TRB_LINK;
+}
+
+data_trb_t *xusbd_ring_next(xusbd_ring_t *ring, data_trb_t *trb)
+{
+	trb++;
+	if (trb == &ring->base[ring->slots - 1])
+		trb = ring->base;
+
+	return trb;
+}
+
+u32 xusbd_ring_free(xusbd_ring_t *ring)
+{
+	u32 usable = ring->slots - 1;
+	u32 used = (ring->enqueue - ring->dequeue + usable) % usable;
+
+	// One slot is kept empty so a full ring can be told apart from an empty one.
+	return usable - 1 - used;
+}
+
+void xusbd_ring_queue(xusbd_ring_t *ring, const void *trb)
+{
+	data_trb_t tmp;
+
+	// Set cycle bit before copying, so the TRB is never seen half written.
+	memcpy(&tmp, trb, sizeof(data_trb_t));
+	tmp.cycle = ring->producer_cycle & 1;
+	memcpy(ring->enqueue, &tmp, sizeof(data_trb_t));
+
+	// Advance queue and if Link TRB set index to 0 and toggle cycle bit.
+	data_trb_t *next_trb = &ring->enqueue[1];
+	if (next_trb == &ring->base[ring->slots - 1])
+	{
+		link_trb_t *link_trb = (link_trb_t *)next_trb;
+		link_trb->chain = tmp.chain; // A TD can continue after the link.
+		link_trb->cycle = ring->producer_cycle & 1;
+		link_trb->toggle_cycle = 1;
+		next_trb = ring->base;
+		ring->producer_cycle ^= 1;
+	}
+	ring->enqueue = next_trb;
+}
+
+static u32 _xusbd_ring_trb_len(u32 buf, u32 len)
+{
+	return MIN(len, XUSB_TRB_MAX_XFER - (buf & (XUSB_TRB_MAX_XFER - 1)));
+}
+
+u32 xusbd_ring_td_trbs(u32 buf, u32 len)
+{
+	u32 trbs = 0;
+
+	do
+	{
+		u32 trb_len = _xusbd_ring_trb_len(buf, len);
+		buf += trb_len;
+		len -= trb_len;
+		trbs++;
+	} while (len);
+
+	return trbs;
+}
+
+u32 xusbd_ring_queue_td(xusbd_ring_t *ring, const normal_trb_t *tmpl, u32 buf, u32 len)
+{
+	normal_trb_t trb;
+
+	u32 trbs = xusbd_ring_td_trbs(buf, len);
+	if (trbs > xusbd_ring_free(ring))
+		return 0;
+
+	memcpy(&trb, tmpl, sizeof(normal_trb_t));
+
+	// Chain all TRBs of the TD and only interrupt on the last one.
+	for (u32 i = 0; i < trbs; i++)
+	{
+		u32 trb_len = _xusbd_ring_trb_len(buf, len);
+
+		trb.databufptr_lo = buf;
+		trb.databufptr_hi = 0;
+		trb.trb_tx_len = trb_len;
+		trb.chain = (i + 1) < trbs;
+		trb.ioc = !trb.chain;
+
+		xusbd_ring_queue(ring, &trb);
+
+		buf += trb_len;
+		len -= trb_len;
+	}
+
+	return trbs;
+}
+
+static data_trb_t *_xusbd_ring_next_cycle(xusbd_ring_t *ring, data_trb_t *trb, u32 *cycle)
+{
+	data_trb_t *next = xusbd_ring_next(ring, trb);
+
+	// Cycle toggles when passing the Link TRB.
+	if (next == ring->base)
+		*cycle ^= 1;
+
+	return next;
+}
+
+void xusbd_ring_advance(xusbd_ring_t *ring)
+{
+	ring->dequeue = _xusbd_ring_next_cycle(ring, ring->dequeue, &ring->consumer_cycle);
+}
+
+int xusbd_ring_complete(xusbd_ring_t *ring, data_trb_t *trb, u32 *residue)
+{
+	data_trb_t *curr = ring->dequeue;
+	u32 cycle = ring->consumer_cycle;
+
+	// Only pending TRBs can complete. Drop events for TDs that already ended on a short packet.
+	while (curr != trb)
+	{
+		if (curr == ring->enqueue)
+			return 1;
+		curr = _xusbd_ring_next_cycle(ring, curr, &cycle);
+	}
+
+	// After a wrap the slot may hold a TRB from another lap. Only accept it if its cycle matches.
+	if (curr == ring->enqueue || (curr->cycle & 1) != (cycle & 1))
+		return 1;
+
+	// Add the untransferred length of the rest of the TD and skip it.
+	while (curr->chain)
+	{
+		curr = _xusbd_ring_next_cycle(ring, curr, &cycle);
+		*residue += curr->trb_tx_len;
+	}
+	ring->dequeue = _xusbd_ring_next_cycle(ring, curr, &cycle);
+	ring->consumer_cycle = cycle;
+
+	return 0;
+}
@@ -0,0 +1,125 @@
+/*
+ * eXtensible USB Device driver (XDCI) transfer ring management
+ *
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _XUSBD_RING_H_
+#define _XUSBD_RING_H_
+
+#include <utils/types.h>
+
+// Max data per TRB. A TRB buffer must also not cross a 64KB boundary.
+#define XUSB_TRB_MAX_XFER 0x10000
+
+typedef enum {
+	XUSB_TRB_NONE        = 0,
+	XUSB_TRB_NORMAL      = 1,
+	XUSB_TRB_DATA        = 3,
+	XUSB_TRB_STATUS      = 4,
+	XUSB_TRB_LINK        = 6,
+	XUSB_TRB_TRANSFER    = 32,
+	XUSB_TRB_PORT_CHANGE = 34,
+	XUSB_TRB_SETUP       = 63,
+} xusb_trb_type_t;
+
+typedef struct _normal_trb_t
+{
+	u32 databufptr_lo;
+	u32 databufptr_hi;
+
+	u32 trb_tx_len:17;
+	u32 td_size:5;
+	u32 interrupt_target:10;
+
+	u32 cycle:1;
+	u32 ent:1;
+	u32 isp:1;
+	u32 no_snoop:1;
+	u32 chain:1;
+	u32 ioc:1;
+	u32 idt:1;
+	u32 rsvd0_0:2;
+	u32 bei:1;
+	u32 trb_type:6;
+	u32 rsvd0_1:16;
+} normal_trb_t;
+
+typedef struct _data_trb_t
+{
+	u32 databufptr_lo;
+	u32 databufptr_hi;
+
+	u32 trb_tx_len:17;
+	u32 td_size:5;
+	u32 interrupt_target:10;
+
+	u32 cycle:1;
+	u32 ent:1;
+	u32 isp:1;
+	u32 no_snoop:1;
+	u32 chain:1;
+	u32 ioc:1;
+	u32 rsvd0_0:4;
+	u32 trb_type:6;
+	u32 dir:1;
+	u32 rsvd0_1:15;
+} data_trb_t;
+
+typedef struct _link_trb_t
+{
+	u32 rsvd0_0:4;
+	u32 ring_seg_ptrlo:28;
+
+	u32 ring_seg_ptrhi;
+
+	u32 rsvd1_0:22;
+	u32 interrupt_target:10;
+
+	u32 cycle:1;
+	u32 toggle_cycle:1;
+	u32 rsvd3_0:2;
+	u32 chain:1;
+	u32 ioc:1;
+	u32 rsvd3_1:4;
+	u32 trb_type:6;
+	u32 rsvd3_2:16;
+} link_trb_t;
+
+typedef struct _xusbd_ring_t
+{
+	data_trb_t *base;
+	data_trb_t *enqueue;
+	data_trb_t *dequeue;
+	u32 slots; // Including the Link TRB.
+	u32 producer_cycle;
+	u32 consumer_cycle; // Cycle bit of the TRB at dequeue, if pending.
+} xusbd_ring_t;
+
+/*
+ * The ring code only touches TRB memory. Doorbells, cache maintenance and
+ * event ring handling are done by xusbd.c.
+ */
+
+void xusbd_ring_init(xusbd_ring_t *ring, data_trb_t *base, u32 slots);
+data_trb_t *xusbd_ring_next(xusbd_ring_t *ring, data_trb_t *trb);
+u32  xusbd_ring_free(xusbd_ring_t *ring);
+void xusbd_ring_queue(xusbd_ring_t *ring, const void *trb);
+u32  xusbd_ring_td_trbs(u32 buf, u32 len);
+u32  xusbd_ring_queue_td(xusbd_ring_t *ring, const normal_trb_t *tmpl, u32 buf, u32 len);
+void xusbd_ring_advance(xusbd_ring_t *ring);
+int  xusbd_ring_complete(xusbd_ring_t *ring, data_trb_t *trb, u32 *residue);
+
+#endif
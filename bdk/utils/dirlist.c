@@ -17,21 +17,124 @@
 #include <string.h>
 #include <stdlib.h>
 
+#include "dirlist.h"
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
 #include <utils/types.h>
 
-char *dirlist(const char *directory, const char *pattern, bool includeHiddenFiles, bool parse_dirs)
+#define DIRLIST_NAMES_INIT   0x1000
+#define DIRLIST_OFFSETS_INIT 64
+
+static void *_dirlist_grow(void *buf, u32 size, u32 new_size)
+{
+	void *res = malloc(new_size);
+	memcpy(res, buf, size);
+	free(buf);
+
+	return res;
+}
+
+static void _dirlist_add(dirlist_t *dl, FILINFO *fno)
+{
+	u32 len = strlen(fno->fname) + 1;
+	u32 rec_start = dl->names_size;
+	u32 rec_size = len;
+
+	if (dl->flags & DIRLIST_INFO)
+	{
+		rec_start = ALIGN(rec_start, 8);
+		rec_size += sizeof(dirlist_info_t);
+	}
+
+	// Grow arrays by doubling them.
+	if (rec_start + rec_size > dl->names_max)
+	{
+		u32 names_max = dl->names_max * 2;
+		while (rec_start + rec_size > names_max)
+			names_max *= 2;
+
+		dl->names = (char *)_dirlist_grow(dl->names, dl->names_size, names_max);
+		dl->names_max = names_max;
+	}
+
+	if (dl->count == dl->offsets_max)
+	{
+		dl->offsets = (u32 *)_dirlist_grow(dl->offsets, dl->count * sizeof(u32), dl->offsets_max * 2 * sizeof(u32));
+		dl->offsets_max *= 2;
+	}
+
+	u32 name_off = rec_start + rec_size - len;
+	if (dl->flags & DIRLIST_INFO)
+	{
+		dirlist_info_t *info = (dirlist_info_t *)(dl->names + rec_start);
+		info->size = fno->fsize;
+		info->date = fno->fdate;
+		info->time = fno->ftime;
+		info->attrib = fno->fattrib;
+	}
+	memcpy(dl->names + name_off, fno->fname, len);
+
+	dl->offsets[dl->count] = name_off;
+	dl->count++;
+	dl->names_size = rec_start + rec_size;
+}
+
+static void _dirlist_sift(const char *names, u32 *offsets, u32 root, u32 count)
 {
-	u8 max_entries = 61;
+	u32 off = offsets[root];
+
+	while (true)
+	{
+		u32 child = root * 2 + 1;
+		if (child >= count)
+			break;
+
+		if (child + 1 < count && strcmp(names + offsets[child + 1], names + offsets[child]) > 0)
+			child++;
+
+		if (strcmp(names + offsets[child], names + off) <= 0)
+			break;
+
+		offsets[root] = offsets[child];
+		root = child;
+	}
+
+	offsets[root] = off;
+}
 
+static void _dirlist_sort(const char *names, u32 *offsets, u32 count)
+{
+	if (count < 2)
+		return;
+
+	// Heapsort. In place and bounded, only the offsets move.
+	for (u32 i = count / 2; i-- > 0;)
+		_dirlist_sift(names, offsets, i, count);
+
+	for (u32 end = count - 1; end > 0; end--)
+	{
+		u32 tmp = offsets[0];
+		offsets[0] = offsets[end];
+		offsets[end] = tmp;
+
+		_dirlist_sift(names, offsets, 0, end);
+	}
+}
+
+dirlist_t *dirlist_ext(const char *directory, const char *pattern, u32 flags)
+{
 	int res = 0;
-	u32 i = 0, j = 0, k = 0;
 	DIR dir;
 	FILINFO fno;
 
-	char *dir_entries = (char *)calloc(max_entries, 256);
-	char *temp = (char *)calloc(1, 256);
+	dirlist_t *dl = (dirlist_t *)calloc(sizeof(dirlist_t), 1);
+	dl->flags = flags;
+	dl->names_max = DIRLIST_NAMES_INIT;
+	dl->offsets_max = DIRLIST_OFFSETS_INIT;
+	dl->names = (char *)malloc(dl->names_max);
+	dl->offsets = (u32 *)malloc(dl->offsets_max * sizeof(u32));
+
+	bool hidden = flags & DIRLIST_HIDDEN;
 
 	if (!pattern && !f_opendir(&dir, directory))
 	{
@@ -41,17 +144,12 @@ char *dirlist(const char *directory, const char *pattern, bool includeHiddenFile
 			if (res || !fno.fname[0])
 				break;
 
-			bool curr_parse = parse_dirs ? (fno.fattrib & AM_DIR) : !(fno.fattrib & AM_DIR);
+			bool curr_parse = (flags & DIRLIST_DIRS) ? (fno.fattrib & AM_DIR) : !(fno.fattrib & AM_DIR);
 
 			if (curr_parse)
 			{
-				if ((fno.fname[0] != '.') && (includeHiddenFiles || !(fno.fattrib & AM_HID)))
-				{
-					strcpy(dir_entries + (k * 256), fno.fname);
-					k++;
-					if (k > (max_entries - 1))
-						break;
-				}
+				if ((fno.fname[0] != '.') && (hidden || !(fno.fattrib & AM_HID)))
+					_dirlist_add(dl, &fno);
 			}
 		}
 		f_closedir(&dir);
@@ -60,41 +158,55 @@ char *dirlist(const char *directory, const char *pattern, bool includeHiddenFile
 	{
 		do
 		{
-			if (!(fno.fattrib & AM_DIR) && (fno.fname[0] != '.') && (includeHiddenFiles || !(fno.fattrib & AM_HID)))
-			{
-				strcpy(dir_entries + (k * 256), fno.fname);
-				k++;
-				if (k > (max_entries - 1))
-					break;
-			}
+			if (!(fno.fattrib & AM_DIR) && (fno.fname[0] != '.') && (hidden || !(fno.fattrib & AM_HID)))
+				_dirlist_add(dl, &fno);
+
 			res = f_findnext(&dir, &fno);
 		} while (fno.fname[0] && !res);
 		f_closedir(&dir);
 	}
 
-	if (!k)
+	if (!dl->count)
 	{
-		free(temp);
-		free(dir_entries);
+		dirlist_free(dl);
 
 		return NULL;
 	}
 
-	// Reorder ini files by ASCII ordering.
-	for (i = 0; i < k - 1 ; i++)
-	{
-		for (j = i + 1; j < k; j++)
-		{
-			if (strcmp(&dir_entries[i * 256], &dir_entries[j * 256]) > 0)
-			{
-				strcpy(temp, &dir_entries[i * 256]);
-				strcpy(&dir_entries[i * 256], &dir_entries[j * 256]);
-				strcpy(&dir_entries[j * 256], temp);
-			}
-		}
-	}
+	// Reorder entries by ASCII ordering.
+	_dirlist_sort(dl->names, dl->offsets, dl->count);
+
+	return dl;
+}
+
+void dirlist_free(dirlist_t *dl)
+{
+	if (!dl)
+		return;
+
+	free(dl->names);
+	free(dl->offsets);
+	free(dl);
+}
+
+char *dirlist(const char *directory, const char *pattern, bool includeHiddenFiles, bool parse_dirs)
+{
+	u32 max_entries = 61;
+
+	dirlist_t *dl = dirlist_ext(directory, pattern,
+		(includeHiddenFiles ? DIRLIST_HIDDEN : 0) | (parse_dirs ? DIRLIST_DIRS : 0));
+	if (!dl)
+		return NULL;
+
+	// Always keep an empty slot at the end.
+	char *dir_entries = (char *)calloc(max_entries + 1, 256);
+
+	// Entries are already sorted. Truncating keeps the first names in ASCII order.
+	u32 count = MIN(dl->count, max_entries);
+	for (u32 i = 0; i < count; i++)
+		strcpy(dir_entries + (i * 256), dirlist_name(dl, i));
 
-	free(temp);
+	dirlist_free(dl);
 
 	return dir_entries;
 }
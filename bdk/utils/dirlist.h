@@ -14,6 +14,50 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#ifndef _DIRLIST_H_
+#define _DIRLIST_H_
+
 #include <utils/types.h>
 
+#define DIRLIST_HIDDEN BIT(0) // Include hidden entries.
+#define DIRLIST_DIRS   BIT(1) // List folders instead of files. Ignored with a pattern.
+#define DIRLIST_INFO   BIT(2) // Keep size, date, time and attributes of each entry.
+
+typedef struct _dirlist_info_t
+{
+	u64 size;
+	u16 date;
+	u16 time;
+	u8  attrib;
+} dirlist_info_t;
+
+typedef struct _dirlist_t
+{
+	char *names;   // Packed names. With DIRLIST_INFO, each is preceded by its dirlist_info_t.
+	u32  *offsets; // Name offsets, sorted by ASCII ordering.
+	u32   count;
+	u32   flags;
+	u32   names_size;
+	u32   names_max;
+	u32   offsets_max;
+} dirlist_t;
+
+dirlist_t *dirlist_ext(const char *directory, const char *pattern, u32 flags);
+void dirlist_free(dirlist_t *dl);
+
+static inline char *dirlist_name(const dirlist_t *dl, u32 idx)
+{
+	return dl->names + dl->offsets[idx];
+}
+
+static inline dirlist_info_t *dirlist_info(const dirlist_t *dl, u32 idx)
+{
+	return (dirlist_info_t *)(dl->names + dl->offsets[idx] - sizeof(dirlist_info_t));
+}
+
+// Compatibility wrapper. Returns up to 61 names in 256 byte slots, ended by an empty one.
+// All entries are sorted first, so a bigger folder yields its first 61 names in ASCII order.
+// The old version kept the first 61 in directory order instead.
 char *dirlist(const char *directory, const char *pattern, bool includeHiddenFiles, bool parse_dirs);
+
+#endif
@@ -22,57 +22,229 @@
 #include <mem/heap.h>
 #include <utils/dirlist.h>
 
-static char *_strdup(char *str)
+#define INI_LINE_MAX 511 // Same line split as f_gets() with a 512 byte buffer.
+
+typedef struct _ini_arena_t
+{
+	u8 *buf;
+	u32 pos;
+} ini_arena_t;
+
+static void *_ini_alloc(ini_arena_t *arena, u32 size)
+{
+	void *ptr = arena->buf + arena->pos;
+	arena->pos += ALIGN(size, sizeof(void *));
+
+	return ptr;
+}
+
+static u32 _ini_hash(const char *str)
+{
+	// FNV-1a.
+	u32 hash = 0x811C9DC5;
+	while (*str)
+	{
+		hash ^= (u8)*str++;
+		hash *= 0x01000193;
+	}
+
+	return hash;
+}
+
+static u32 _ini_pow2(u32 num)
+{
+	u32 res = 1;
+	while (res < num)
+		res <<= 1;
+
+	return res;
+}
+
+static char *_ini_trim(char *str)
 {
 	if (!str)
 		return NULL;
 
 	// Remove starting space.
-	if (str[0] == ' ' && strlen(str))
+	if (str[0] == ' ')
 		str++;
 
-	char *res = (char *)malloc(strlen(str) + 1);
-	strcpy(res, str);
-
 	// Remove trailing space.
-	if (strlen(res) && res[strlen(res) - 1] == ' ')
-		res[strlen(res) - 1] = 0;
+	u32 len = strlen(str);
+	if (len && str[len - 1] == ' ')
+		str[len - 1] = 0;
 
-	return res;
+	return str;
 }
 
-u32 _find_section_name(char *lbuf, u32 lblen, char schar)
+static u32 _find_section_name(char *lbuf, u32 lblen, char schar)
 {
 	u32 i;
-	// Depends on 'FF_USE_STRFUNC 2' that removes \r.
-	for (i = 0; i < lblen  && lbuf[i] != schar && lbuf[i] != '\n'; i++)
+	for (i = 0; i < lblen && lbuf[i] != schar; i++)
 		;
 	lbuf[i] = 0;
 
 	return i;
 }
 
-ini_sec_t *_ini_create_section(link_t *dst, ini_sec_t *csec, char *name, u8 type)
+static ini_sec_t *_ini_create_section(ini_arena_t *arena, link_t *dst, char *name, u8 type)
 {
-	if (csec)
-		list_append(dst, &csec->link);
-
-	csec = (ini_sec_t *)calloc(sizeof(ini_sec_t), 1);
-	csec->name = _strdup(name);
+	ini_sec_t *csec = (ini_sec_t *)_ini_alloc(arena, sizeof(ini_sec_t));
+	csec->name = _ini_trim(name);
 	csec->type = type;
+	list_init(&csec->kvs);
+	list_append(dst, &csec->link);
 
 	return csec;
 }
 
+static u32 _ini_count_lines(const u8 *buf, u32 size)
+{
+	u32 lines = 1 + size / INI_LINE_MAX;
+	for (u32 i = 0; i < size; i++)
+		if (buf[i] == '\n')
+			lines++;
+
+	return lines;
+}
+
+/*
+ * Tokenizes one ini file in place. Lines are compacted from src to dst, which
+ * trails behind it, with '\r' stripped and a NUL in place of '\n'.
+ * Returns the new end of the tokenized text.
+ */
+static char *_ini_parse_text(ini_arena_t *arena, link_t *dst, char *out, const char *src, u32 size)
+{
+	const char *end = src + size;
+	ini_sec_t *csec = NULL;
+
+	do
+	{
+		// Fetch one line.
+		char *lbuf = out;
+		u32 len = 0;
+		bool newline = false;
+		while (src < end && len < INI_LINE_MAX)
+		{
+			char c = *src++;
+			if (c == '\r')
+				continue;
+			if (c == '\n')
+			{
+				newline = true;
+				break;
+			}
+			*out++ = c;
+			len++;
+		}
+		*out++ = 0;
+
+		// Line length as seen by the line handlers, newline included.
+		u32 lblen = strlen(lbuf);
+		bool full_line = lblen == len;
+		len = lblen;
+		if (newline && full_line)
+			lblen++;
+
+		if (lblen > 2 && lbuf[0] == '[') // Create new section.
+		{
+			_find_section_name(lbuf, len, ']');
+
+			csec = _ini_create_section(arena, dst, &lbuf[1], INI_CHOICE);
+		}
+		else if (lblen > 1 && lbuf[0] == '{') // Create new caption. Support empty caption '{}'.
+		{
+			_find_section_name(lbuf, len, '}');
+
+			csec = _ini_create_section(arena, dst, &lbuf[1], INI_CAPTION);
+			csec->color = 0xFF0AB9E6;
+		}
+		else if (lblen > 2 && lbuf[0] == '#') // Create comment.
+		{
+			csec = _ini_create_section(arena, dst, &lbuf[1], INI_COMMENT);
+		}
+		else if (lblen < 2) // Create empty line.
+		{
+			csec = _ini_create_section(arena, dst, NULL, INI_NEWLINE);
+		}
+		else if (csec && csec->type == INI_CHOICE) // Extract key/value.
+		{
+			u32 i = _find_section_name(lbuf, len, '=');
+
+			ini_kv_t *kv = (ini_kv_t *)_ini_alloc(arena, sizeof(ini_kv_t));
+			kv->key = _ini_trim(&lbuf[0]);
+			kv->val = _ini_trim(&lbuf[i < len ? i + 1 : i]); // Key without value gets an empty one.
+			list_append(&csec->kvs, &kv->link);
+		}
+	} while (src < end);
+
+	return out;
+}
+
+static void _ini_build_index(ini_arena_t *arena, link_t *dst, link_t *first)
+{
+	ini_idx_t *idx = (ini_idx_t *)_ini_alloc(arena, sizeof(ini_idx_t));
+
+	// Chain to the indexes of sections already in the list.
+	if (first != dst->next)
+	{
+		ini_idx_t *prev = CONTAINER_OF(dst->next, ini_sec_t, link)->idx;
+		while (prev->next)
+			prev = prev->next;
+		prev->next = idx;
+	}
+
+	u32 secs = 0;
+	for (link_t *l = first; l != dst; l = l->next)
+		secs++;
+
+	idx->sec_mask = _ini_pow2(secs) - 1;
+	idx->sec_idx = (ini_sec_t **)_ini_alloc(arena, (idx->sec_mask + 1) * sizeof(ini_sec_t *));
+
+	// Insert in reverse, so the first of any duplicates ends up at the head of its chain.
+	for (link_t *l = dst->prev; l != first->prev; l = l->prev)
+	{
+		ini_sec_t *sec = CONTAINER_OF(l, ini_sec_t, link);
+		sec->idx = idx;
+
+		if (sec->type != INI_CHOICE)
+			continue;
+
+		sec->hash = _ini_hash(sec->name);
+		sec->hnext = idx->sec_idx[sec->hash & idx->sec_mask];
+		idx->sec_idx[sec->hash & idx->sec_mask] = sec;
+
+		u32 kvs = 0;
+		LIST_FOREACH(kl, &sec->kvs)
+			kvs++;
+		if (!kvs)
+			continue;
+
+		sec->kv_mask = _ini_pow2(kvs) - 1;
+		sec->kv_idx = (ini_kv_t **)_ini_alloc(arena, (sec->kv_mask + 1) * sizeof(ini_kv_t *));
+		for (link_t *kl = sec->kvs.prev; kl != &sec->kvs; kl = kl->prev)
+		{
+			ini_kv_t *kv = CONTAINER_OF(kl, ini_kv_t, link);
+			kv->hash = _ini_hash(kv->key);
+			kv->hnext = sec->kv_idx[kv->hash & sec->kv_mask];
+			sec->kv_idx[kv->hash & sec->kv_mask] = kv;
+		}
+	}
+}
+
 int ini_parse(link_t *dst, char *ini_path, bool is_dir)
 {
-	u32 lblen;
 	u32 pathlen = strlen(ini_path);
-	u32 k = 0;
-	char lbuf[512];
-	char *filelist = NULL;
+	u32 files = 1;
+	u32 size = 0;
+	u32 text_size = 0;
+	u32 lines = 0;
+	int res = 0;
+	dirlist_t *filelist = NULL;
+	char *text = NULL;
 	FIL fp;
-	ini_sec_t *csec = NULL;
+	FILINFO fno;
+	ini_arena_t arena;
 
 	char *filename = (char *)malloc(256);
 
@@ -81,7 +253,7 @@ int ini_parse(link_t *dst, char *ini_path, bool is_dir)
 	// Get all ini filenames.
 	if (is_dir)
 	{
-		filelist = dirlist(filename, "*.ini", false, false);
+		filelist = dirlist_ext(filename, "*.ini", DIRLIST_INFO);
 		if (!filelist)
 		{
 			free(filename);
@@ -89,89 +261,121 @@ int ini_parse(link_t *dst, char *ini_path, bool is_dir)
 		}
 		strcpy(filename + pathlen, "/");
 		pathlen++;
+
+		files = filelist->count;
 	}
 
-	do
+	u32 *fsizes = (u32 *)malloc(files * sizeof(u32));
+
+	// Size the text arena. Each file needs room for the line terminators that do not replace a newline.
+	for (u32 k = 0; k < files; k++)
 	{
-		// Copy ini filename in path string.
 		if (is_dir)
-		{
-			if (filelist[k * 256])
-			{
-				strcpy(filename + pathlen, &filelist[k * 256]);
-				k++;
-			}
-			else
-				break;
-		}
+			fno.fsize = dirlist_info(filelist, k)->size;
+		else if (f_stat(filename, &fno))
+			goto out;
+
+		fsizes[k] = fno.fsize;
+		size += fno.fsize;
+		text_size += fno.fsize + fno.fsize / INI_LINE_MAX + 2;
+	}
+
+	// Read every ini with a single read, at the end of the arena.
+	text = (char *)malloc(text_size);
+	char *raw = text + text_size - size;
+	for (u32 k = 0, pos = 0; k < files; k++)
+	{
+		if (is_dir)
+			strcpy(filename + pathlen, dirlist_name(filelist, k));
 
-		// Open ini.
 		if (f_open(&fp, filename, FA_READ) != FR_OK)
-		{
-			free(filelist);
-			free(filename);
+			goto out;
 
-			return 0;
-		}
+		UINT br = 0;
+		f_read(&fp, raw + pos, fsizes[k], &br);
+		f_close(&fp);
 
-		do
-		{
-			// Fetch one line.
-			lbuf[0] = 0;
-			f_gets(lbuf, 512, &fp);
-			lblen = strlen(lbuf);
+		fsizes[k] = br;
+		lines += _ini_count_lines((u8 *)raw + pos, br);
+		pos += br;
+	}
 
-			// Remove trailing newline. Depends on 'FF_USE_STRFUNC 2' that removes \r.
-			if (lblen && lbuf[lblen - 1] == '\n')
-				lbuf[lblen - 1] = 0;
+	// Every line makes at most one node. Index buckets need at most twice the nodes.
+	arena.buf = (u8 *)calloc(lines * ALIGN(sizeof(ini_sec_t), sizeof(void *)) +
+		(lines * 2 + 2) * sizeof(void *) + ALIGN(sizeof(ini_idx_t), sizeof(void *)), 1);
+	arena.pos = 0;
 
-			if (lblen > 2 && lbuf[0] == '[') // Create new section.
-			{
-				_find_section_name(lbuf, lblen, ']');
+	link_t *last = dst->prev;
+	char *out = text;
+	for (u32 k = 0; k < files; k++)
+	{
+		out = _ini_parse_text(&arena, dst, out, raw, fsizes[k]);
+		raw += fsizes[k];
+	}
 
-				csec = _ini_create_section(dst, csec, &lbuf[1], INI_CHOICE);
-				list_init(&csec->kvs);
-			}
-			else if (lblen > 1 && lbuf[0] == '{') // Create new caption. Support empty caption '{}'.
-			{
-				_find_section_name(lbuf, lblen, '}');
+	if (last->next != dst)
+		_ini_build_index(&arena, dst, last->next);
 
-				csec = _ini_create_section(dst, csec, &lbuf[1], INI_CAPTION);
-				csec->color = 0xFF0AB9E6;
-			}
-			else if (lblen > 2 && lbuf[0] == '#') // Create comment.
-			{
-				csec = _ini_create_section(dst, csec, &lbuf[1], INI_COMMENT);
-			}
-			else if (lblen < 2) // Create empty line.
-			{
-				csec = _ini_create_section(dst, csec, NULL, INI_NEWLINE);
-			}
-			else if (csec && csec->type == INI_CHOICE) // Extract key/value.
-			{
-				u32 i = _find_section_name(lbuf, lblen, '=');
+	res = 1;
 
-				ini_kv_t *kv = (ini_kv_t *)calloc(sizeof(ini_kv_t), 1);
-				kv->key = _strdup(&lbuf[0]);
-				kv->val = _strdup(&lbuf[i + 1]);
-				list_append(&csec->kvs, &kv->link);
-			}
-		} while (!f_eof(&fp));
+out:
+	if (!res)
+		free(text);
+	free(fsizes);
+	free(filename);
+	dirlist_free(filelist);
 
-		f_close(&fp);
+	return res;
+}
 
-		if (csec)
-		{
-			list_append(dst, &csec->link);
-			if (is_dir)
-				csec = NULL;
-		}
-	} while (is_dir);
+static ini_sec_t *_ini_find_sec(ini_idx_t *idx, ini_sec_t *sec, u32 hash, const char *name)
+{
+	// Search the rest of the current chain, then the indexes of later parses.
+	while (idx)
+	{
+		for (; sec; sec = sec->hnext)
+			if (sec->hash == hash && !strcmp(sec->name, name))
+				return sec;
 
-	free(filename);
-	free(filelist);
+		idx = idx->next;
+		if (idx)
+			sec = idx->sec_idx[hash & idx->sec_mask];
+	}
+
+	return NULL;
+}
+
+ini_sec_t *ini_get_sec(link_t *secs, const char *name)
+{
+	if (secs->next == secs)
+		return NULL;
 
-	return 1;
+	ini_idx_t *idx = CONTAINER_OF(secs->next, ini_sec_t, link)->idx;
+	u32 hash = _ini_hash(name);
+
+	return _ini_find_sec(idx, idx->sec_idx[hash & idx->sec_mask], hash, name);
+}
+
+ini_sec_t *ini_get_sec_next(ini_sec_t *sec)
+{
+	if (!sec)
+		return NULL;
+
+	return _ini_find_sec(sec->idx, sec->hnext, sec->hash, sec->name);
+}
+
+ini_kv_t *ini_get_kv(ini_sec_t *sec, const char *key)
+{
+	if (!sec || !sec->kv_idx)
+		return NULL;
+
+	u32 hash = _ini_hash(key);
+
+	for (ini_kv_t *kv = sec->kv_idx[hash & sec->kv_mask]; kv; kv = kv->hnext)
+		if (kv->hash == hash && !strcmp(kv->key, key))
+			return kv;
+
+	return NULL;
 }
 
 char *ini_check_payload_section(ini_sec_t *cfg)
@@ -179,11 +383,7 @@ char *ini_check_payload_section(ini_sec_t *cfg)
 	if (cfg == NULL)
 		return NULL;
 
-	LIST_FOREACH_ENTRY(ini_kv_t, kv, &cfg->kvs, link)
-	{
-		if (!strcmp("payload", kv->key))
-			return kv->val;
-	}
+	ini_kv_t *kv = ini_get_kv(cfg, "payload");
 
-	return NULL;
+	return kv ? kv->val : NULL;
 }
@@ -32,6 +32,8 @@ typedef struct _ini_kv_t
 	char *key;
 	char *val;
 	link_t link;
+	u32 hash;
+	struct _ini_kv_t *hnext;
 } ini_kv_t;
 
 typedef struct _ini_sec_t
@@ -41,9 +43,25 @@ typedef struct _ini_sec_t
 	link_t link;
 	u32 type;
 	u32 color;
+	u32 hash;
+	u32 kv_mask;
+	ini_kv_t **kv_idx;
+	struct _ini_sec_t *hnext;
+	struct _ini_idx_t *idx;
 } ini_sec_t;
 
+typedef struct _ini_idx_t
+{
+	u32 sec_mask;
+	ini_sec_t **sec_idx;
+	struct _ini_idx_t *next; // Index of the next ini_parse() into the same list.
+} ini_idx_t;
+
 int ini_parse(link_t *dst, char *ini_path, bool is_dir);
+// Hashed lookups. Duplicates resolve to the first entry, as a list scan would.
+ini_sec_t *ini_get_sec(link_t *secs, const char *name);
+ini_sec_t *ini_get_sec_next(ini_sec_t *sec); // Next section with the same name, in list order.
+ini_kv_t *ini_get_kv(ini_sec_t *sec, const char *key);
 char *ini_check_payload_section(ini_sec_t *cfg);
 
 #endif
@@ -20,6 +20,7 @@
 
 #include <utils/types.h>
 #include <mem/minerva.h>
+#include <storage/sdmmc_handoff.h>
 
 typedef enum
 {
@@ -59,7 +60,8 @@ typedef struct _nyx_storage_t
 	u32 cfg;
 	u8  irama[0x8000];
 	u8  hekate[0x30000];
-	u8  rsvd[0x800000 - sizeof(nyx_info_t)];
+	u8  rsvd[0x800000 - sizeof(nyx_info_t) - sizeof(sdmmc_handoff_t)];
+	sdmmc_handoff_t sd_handoff;
 	nyx_info_t info;
 	mtc_config_t mtc_cfg;
 	emc_table_t mtc_table[10];
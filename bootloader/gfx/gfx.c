@@ -18,11 +18,26 @@
 #include <stdarg.h>
 #include <string.h>
 #include "gfx.h"
+#include <mem/heap.h>
+
+#define GFX_GLYPH_FIRST 32
+#define GFX_GLYPH_CNT   95
+#define GFX_RUN_MAX     32
+
+typedef struct _gfx_atlas_t
+{
+	u32 fgcol;
+	u32 bgcol;
+	u32 *px[2];                  // Expanded glyph rows. [0]: 8 px wide, [1]: 16 px wide.
+	u8  valid[2][GFX_GLYPH_CNT]; // Glyph expanded with the current colors.
+} gfx_atlas_t;
 
 // Global gfx console and context.
 gfx_ctxt_t gfx_ctxt;
 gfx_con_t gfx_con;
 
+static gfx_atlas_t _gfx_atlas;
+
 static const u8 _gfx_font[] = {
 	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // Char 032 ( )
 	0x00, 0x30, 0x30, 0x18, 0x18, 0x00, 0x0C, 0x00, // Char 033 (!)
@@ -157,6 +172,16 @@ void gfx_con_init()
 	gfx_con.fillbg = 1;
 	gfx_con.bgcol = 0xFF1B1B1B;
 	gfx_con.mute = 0;
+
+	// Allocate glyph atlas. Glyphs get expanded on first use.
+	if (!_gfx_atlas.px[0])
+	{
+		_gfx_atlas.px[0] = (u32 *)malloc(GFX_GLYPH_CNT * 8 * 8 * sizeof(u32));
+		_gfx_atlas.px[1] = (u32 *)malloc(GFX_GLYPH_CNT * 8 * 16 * sizeof(u32));
+	}
+	memset(_gfx_atlas.valid, 0, sizeof(_gfx_atlas.valid));
+	_gfx_atlas.fgcol = gfx_con.fgcol;
+	_gfx_atlas.bgcol = gfx_con.bgcol;
 }
 
 void gfx_con_setcol(u32 fgcol, int fillbg, u32 bgcol)
@@ -178,86 +203,145 @@ void gfx_con_setpos(u32 x, u32 y)
 	gfx_con.y = y;
 }
 
-void gfx_putc(char c)
+static const u32 *_gfx_atlas_get_glyph(char c, u32 big)
 {
-	// Duplicate code for performance reasons.
-	switch (gfx_con.fntsz)
+	u32 idx = c - GFX_GLYPH_FIRST;
+	u32 width = big ? 16 : 8;
+	u32 *px = &_gfx_atlas.px[big][idx * 8 * width];
+
+	if (_gfx_atlas.valid[big][idx])
+		return px;
+
+	// Expand the glyph to full color rows. Big font only doubles columns here, rows get drawn twice.
+	const u8 *cbuf = &_gfx_font[8 * idx];
+	for (u32 i = 0; i < 8; i++)
 	{
-	case 16:
-		if (c >= 32 && c <= 126)
+		u8 v = cbuf[i];
+		for (u32 j = 0; j < 8; j++)
 		{
-			u8 *cbuf = (u8 *)&_gfx_font[8 * (c - 32)];
-			u32 *fb = gfx_ctxt.fb + gfx_con.x + gfx_con.y * gfx_ctxt.stride;
+			u32 color = (v & 1) ? _gfx_atlas.fgcol : _gfx_atlas.bgcol;
+			if (big)
+			{
+				*px++ = color;
+				*px++ = color;
+			}
+			else
+				*px++ = color;
+			v >>= 1;
+		}
+	}
+	_gfx_atlas.valid[big][idx] = 1;
 
-			for (u32 i = 0; i < 16; i += 2)
+	return px - 8 * width;
+}
+
+static void _gfx_putglyphs(const char *s, u32 len)
+{
+	u32 big = gfx_con.fntsz == 16;
+	u32 width = big ? 16 : 8;
+	const u32 *glyphs[GFX_RUN_MAX];
+
+	// Invalidate atlas if colors changed.
+	if (_gfx_atlas.fgcol != gfx_con.fgcol || _gfx_atlas.bgcol != gfx_con.bgcol)
+	{
+		_gfx_atlas.fgcol = gfx_con.fgcol;
+		_gfx_atlas.bgcol = gfx_con.bgcol;
+		memset(_gfx_atlas.valid, 0, sizeof(_gfx_atlas.valid));
+	}
+
+	while (len)
+	{
+		u32 cnt = MIN(len, GFX_RUN_MAX);
+		for (u32 n = 0; n < cnt; n++)
+			glyphs[n] = _gfx_atlas_get_glyph(s[n], big);
+
+		// Draw the whole run line by line.
+		u32 *fb = gfx_ctxt.fb + gfx_con.x + gfx_con.y * gfx_ctxt.stride;
+		for (u32 i = 0; i < 8; i++)
+		{
+			for (u32 k = 0; k <= big; k++)
 			{
-				u8 v = *cbuf;
-				for (u32 k = 0; k < 2; k++)
+				u32 *fbx = fb;
+				for (u32 n = 0; n < cnt; n++)
 				{
-					for (u32 j = 0; j < 8; j++)
+					const u32 *row = &glyphs[n][i * width];
+					for (u32 j = 0; j < width; j += 8)
 					{
-						if (v & 1)
-						{
-							*fb = gfx_con.fgcol;
-							fb++;
-							*fb = gfx_con.fgcol;
-						}
-						else if (gfx_con.fillbg)
-						{
-							*fb = gfx_con.bgcol;
-							fb++;
-							*fb = gfx_con.bgcol;
-						}
-						else
-							fb++;
-						v >>= 1;
-						fb++;
+						fbx[0] = row[0];
+						fbx[1] = row[1];
+						fbx[2] = row[2];
+						fbx[3] = row[3];
+						fbx[4] = row[4];
+						fbx[5] = row[5];
+						fbx[6] = row[6];
+						fbx[7] = row[7];
+						fbx += 8;
+						row += 8;
 					}
-					fb += gfx_ctxt.stride - 16;
-					v = *cbuf;
 				}
-				cbuf++;
+				fb += gfx_ctxt.stride;
 			}
-			gfx_con.x += 16;
-		}
-		else if (c == '\n')
-		{
-			gfx_con.x = 0;
-			gfx_con.y += 16;
-			if (gfx_con.y > gfx_ctxt.height - 16)
-				gfx_con.y = 0;
 		}
-		break;
-	case 8:
-	default:
-		if (c >= 32 && c <= 126)
+
+		gfx_con.x += cnt * width;
+		s += cnt;
+		len -= cnt;
+	}
+}
+
+static void _gfx_putc_bits(char c)
+{
+	u32 scale = gfx_con.fntsz == 16 ? 2 : 1;
+	u8 *cbuf = (u8 *)&_gfx_font[8 * (c - GFX_GLYPH_FIRST)];
+	u32 *fb = gfx_ctxt.fb + gfx_con.x + gfx_con.y * gfx_ctxt.stride;
+
+	for (u32 i = 0; i < 8; i++)
+	{
+		for (u32 k = 0; k < scale; k++)
 		{
-			u8 *cbuf = (u8 *)&_gfx_font[8 * (c - 32)];
-			u32 *fb = gfx_ctxt.fb + gfx_con.x + gfx_con.y * gfx_ctxt.stride;
-			for (u32 i = 0; i < 8; i++)
+			u8 v = *cbuf;
+			for (u32 j = 0; j < 8; j++)
 			{
-				u8 v = *cbuf++;
-				for (u32 j = 0; j < 8; j++)
+				if (v & 1)
 				{
-					if (v & 1)
-						*fb = gfx_con.fgcol;
-					else if (gfx_con.fillbg)
-						*fb = gfx_con.bgcol;
-					v >>= 1;
-					fb++;
+					fb[0] = gfx_con.fgcol;
+					if (scale == 2)
+						fb[1] = gfx_con.fgcol;
 				}
-				fb += gfx_ctxt.stride - 8;
+				else if (gfx_con.fillbg)
+				{
+					fb[0] = gfx_con.bgcol;
+					if (scale == 2)
+						fb[1] = gfx_con.bgcol;
+				}
+				v >>= 1;
+				fb += scale;
 			}
-			gfx_con.x += 8;
-		}
-		else if (c == '\n')
-		{
-			gfx_con.x = 0;
-			gfx_con.y += 8;
-			if (gfx_con.y > gfx_ctxt.height - 8)
-				gfx_con.y = 0;
+			fb += gfx_ctxt.stride - 8 * scale;
 		}
-		break;
+		cbuf++;
+	}
+	gfx_con.x += 8 * scale;
+}
+
+void gfx_putc(char c)
+{
+	u32 fntsz = gfx_con.fntsz == 16 ? 16 : 8;
+
+	if (c >= 32 && c <= 126)
+	{
+		// Use the glyph atlas if background is filled.
+		if (gfx_con.fillbg && _gfx_atlas.px[0])
+			_gfx_putglyphs(&c, 1);
+		else
+			_gfx_putc_bits(c);
+	}
+	else if (c == '\n')
+	{
+		gfx_con.x = 0;
+		gfx_con.y += fntsz;
+		if (gfx_con.y > gfx_ctxt.height - fntsz)
+			gfx_con.y = 0;
 	}
 }
 
@@ -266,8 +350,30 @@ void gfx_puts(char *s)
 	if (!s || gfx_con.mute)
 		return;
 
-	for (; *s; s++)
-		gfx_putc(*s);
+	if (!gfx_con.fillbg || !_gfx_atlas.px[0])
+	{
+		for (; *s; s++)
+			gfx_putc(*s);
+		return;
+	}
+
+	u32 width = gfx_con.fntsz == 16 ? 16 : 8;
+	while (*s)
+	{
+		// Get the run of printable chars that fits in the line.
+		u32 max_len = gfx_con.x < gfx_ctxt.stride ? (gfx_ctxt.stride - gfx_con.x) / width : 0;
+		u32 len = 0;
+		while (len < max_len && s[len] >= 32 && s[len] <= 126)
+			len++;
+
+		if (len)
+		{
+			_gfx_putglyphs(s, len);
+			s += len;
+		}
+		else
+			gfx_putc(*s++);
+	}
 }
 
 static void _gfx_putn(u32 v, int base, char fill, int fcnt)
@@ -200,6 +200,8 @@ int parse_fss(launch_ctxt_t *ctxt, const char *path, fss0_sept_t *sept_ctxt)
 						continue;
 					merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
 					mkip1->kip1 = content;
+					mkip1->hash = NULL;
+					mkip1->owned = false;
 					list_append(&ctxt->kip1_list, &mkip1->link);
 					DPRINTF("Loaded %s.kip1 from FSS0 (size %08X)\n", curr_fss_cnt[i].name, curr_fss_cnt[i].size);
 					break;
@@ -688,7 +688,9 @@ static bool _get_fs_exfat_compatible(link_t *info, bool *fs_is_510)
 		if (strncmp((const char*)ki->kip1->name, "FS", 2))
 			continue;
 
-		if (!se_calc_sha256_oneshot(sha_buf, ki->kip1, ki->size))
+		if (ki->hash)
+			memcpy(sha_buf, ki->hash, sizeof(sha_buf));
+		else if (!se_calc_sha256_oneshot(sha_buf, ki->kip1, ki->size))
 			break;
 
 		pkg2_get_ids(&kip_ids, &fs_ids_cnt);
@@ -986,7 +988,7 @@ int hos_launch(ini_sec_t *cfg)
 
 	// Merge extra KIP1s into loaded ones.
 	LIST_FOREACH_ENTRY(merge_kip_t, mki, &ctxt.kip1_list, link)
-		pkg2_merge_kip(&kip1_info, (pkg2_kip1_t *)mki->kip1);
+		pkg2_merge_kip(&kip1_info, (pkg2_kip1_t *)mki->kip1, mki->hash, mki->owned);
 
 	// Check if FS is compatible with exFAT and if 5.1.0.
 	if (!ctxt.stock && (sd_fs.fs_type == FS_EXFAT || kb == KB_FIRMWARE_VERSION_500))
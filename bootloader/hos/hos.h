@@ -122,6 +122,8 @@ typedef struct _launch_ctxt_t
 typedef struct _merge_kip_t
 {
 	void *kip1;
+	const u8 *hash; // Optional SHA256 of kip1.
+	bool owned;     // kip1 is a heap allocation of its own.
 	link_t link;
 } merge_kip_t;
 
@@ -20,6 +20,7 @@
 #include "hos.h"
 #include "hos_config.h"
 #include "fss.h"
+#include "kip_bundle.h"
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
 #include <storage/nx_sd.h>
@@ -68,6 +69,26 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 
 		u32 dirlen = 0;
 		dir[strlen(dir) - 2] = 0;
+
+		// Try the bundle cache first. It is rebuilt if the directory changed.
+		kipb_hdr_t *bundle = kip_bundle_load(dir);
+		if (bundle)
+		{
+			for (u32 i = 0; i < bundle->count; i++)
+			{
+				merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
+				mkip1->kip1 = (u8 *)bundle + bundle->entries[i].offset;
+				mkip1->hash = bundle->entries[i].hash;
+				mkip1->owned = false;
+				DPRINTF("Loaded kip1 from bundle (size %08X)\n", bundle->entries[i].fsize);
+				list_append(&ctxt->kip1_list, &mkip1->link);
+			}
+
+			free(dir);
+
+			return 1;
+		}
+
 		char *filelist = dirlist(dir, "*.kip*", false, false);
 
 		strcat(dir, "/");
@@ -85,6 +106,8 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 
 				merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
 				mkip1->kip1 = sd_file_read(dir, &size);
+				mkip1->hash = NULL;
+				mkip1->owned = true;
 				if (!mkip1->kip1)
 				{
 					free(mkip1);
@@ -107,6 +130,8 @@ static int _config_kip1(launch_ctxt_t *ctxt, const char *value)
 	{
 		merge_kip_t *mkip1 = (merge_kip_t *)malloc(sizeof(merge_kip_t));
 		mkip1->kip1 = sd_file_read(value, &size);
+		mkip1->hash = NULL;
+		mkip1->owned = true;
 		if (!mkip1->kip1)
 		{
 			free(mkip1);
@@ -249,14 +274,9 @@ static int _config_exo_cal0_writes_enable(launch_ctxt_t *ctxt, const char *value
 
 static int _config_fss(launch_ctxt_t *ctxt, const char *value)
 {
-	LIST_FOREACH_ENTRY(ini_kv_t, kv, &ctxt->cfg->kvs, link)
-	{
-		if (!strcmp("fss0experimental", kv->key))
-		{
-			ctxt->fss0_experimental = *kv->val == '1';
-			break;
-		}
-	}
+	ini_kv_t *kv = ini_get_kv(ctxt->cfg, "fss0experimental");
+	if (kv)
+		ctxt->fss0_experimental = *kv->val == '1';
 
 	return parse_fss(ctxt, value, NULL);
 }
@@ -298,6 +318,7 @@ static const cfg_handler_t _config_handlers[] = {
 
 int parse_boot_config(launch_ctxt_t *ctxt)
 {
+	// Keys are applied in file order and kip1/kip1patch may repeat, so this stays a list walk.
 	LIST_FOREACH_ENTRY(ini_kv_t, kv, &ctxt->cfg->kvs, link)
 	{
 		for(u32 i = 0; _config_handlers[i].key; i++)
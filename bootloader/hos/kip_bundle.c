@@ -0,0 +1,214 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "kip_bundle.h"
+#include "pkg2.h"
+#include <libs/fatfs/ff.h>
+#include <mem/heap.h>
+#include <sec/se.h>
+#include <utils/dirlist.h>
+#include <utils/sprintf.h>
+#include <utils/util.h>
+
+#include <gfx_utils.h>
+
+//#define DPRINTF(...) gfx_printf(__VA_ARGS__)
+#define DPRINTF(...)
+
+u32 kipb_layout(kipb_entry_t *entries, u32 count)
+{
+	u32 offset = sizeof(kipb_hdr_t) + count * sizeof(kipb_entry_t);
+
+	for (u32 i = 0; i < count; i++)
+	{
+		offset = ALIGN(offset, 0x10);
+		entries[i].offset = offset;
+		offset += entries[i].fsize;
+	}
+
+	return offset;
+}
+
+bool kipb_match(const kipb_hdr_t *hdr, u32 size, const kipb_entry_t *scan, u32 count)
+{
+	if (size < sizeof(kipb_hdr_t))
+		return false;
+
+	if (hdr->magic != KIPB_MAGIC || hdr->version != KIPB_VERSION || hdr->size != size || hdr->count != count)
+		return false;
+
+	if (size < sizeof(kipb_hdr_t) + count * sizeof(kipb_entry_t))
+		return false;
+
+	for (u32 i = 0; i < count; i++)
+	{
+		const kipb_entry_t *entry = &hdr->entries[i];
+
+		// Directory state must be the same.
+		if (strcmp(entry->name, scan[i].name) || entry->fsize != scan[i].fsize ||
+			entry->fdate != scan[i].fdate || entry->ftime != scan[i].ftime)
+			return false;
+
+		if (entry->offset > size || entry->fsize > (size - entry->offset))
+			return false;
+	}
+
+	return true;
+}
+
+static u32 _kipb_scan(const char *dir, kipb_entry_t *entries)
+{
+	dirlist_t *filelist = dirlist_ext(dir, "*.kip*", DIRLIST_INFO);
+	if (!filelist)
+		return 0;
+
+	// Do not drop KIPs silently. Per file loading handles the directory instead.
+	u32 count = filelist->count;
+	if (count > KIPB_MAX_ENTRIES)
+	{
+		WPRINTFARGS("%d kips in %s, bundle skipped.\nOnly the first %d are loaded!", count, dir, KIPB_MAX_ENTRIES);
+		dirlist_free(filelist);
+
+		return 0;
+	}
+
+	// Already in ASCII ordering.
+	for (u32 i = 0; i < count; i++)
+	{
+		dirlist_info_t *info = dirlist_info(filelist, i);
+
+		memset(&entries[i], 0, sizeof(kipb_entry_t));
+		strcpy(entries[i].name, dirlist_name(filelist, i));
+		entries[i].fsize = info->size;
+		entries[i].fdate = info->date;
+		entries[i].ftime = info->time;
+	}
+	dirlist_free(filelist);
+
+	return count;
+}
+
+static kipb_hdr_t *_kipb_read(const char *path, const kipb_entry_t *scan, u32 count)
+{
+	FIL fp;
+
+	if (f_open(&fp, path, FA_READ))
+		return NULL;
+
+	u32 size = f_size(&fp);
+	if (size < sizeof(kipb_hdr_t) + count * sizeof(kipb_entry_t))
+	{
+		f_close(&fp);
+		return NULL;
+	}
+
+	kipb_hdr_t *hdr = (kipb_hdr_t *)malloc(size);
+	int res = f_read(&fp, hdr, size, NULL);
+	f_close(&fp);
+
+	u8 hash[0x20];
+	if (res || !kipb_match(hdr, size, scan, count) ||
+		!se_calc_sha256_oneshot(hash, (u8 *)hdr + sizeof(kipb_hdr_t), size - sizeof(kipb_hdr_t)) ||
+		memcmp(hash, hdr->hash, sizeof(hash)))
+	{
+		free(hdr);
+		return NULL;
+	}
+
+	return hdr;
+}
+
+static kipb_hdr_t *_kipb_build(const char *path, const char *dir, kipb_entry_t *scan, u32 count)
+{
+	FIL fp;
+	char *kip_path = (char *)malloc(256 + 256);
+
+	u32 size = kipb_layout(scan, count);
+	kipb_hdr_t *hdr = (kipb_hdr_t *)calloc(size, 1);
+
+	hdr->magic = KIPB_MAGIC;
+	hdr->version = KIPB_VERSION;
+	hdr->count = count;
+	hdr->size = size;
+	memcpy(hdr->entries, scan, count * sizeof(kipb_entry_t));
+
+	for (u32 i = 0; i < count; i++)
+	{
+		kipb_entry_t *entry = &hdr->entries[i];
+		u8 *kip = (u8 *)hdr + entry->offset;
+
+		s_printf(kip_path, "%s/%s", dir, entry->name);
+		if (f_open(&fp, kip_path, FA_READ))
+			goto error;
+
+		int res = f_read(&fp, kip, entry->fsize, NULL);
+		f_close(&fp);
+		if (res)
+			goto error;
+
+		// Hash the same size that pkg2 patching hashes.
+		u32 kip_size = entry->fsize;
+		if (kip_size >= sizeof(pkg2_kip1_t))
+			kip_size = MIN(kip_size, pkg2_calc_kip1_size((pkg2_kip1_t *)kip));
+		se_calc_sha256_oneshot(entry->hash, kip, kip_size);
+	}
+
+	se_calc_sha256_oneshot(hdr->hash, (u8 *)hdr + sizeof(kipb_hdr_t), size - sizeof(kipb_hdr_t));
+
+	// Failing to save only means that the next boot will rebuild it.
+	if (!f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE))
+	{
+		f_write(&fp, hdr, size, NULL);
+		f_close(&fp);
+	}
+	DPRINTF("Rebuilt kip bundle %s\n", path);
+
+	free(kip_path);
+
+	return hdr;
+
+error:
+	free(kip_path);
+	free(hdr);
+
+	return NULL;
+}
+
+kipb_hdr_t *kip_bundle_load(const char *dir)
+{
+	char path[40];
+	kipb_entry_t *scan = (kipb_entry_t *)malloc(KIPB_MAX_ENTRIES * sizeof(kipb_entry_t));
+
+	u32 count = _kipb_scan(dir, scan);
+	if (!count)
+	{
+		free(scan);
+		return NULL;
+	}
+
+	// One bundle per directory.
+	s_printf(path, "bootloader/sys/kips_%08X.bin", crc32_calc(0, (const u8 *)dir, strlen(dir)));
+
+	kipb_hdr_t *hdr = _kipb_read(path, scan, count);
+	if (!hdr)
+		hdr = _kipb_build(path, dir, scan, count);
+
+	free(scan);
+
+	return hdr;
+}
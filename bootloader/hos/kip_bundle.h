@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _KIP_BUNDLE_H_
+#define _KIP_BUNDLE_H_
+
+#include <utils/types.h>
+
+/*
+ * KIP bundle cache for kip1 directory entries.
+ *
+ * All KIPs of a directory are stored in one file, together with their SHA256
+ * and the name, size and timestamp of each source file. The bundle is rebuilt
+ * when any of these change.
+ */
+
+#define KIPB_MAGIC       0x42504B48 // "HKPB".
+#define KIPB_VERSION     2
+#define KIPB_MAX_ENTRIES 61 // Same as dirlist. Bigger directories are loaded per file.
+
+typedef struct _kipb_entry_t
+{
+	char name[256];
+	u32 fsize;
+	u16 fdate;
+	u16 ftime;
+	u32 offset;
+	u32 rsvd;
+	u8  hash[0x20];
+} kipb_entry_t;
+
+typedef struct _kipb_hdr_t
+{
+	u32 magic;
+	u32 version;
+	u32 count;
+	u32 size;
+	u8  hash[0x20]; // SHA256 of everything after the header.
+	kipb_entry_t entries[];
+} kipb_hdr_t;
+
+// Format helpers. No I/O.
+u32  kipb_layout(kipb_entry_t *entries, u32 count);
+bool kipb_match(const kipb_hdr_t *hdr, u32 size, const kipb_entry_t *scan, u32 count);
+
+kipb_hdr_t *kip_bundle_load(const char *dir);
+
+#endif
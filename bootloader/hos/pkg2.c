@@ -842,7 +842,7 @@ const pkg2_kernel_id_t *pkg2_identify(u8 *hash)
 	return NULL;
 }
 
-static u32 _pkg2_calc_kip1_size(pkg2_kip1_t *kip1)
+u32 pkg2_calc_kip1_size(pkg2_kip1_t *kip1)
 {
 	u32 size = sizeof(pkg2_kip1_t);
 	for (u32 j = 0; j < KIP1_NUM_SECTIONS; j++)
@@ -904,7 +904,9 @@ bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2)
 		pkg2_kip1_t *kip1 = (pkg2_kip1_t *)ptr;
 		pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
 		ki->kip1 = kip1;
-		ki->size = _pkg2_calc_kip1_size(kip1);
+		ki->size = pkg2_calc_kip1_size(kip1);
+		ki->hash = NULL;
+		ki->owned = false;
 		list_append(info, &ki->link);
 		ptr += ki->size;
 DPRINTF(" kip1 %d:%s @ %08X (%08X)\n", i, kip1->name, (u32)kip1, ki->size);
@@ -921,35 +923,39 @@ int pkg2_has_kip(link_t *info, u64 tid)
 	return 0;
 }
 
-void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1)
+void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1, const u8 *hash, bool owned)
 {
 	LIST_FOREACH_ENTRY(pkg2_kip1_info_t, ki, info, link)
 	{
 		if (ki->kip1->tid == tid)
 		{
 			ki->kip1 = kip1;
-			ki->size = _pkg2_calc_kip1_size(kip1);
+			ki->size = pkg2_calc_kip1_size(kip1);
+			ki->hash = hash;
+			ki->owned = owned;
 DPRINTF("replaced kip %s (new size %08X)\n", kip1->name, ki->size);
 			return;
 		}
 	}
 }
 
-void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1)
+void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1, const u8 *hash, bool owned)
 {
 	pkg2_kip1_info_t *ki = (pkg2_kip1_info_t *)malloc(sizeof(pkg2_kip1_info_t));
 	ki->kip1 = kip1;
-	ki->size = _pkg2_calc_kip1_size(kip1);
+	ki->size = pkg2_calc_kip1_size(kip1);
+	ki->hash = hash;
+	ki->owned = owned;
 DPRINTF("added kip %s (size %08X)\n", kip1->name, ki->size);
 	list_append(info, &ki->link);
 }
 
-void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1)
+void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1, const u8 *hash, bool owned)
 {
 	if (pkg2_has_kip(info, kip1->tid))
-		pkg2_replace_kip(info, kip1->tid, kip1);
+		pkg2_replace_kip(info, kip1->tid, kip1, hash, owned);
 	else
-		pkg2_add_kip(info, kip1);
+		pkg2_add_kip(info, kip1, hash, owned);
 }
 
 int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp)
@@ -1015,9 +1021,13 @@ int pkg2_decompress_kip(pkg2_kip1_info_t* ki, u32 sectsToDecomp)
 	memcpy(newKip, &hdr, sizeof(hdr));
 	newKipSize = dstDataPtr-(unsigned char*)(newKip);
 
-	free(ki->kip1);
+	// KIPs inside pkg2, FSS0 or a bundle are not allocations of their own.
+	if (ki->owned)
+		free(ki->kip1);
 	ki->kip1 = newKip;
 	ki->size = newKipSize;
+	ki->hash = NULL;
+	ki->owned = true;
 
 	return 0;
 }
@@ -1040,6 +1050,8 @@ static int _kipm_inject(const char *kipm_path, char *target_name, pkg2_kip1_info
 		pkg2_kip1_t *fs_kip = ki->kip1;
 		ki->kip1 = (pkg2_kip1_t *)kip_patched_data;
 		ki->size = ki->size + inject_size;
+		ki->hash = NULL;
+		ki->owned = true;
 
 		// Patch caps.
 		memcpy(&ki->kip1->caps, kipm_data, sizeof(ki->kip1->caps));
@@ -1178,7 +1190,9 @@ const char* pkg2_patch_kips(link_t *info, char* patchNames)
 
 			if (shaBuf[0] == 0)
 			{
-				if (!se_calc_sha256_oneshot(shaBuf, ki->kip1, ki->size))
+				if (ki->hash)
+					memcpy(shaBuf, ki->hash, sizeof(shaBuf));
+				else if (!se_calc_sha256_oneshot(shaBuf, ki->kip1, ki->size))
 					memset(shaBuf, 0, sizeof(shaBuf));
 			}
 
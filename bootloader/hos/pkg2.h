@@ -116,6 +116,8 @@ typedef struct _pkg2_kip1_info_t
 {
 	pkg2_kip1_t *kip1;
 	u32 size;
+	const u8 *hash; // SHA256 of kip1, if already known.
+	bool owned;     // kip1 is a heap allocation of its own and can be freed.
 	link_t link;
 } pkg2_kip1_info_t;
 
@@ -147,11 +149,12 @@ typedef struct _kip1_id_t
 } kip1_id_t;
 
 void pkg2_get_newkern_info(u8 *kern_data);
+u32  pkg2_calc_kip1_size(pkg2_kip1_t *kip1);
 bool pkg2_parse_kips(link_t *info, pkg2_hdr_t *pkg2, bool *new_pkg2);
 int  pkg2_has_kip(link_t *info, u64 tid);
-void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1);
-void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1);
-void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1);
+void pkg2_replace_kip(link_t *info, u64 tid, pkg2_kip1_t *kip1, const u8 *hash, bool owned);
+void pkg2_add_kip(link_t *info, pkg2_kip1_t *kip1, const u8 *hash, bool owned);
+void pkg2_merge_kip(link_t *info, pkg2_kip1_t *kip1, const u8 *hash, bool owned);
 void pkg2_get_ids(kip1_id_t **ids, u32 *entries);
 const char* pkg2_patch_kips(link_t *info, char* patchNames);
 
@@ -4,6 +4,7 @@
 #include "pkg2_ini_kippatch.h"
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
+#include <storage/sd_stream.h>
 
 #define KPS(x) ((u32)(x) << 29)
 
@@ -88,18 +89,18 @@ int ini_patch_parse(link_t *dst, char *ini_path)
 {
 	u32 lblen;
 	char lbuf[512];
-	FIL fp;
+	sd_stream_t st;
 	ini_kip_sec_t *ksec = NULL;
 
-	// Open ini.
-	if (f_open(&fp, ini_path, FA_READ) != FR_OK)
+	// Open ini. Lines are served from the read-ahead window, instead of one f_read per byte.
+	if (sd_stream_open(&st, ini_path, SD_STREAM_WINDOW_DEF) != FR_OK)
 		return 0;
 
 	do
 	{
 		// Fetch one line.
 		lbuf[0] = 0;
-		f_gets(lbuf, 512, &fp);
+		sd_stream_gets(&st, lbuf, 512);
 		lblen = strlen(lbuf);
 
 		// Remove trailing newline. Depends on 'FF_USE_STRFUNC 2' that removes \r.
@@ -145,9 +146,9 @@ int ini_patch_parse(link_t *dst, char *ini_path)
 
 			list_append(&ksec->pts, &pt->link);
 		}
-	} while (!f_eof(&fp));
+	} while (!sd_stream_eof(&st));
 
-	f_close(&fp);
+	sd_stream_close(&st);
 
 	if (ksec)
 		list_append(dst, &ksec->link);
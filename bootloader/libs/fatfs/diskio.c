@@ -69,5 +69,21 @@ DRESULT disk_ioctl (
 	void *buff		/* Buffer to send/receive control data */
 )
 {
+	DWORD *buf = (DWORD *)buff;
+
+	switch (cmd)
+	{
+	case CTRL_SYNC:
+		if (!sdmmc_storage_flush(&sd_storage))
+			return RES_ERROR;
+		break;
+	case CTRL_TRIM:
+		if (!sd_get_discard())
+			break;
+		if (!sdmmc_storage_erase(&sd_storage, buf[0], buf[1] - buf[0] + 1, SDMMC_ERASE_DISCARD))
+			return RES_ERROR;
+		break;
+	}
+
 	return RES_OK;
 }
@@ -31,6 +31,7 @@
 #include "hos/sept.h"
 #include <ianos/ianos.h>
 #include <libs/compr/blz.h>
+#include <libs/compr/lz4_pak.h>
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
 #include <mem/minerva.h>
@@ -50,6 +51,7 @@
 #include "storage/emummc.h"
 #include "storage/nx_emmc.h"
 #include <storage/nx_sd.h>
+#include <storage/sd_stream.h>
 #include <storage/sdmmc.h>
 #include <utils/btn.h>
 #include <utils/dirlist.h>
@@ -214,8 +216,8 @@ int launch_payload(char *path, bool update)
 
 	if (sd_mount())
 	{
-		FIL fp;
-		if (f_open(&fp, path, FA_READ))
+		sd_stream_t st;
+		if (sd_stream_open(&st, path, 0))
 		{
 			gfx_con.mute = 0;
 			EPRINTFARGS("Payload file is missing!\n(%s)", path);
@@ -225,7 +227,7 @@ int launch_payload(char *path, bool update)
 
 		// Read and copy the payload to our chosen address
 		void *buf;
-		u32 size = f_size(&fp);
+		u32 size = f_size(&st.fp);
 
 		if (size < 0x30000)
 			buf = (void *)RCM_PAYLOAD_ADDR;
@@ -235,7 +237,7 @@ int launch_payload(char *path, bool update)
 			buf = coreboot_addr;
 			if (h_cfg.t210b01)
 			{
-				f_close(&fp);
+				sd_stream_close(&st);
 
 				gfx_con.mute = 0;
 				EPRINTF("T210B01: Coreboot not allowed!");
@@ -244,14 +246,14 @@ int launch_payload(char *path, bool update)
 			}
 		}
 
-		if (f_read(&fp, buf, size, NULL))
+		if (sd_stream_read(&st, buf, size, NULL))
 		{
-			f_close(&fp);
+			sd_stream_close(&st);
 
 			goto out;
 		}
 
-		f_close(&fp);
+		sd_stream_close(&st);
 
 		if (update && is_ipl_updated(buf, path, false))
 			goto out;
@@ -683,11 +685,35 @@ void nyx_load_run()
 {
 	sd_mount();
 
-	u8 *nyx = sd_file_read("bootloader/sys/nyx.bin", NULL);
+	u32 nyx_size = 0;
+	u8 *nyx = sd_file_read("bootloader/sys/nyx.bin", &nyx_size);
 	if (!nyx)
 		return;
 
-	sd_end();
+	// Unpack Nyx if it's LZ4 packed.
+	const lz4_pak_hdr_t *nyx_pak = lz4_pak_get_hdr(nyx, nyx_size);
+	if (nyx_pak)
+	{
+		// It must fit in the Nyx load region.
+		if (nyx_pak->raw_size > NYX_SZ_MAX || nyx_pak->raw_size <= NYX_VER_OFF + sizeof(u32))
+		{
+			free(nyx);
+
+			return;
+		}
+
+		u8 *nyx_unp = (u8 *)malloc(nyx_pak->raw_size);
+		if (!lz4_pak_unpack(nyx, nyx_unp))
+		{
+			free(nyx_unp);
+			free(nyx);
+
+			return;
+		}
+
+		free(nyx);
+		nyx = nyx_unp;
+	}
 
 	u32 expected_nyx_ver = ((NYX_VER_MJ + '0') << 24) | ((NYX_VER_MN + '0') << 16) | ((NYX_VER_HF + '0') << 8);
 	u32 nyx_ver = byte_swap_32(*(u32 *)(nyx + NYX_VER_OFF));
@@ -713,6 +739,11 @@ void nyx_load_run()
 		btn_wait();
 	}
 
+	// Hand the initialized SD card over, so Nyx can skip its init. Older versions expect it powered off.
+	nyx_str->sd_handoff.magic = 0;
+	if (nyx_ver < expected_nyx_ver || !sd_handoff((sdmmc_handoff_t *)&nyx_str->sd_handoff))
+		sd_end();
+
 	nyx_str->info.errors = h_cfg.errors;
 	nyx_str->cfg = 0;
 	if (b_cfg.extra_cfg)
@@ -755,17 +786,20 @@ void nyx_load_run()
 
 static ini_sec_t *get_ini_sec_from_id(ini_sec_t *ini_sec, char **bootlogoCustomEntry, char **emummc_path)
 {
-	ini_sec_t *cfg_sec = NULL;
+	// Sections without a matching id are rejected by a single hashed lookup.
+	ini_kv_t *id = ini_get_kv(ini_sec, "id");
+	if (!id || !b_cfg.id[0] || !id->val[0] || strcmp(b_cfg.id, id->val))
+	{
+		*bootlogoCustomEntry = NULL;
+		*emummc_path = NULL;
+		h_cfg.emummc_force_disable = false;
 
+		return NULL;
+	}
+
+	// Scan the matching one, so the last of any duplicate keys wins.
 	LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
 	{
-		if (!strcmp("id", kv->key))
-		{
-			if (b_cfg.id[0] && kv->val[0] && !strcmp(b_cfg.id, kv->val))
-				cfg_sec = ini_sec;
-			else
-				break;
-		}
 		if (!strcmp("logopath", kv->key))
 			*bootlogoCustomEntry = kv->val;
 		if (!strcmp("emummc_force_disable", kv->key))
@@ -773,14 +807,8 @@ static ini_sec_t *get_ini_sec_from_id(ini_sec_t *ini_sec, char **bootlogoCustomE
 		if (!strcmp("emupath", kv->key))
 			*emummc_path = kv->val;
 	}
-	if (!cfg_sec)
-	{
-		*bootlogoCustomEntry = NULL;
-		*emummc_path = NULL;
-		h_cfg.emummc_force_disable = false;
-	}
 
-	return cfg_sec;
+	return ini_sec;
 }
 
 static void _bootloader_corruption_protect()
@@ -846,7 +874,7 @@ static void _auto_launch_firmware()
 			u32 configEntry = 0;
 			u32 boot_entry_id = 0;
 
-			// Load configuration.
+			// Load configuration. Autoboot selects entries by position, so sections are walked in order.
 			LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, &ini_sections, link)
 			{
 				// Skip other ini entries for autoboot.
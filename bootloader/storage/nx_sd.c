@@ -16,6 +16,7 @@
  */
 
 #include <storage/nx_sd.h>
+#include <storage/sd_stream.h>
 #include <storage/sdmmc.h>
 #include <storage/sdmmc_driver.h>
 #include <gfx_utils.h>
@@ -23,6 +24,7 @@
 #include <mem/heap.h>
 
 static bool sd_mounted = false;
+static bool sd_discard = false; // FatFs TRIM passthrough.
 static u16  sd_errors[3] = { 0 }; // Init and Read/Write errors.
 static u32  sd_mode = SD_UHS_SDR82;
 
@@ -64,6 +66,16 @@ u32 sd_get_mode()
 	return sd_mode;
 }
 
+void sd_set_discard(bool enable)
+{
+	sd_discard = enable;
+}
+
+bool sd_get_discard()
+{
+	return sd_discard;
+}
+
 int sd_init_retry(bool power_cycle)
 {
 	u32 bus_width = SDMMC_BUS_WIDTH_4;
@@ -180,27 +192,45 @@ static void _sd_deinit()
 void sd_unmount() { _sd_deinit(); }
 void sd_end()     { _sd_deinit(); }
 
+bool sd_handoff(sdmmc_handoff_t *ho)
+{
+	if (!sd_mounted)
+		return false;
+
+	f_mount(NULL, "", 1);
+	sd_mounted = false;
+
+	// Keep the card powered and initialized for the next stage.
+	if (sdmmc_storage_save_sd_handoff(&sd_storage, ho))
+		return true;
+
+	sdmmc_storage_end(&sd_storage);
+
+	return false;
+}
+
 void *sd_file_read(const char *path, u32 *fsize)
 {
-	FIL fp;
-	if (f_open(&fp, path, FA_READ) != FR_OK)
+	sd_stream_t st;
+	if (sd_stream_open(&st, path, 0) != FR_OK)
 		return NULL;
 
-	u32 size = f_size(&fp);
+	u32 size = f_size(&st.fp);
 	if (fsize)
 		*fsize = size;
 
 	void *buf = malloc(size);
 
-	if (f_read(&fp, buf, size, NULL) != FR_OK)
+	// Cluster chain is already resolved. Contiguous runs are read in one go.
+	if (sd_stream_read(&st, buf, size, NULL) != FR_OK)
 	{
 		free(buf);
-		f_close(&fp);
+		sd_stream_close(&st);
 
 		return NULL;
 	}
 
-	f_close(&fp);
+	sd_stream_close(&st);
 
 	return buf;
 }
@@ -65,6 +65,7 @@ void set_nyx_default_configuration()
 	n_cfg.ums_emmc_rw = 0;
 	n_cfg.jc_disable = 0;
 	n_cfg.new_powersave = 1;
+	n_cfg.sd_discard = 1;
 }
 
 int create_config_entry()
@@ -209,6 +210,9 @@ int create_nyx_config_entry()
 	f_puts("\nnewpowersave=", &fp);
 	itoa(n_cfg.new_powersave, lbuf, 10);
 	f_puts(lbuf, &fp);
+	f_puts("\nsddiscard=", &fp);
+	itoa(n_cfg.sd_discard, lbuf, 10);
+	f_puts(lbuf, &fp);
 	f_puts("\n", &fp);
 
 	f_close(&fp);
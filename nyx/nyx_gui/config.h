@@ -52,6 +52,7 @@ typedef struct _nyx_config
 	u32 ums_emmc_rw;
 	u32 jc_disable;
 	u32 new_powersave;
+	u32 sd_discard;
 } nyx_config;
 
 void set_default_configuration();
@@ -0,0 +1,233 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "fe_bench.h"
+#include <libs/fatfs/ff.h>
+#include <mem/heap.h>
+#include <storage/sdmmc.h>
+#include <utils/sprintf.h>
+#include <utils/util.h>
+
+static int _bench_sdmmc_read(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return sdmmc_storage_read((sdmmc_storage_t *)storage, sector, num_sectors, buf);
+}
+
+static int _bench_sdmmc_write(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return sdmmc_storage_write((sdmmc_storage_t *)storage, sector, num_sectors, buf);
+}
+
+void bench_dev_init_sdmmc(bench_dev_t *dev, sdmmc_storage_t *storage)
+{
+	dev->storage = storage;
+	dev->read    = _bench_sdmmc_read;
+	dev->write   = _bench_sdmmc_write;
+	dev->sec_cnt = storage->sec_cnt;
+}
+
+static int _bench_file_read(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	FIL *fp = (FIL *)storage;
+
+	if (f_lseek(fp, (u64)sector << 9))
+		return 0;
+
+	return !f_read_fast(fp, buf, num_sectors << 9);
+}
+
+static int _bench_file_write(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	FIL *fp = (FIL *)storage;
+	u32 csize = fp->obj.fs->csize;
+
+	// Fast write only handles whole clusters, more than one per call.
+	if ((sector % csize) || (num_sectors % csize) || num_sectors <= csize)
+		return 0;
+
+	if (f_lseek(fp, (u64)sector << 9))
+		return 0;
+
+	return !f_write_fast(fp, buf, num_sectors << 9);
+}
+
+int bench_dev_open_scratch(bench_dev_t *dev, FIL *fp, u32 size_scts)
+{
+	// Writes only ever land in clusters owned by this file. SD must be mounted.
+	if (f_open(fp, BENCH_SCRATCH_PATH, FA_CREATE_ALWAYS | FA_READ | FA_WRITE))
+		return 0;
+
+	if (!f_expand_cltbl(fp, 0x400000, (u64)size_scts << 9) || f_size(fp) != ((u64)size_scts << 9))
+	{
+		f_close(fp);
+		f_unlink(BENCH_SCRATCH_PATH);
+
+		return 0;
+	}
+
+	dev->storage = fp;
+	dev->read    = _bench_file_read;
+	dev->write   = _bench_file_write;
+	dev->sec_cnt = size_scts;
+
+	return 1;
+}
+
+void bench_dev_close_scratch(bench_dev_t *dev)
+{
+	FIL *fp = (FIL *)dev->storage;
+	DWORD *clmt = fp->cltbl;
+
+	f_close(fp);
+	free(clmt);
+	f_unlink(BENCH_SCRATCH_PATH);
+}
+
+static u32 _bench_rand(u32 *state)
+{
+	// Xorshift32. Fixed seed keeps offsets identical between runs.
+	u32 x = *state;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+static void _bench_sort(u32 *arr, u32 count)
+{
+	// Shell sort with Ciura gaps.
+	static const u32 gaps[] = { 701, 301, 132, 57, 23, 10, 4, 1 };
+
+	for (u32 g = 0; g < ARRAY_SIZE(gaps); g++)
+	{
+		u32 gap = gaps[g];
+		for (u32 i = gap; i < count; i++)
+		{
+			u32 val = arr[i];
+			u32 j = i;
+			for (; j >= gap && arr[j - gap] > val; j -= gap)
+				arr[j] = arr[j - gap];
+			arr[j] = val;
+		}
+	}
+}
+
+int bench_run(bench_dev_t *dev, const bench_profile_t *prof, u32 offset, u8 *buf, bench_progress_t progress, bench_result_t *res)
+{
+	bool rand_io = prof->type == BENCH_RAND_READ;
+	bool write_io = prof->type == BENCH_SEQ_WRITE;
+	u32 slots = prof->span_scts / prof->xfer_scts;
+	u32 ops = rand_io ? MIN(prof->ops, BENCH_MAX_RAND_OPS) : slots;
+
+	memset(res, 0, sizeof(bench_result_t));
+	res->name = prof->name;
+	res->type = prof->type;
+	res->offset = offset;
+	res->xfer_scts = prof->xfer_scts;
+
+	if (!ops || !slots || (offset + prof->span_scts) > dev->sec_cnt || (write_io && !dev->write))
+	{
+		res->error = 1;
+		return 0;
+	}
+
+	u32 *lat = (u32 *)malloc(ops * sizeof(u32));
+	u32 seed = BENCH_SEED;
+	u32 prev_pct = 200;
+
+	for (u32 op = 0; op < ops; op++)
+	{
+		u32 sector = offset;
+		if (rand_io)
+			sector += (_bench_rand(&seed) % slots) * prof->xfer_scts;
+		else
+			sector += op * prof->xfer_scts;
+
+		u32 timer = get_tmr_us();
+		int ok = write_io ? dev->write(dev->storage, sector, prof->xfer_scts, buf) :
+							dev->read(dev->storage, sector, prof->xfer_scts, buf);
+		lat[op] = get_tmr_us() - timer;
+
+		if (!ok)
+		{
+			res->error = 1;
+			break;
+		}
+
+		res->time_us += lat[op];
+		res->done_scts += prof->xfer_scts;
+		res->ops++;
+
+		u32 pct = ((op + 1) * 100) / ops;
+		if (progress && pct != prev_pct)
+		{
+			prev_pct = pct;
+			if (progress(pct))
+				break;
+		}
+	}
+
+	if (res->ops && res->time_us)
+	{
+		_bench_sort(lat, res->ops);
+
+		u32 last = res->ops - 1;
+		res->lat_min = lat[0];
+		res->lat_p50 = lat[(last * 50) / 100];
+		res->lat_p90 = lat[(last * 90) / 100];
+		res->lat_p99 = lat[(last * 99) / 100];
+		res->lat_max = lat[last];
+
+		res->rate_kb = ((u64)res->done_scts * 512 * 1000000 / 1024) / res->time_us;
+		res->iops = ((u64)res->ops * 1000000) / res->time_us;
+	}
+
+	free(lat);
+
+	return !res->error;
+}
+
+int bench_save_csv(const char *path, const bench_result_t *res, u32 count)
+{
+	FIL fp;
+	char *txt_buf = (char *)malloc(0x100 * (count + 1));
+
+	strcpy(txt_buf, "profile,offset,req_kb,data_kb,ops,time_us,rate_kbs,iops,"
+		"lat_min_us,lat_p50_us,lat_p90_us,lat_p99_us,lat_max_us,error\n");
+
+	for (u32 i = 0; i < count; i++)
+	{
+		s_printf(txt_buf + strlen(txt_buf), "%s,0x%08X,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d\n",
+			res[i].name, res[i].offset, res[i].xfer_scts / 2, res[i].done_scts / 2, res[i].ops,
+			res[i].time_us, res[i].rate_kb, res[i].iops, res[i].lat_min, res[i].lat_p50,
+			res[i].lat_p90, res[i].lat_p99, res[i].lat_max, res[i].error);
+	}
+
+	int error = f_open(&fp, path, FA_CREATE_ALWAYS | FA_WRITE);
+	if (!error)
+	{
+		error = f_write(&fp, txt_buf, strlen(txt_buf), NULL);
+		f_close(&fp);
+	}
+
+	free(txt_buf);
+
+	return error;
+}
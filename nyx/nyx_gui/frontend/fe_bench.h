@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FE_BENCH_H_
+#define _FE_BENCH_H_
+
+#include <libs/fatfs/ff.h>
+#include <storage/sdmmc.h>
+#include <utils/types.h>
+
+#define BENCH_SEED          0x48454B41 // "HEKA".
+#define BENCH_MAX_RAND_OPS  8192
+#define BENCH_SCRATCH_PATH  "bootloader/bench.tmp"
+
+typedef enum _bench_type_t
+{
+	BENCH_SEQ_READ  = 0,
+	BENCH_SEQ_WRITE = 1, // Destructive. Only run it on a scratch file device.
+	BENCH_RAND_READ = 2
+} bench_type_t;
+
+// Same signature as sdmmc_storage_read/write. Returns 1 on success.
+typedef int (*bench_rw_t)(void *storage, u32 sector, u32 num_sectors, void *buf);
+
+// Returns true to abort the run.
+typedef bool (*bench_progress_t)(u32 pct);
+
+typedef struct _bench_dev_t
+{
+	void *storage;
+	bench_rw_t read;
+	bench_rw_t write;
+	u32 sec_cnt;
+} bench_dev_t;
+
+typedef struct _bench_profile_t
+{
+	const char *name;
+	u32 type;
+	u32 xfer_scts; // Sectors per request.
+	u32 span_scts; // Data size for sequential. Area size for random.
+	u32 ops;       // Number of requests for random.
+} bench_profile_t;
+
+typedef struct _bench_result_t
+{
+	const char *name;
+	u32 type;
+	u32 offset;
+	u32 xfer_scts;
+	u32 done_scts;
+	u32 ops;
+	u32 time_us;
+	u32 rate_kb;   // KiB/s.
+	u32 iops;
+	u32 lat_min;   // Request latencies in us.
+	u32 lat_p50;
+	u32 lat_p90;
+	u32 lat_p99;
+	u32 lat_max;
+	int error;
+} bench_result_t;
+
+void bench_dev_init_sdmmc(bench_dev_t *dev, sdmmc_storage_t *storage);
+int  bench_dev_open_scratch(bench_dev_t *dev, FIL *fp, u32 size_scts);
+void bench_dev_close_scratch(bench_dev_t *dev);
+int  bench_run(bench_dev_t *dev, const bench_profile_t *prof, u32 offset, u8 *buf, bench_progress_t progress, bench_result_t *res);
+int  bench_save_csv(const char *path, const bench_result_t *res, u32 count);
+
+#endif
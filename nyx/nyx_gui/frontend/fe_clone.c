@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "fe_clone.h"
+#include <libs/fatfs/ff.h>
+#include <storage/sdmmc.h>
+#include <utils/util.h>
+
+#define SLOT_SIZE (CLONE_SLOT_SCTS * 512)
+
+static int _clone_sdmmc_read(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return sdmmc_storage_read((sdmmc_storage_t *)storage, sector, num_sectors, buf);
+}
+
+static int _clone_sdmmc_write(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return sdmmc_storage_write((sdmmc_storage_t *)storage, sector, num_sectors, buf);
+}
+
+static int _clone_sdmmc_write_start(void *storage, u32 sector, u32 num_sectors, void *buf)
+{
+	return sdmmc_storage_submit((sdmmc_storage_t *)storage, sector, num_sectors, buf, 1);
+}
+
+static int _clone_sdmmc_write_wait(void *storage)
+{
+	return sdmmc_storage_wait((sdmmc_storage_t *)storage);
+}
+
+static int _clone_sdmmc_discard(void *storage, u32 sector, u32 num_sectors)
+{
+	return sdmmc_storage_erase((sdmmc_storage_t *)storage, sector, num_sectors, SDMMC_ERASE_DISCARD);
+}
+
+void clone_dev_init_sdmmc(clone_dev_t *dev, sdmmc_storage_t *storage)
+{
+	dev->storage     = storage;
+	dev->read        = _clone_sdmmc_read;
+	dev->write       = _clone_sdmmc_write;
+	dev->write_start = _clone_sdmmc_write_start;
+	dev->write_wait  = _clone_sdmmc_write_wait;
+	dev->discard     = _clone_sdmmc_discard;
+	dev->sec_cnt     = storage->sec_cnt;
+	memcpy(dev->cid, storage->raw_cid, sizeof(dev->cid));
+}
+
+static void _clone_ckpt_fill(clone_job_t *job, clone_ckpt_t *ckpt, u32 done)
+{
+	ckpt->magic = CLONE_CKPT_MAGIC;
+	ckpt->version = CLONE_CKPT_VERSION;
+	memcpy(ckpt->src_cid, job->src->cid, sizeof(ckpt->src_cid));
+	ckpt->src_sec_cnt = job->src->sec_cnt;
+	memcpy(ckpt->dst_cid, job->dst->cid, sizeof(ckpt->dst_cid));
+	ckpt->dst_sec_cnt = job->dst->sec_cnt;
+	ckpt->src_start = job->src_start;
+	ckpt->dst_start = job->dst_start;
+	ckpt->sectors = job->sectors;
+	ckpt->done = done;
+	ckpt->crc32 = crc32_calc(0, (const u8 *)ckpt, sizeof(clone_ckpt_t) - sizeof(u32));
+}
+
+static u32 _clone_ckpt_load(clone_job_t *job)
+{
+	FIL fp;
+	clone_ckpt_t ckpt, ref;
+
+	if (f_open(&fp, job->ckpt_path, FA_READ))
+		return 0;
+
+	int res = f_read(&fp, &ckpt, sizeof(clone_ckpt_t), NULL);
+	f_close(&fp);
+	if (res)
+		return 0;
+
+	// Only resume the exact same job, on the same cards. Otherwise start over.
+	_clone_ckpt_fill(job, &ref, ckpt.done);
+	if (memcmp(&ckpt, &ref, sizeof(clone_ckpt_t)))
+		return 0;
+
+	if (ckpt.done >= job->sectors || (ckpt.done % CLONE_SLOT_SCTS))
+		return 0;
+
+	return ckpt.done;
+}
+
+static void _clone_ckpt_save(clone_job_t *job, u32 done)
+{
+	FIL fp;
+	clone_ckpt_t ckpt;
+
+	_clone_ckpt_fill(job, &ckpt, done);
+
+	if (f_open(&fp, job->ckpt_path, FA_CREATE_ALWAYS | FA_WRITE))
+		return;
+
+	f_write(&fp, &ckpt, sizeof(clone_ckpt_t), NULL);
+	f_close(&fp);
+}
+
+static bool _clone_io(clone_job_t *job, clone_rw_t op, void *storage, u32 err, u32 sector, u32 num, void *buf)
+{
+	u32 tries = 0;
+
+	while (!op(storage, sector, num, buf))
+	{
+		tries++;
+		if (job->retry)
+			job->retry(job->data, err, sector, num, tries);
+
+		if (tries >= CLONE_RETRIES)
+		{
+			job->err_sector = sector;
+			return false;
+		}
+
+		msleep(150);
+	}
+
+	return true;
+}
+
+static int _clone_finish_chunk(clone_job_t *job, u8 *buf, u32 off, u32 num)
+{
+	clone_dev_t *dst = job->dst;
+	u32 chunk = off / CLONE_SLOT_SCTS;
+
+	bool verify = job->verify == CLONE_VERIFY_FULL ||
+		(job->verify == CLONE_VERIFY_SAMPLED && !(chunk % job->verify_intv));
+
+	if (verify)
+	{
+		u8 *vbuf = job->buf + job->slots * SLOT_SIZE;
+
+		if (!_clone_io(job, dst->read, dst->storage, CLONE_ERR_VERIFY, job->dst_start + off, num, vbuf))
+			return CLONE_ERR_VERIFY;
+
+		if (memcmp(buf, vbuf, num * 512))
+		{
+			job->err_sector = job->dst_start + off;
+			return CLONE_ERR_VERIFY;
+		}
+	}
+
+	job->done = off + num;
+
+	if (job->ckpt_path && job->done < job->sectors && !(job->done % CLONE_CKPT_INTV_SCTS))
+		_clone_ckpt_save(job, job->done);
+
+	return CLONE_OK;
+}
+
+int clone_run(clone_job_t *job)
+{
+	clone_dev_t *src = job->src;
+	clone_dev_t *dst = job->dst;
+	bool async = dst->write_start && dst->write_wait && job->slots >= 2;
+
+	int res = CLONE_OK;
+	u32 off = job->ckpt_path ? _clone_ckpt_load(job) : 0;
+	u32 slot = 0;
+
+	// Write in flight.
+	u8 *pend_buf = NULL;
+	u32 pend_off = 0;
+	u32 pend_num = 0;
+
+	if (!job->verify_intv)
+		job->verify_intv = 4;
+
+	job->resumed_from = off;
+	job->done = off;
+	job->err_sector = 0;
+
+	// Everything after the resume point gets rewritten. Let the device drop it first.
+	if (job->discard && dst->discard && off < job->sectors)
+		dst->discard(dst->storage, job->dst_start + off, job->sectors - off);
+
+	while (off < job->sectors || pend_buf)
+	{
+		if (job->progress && job->progress(job->data, job->done, job->sectors))
+		{
+			res = CLONE_ERR_CANCEL;
+			break;
+		}
+
+		u32 num = 0;
+		u8 *buf = job->buf + slot * SLOT_SIZE;
+
+		// Read next chunk while the previous one is still being written.
+		if (off < job->sectors)
+		{
+			num = MIN(job->sectors - off, CLONE_SLOT_SCTS);
+			if (!_clone_io(job, src->read, src->storage, CLONE_ERR_READ, job->src_start + off, num, buf))
+			{
+				res = CLONE_ERR_READ;
+				break;
+			}
+		}
+
+		// Complete previous write. On failure redo it synchronously.
+		if (pend_buf)
+		{
+			u8 *done_buf = pend_buf;
+			pend_buf = NULL;
+
+			if (!dst->write_wait(dst->storage) &&
+				!_clone_io(job, dst->write, dst->storage, CLONE_ERR_WRITE, job->dst_start + pend_off, pend_num, done_buf))
+			{
+				res = CLONE_ERR_WRITE;
+				break;
+			}
+
+			res = _clone_finish_chunk(job, done_buf, pend_off, pend_num);
+			if (res)
+				break;
+		}
+
+		if (!num)
+			break;
+
+		if (async && dst->write_start(dst->storage, job->dst_start + off, num, buf))
+		{
+			pend_buf = buf;
+			pend_off = off;
+			pend_num = num;
+		}
+		else
+		{
+			if (!_clone_io(job, dst->write, dst->storage, CLONE_ERR_WRITE, job->dst_start + off, num, buf))
+			{
+				res = CLONE_ERR_WRITE;
+				break;
+			}
+
+			res = _clone_finish_chunk(job, buf, off, num);
+			if (res)
+				break;
+		}
+
+		off += num;
+		slot = (slot + 1) % job->slots;
+	}
+
+	// Never leave a transfer in flight.
+	if (pend_buf)
+	{
+		if (dst->write_wait(dst->storage))
+			_clone_finish_chunk(job, pend_buf, pend_off, pend_num);
+	}
+
+	if (job->ckpt_path)
+	{
+		if (!res)
+			f_unlink(job->ckpt_path);
+		else if (job->done)
+			_clone_ckpt_save(job, job->done - (job->done % CLONE_SLOT_SCTS));
+	}
+
+	return res;
+}
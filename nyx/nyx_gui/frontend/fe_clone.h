@@ -0,0 +1,106 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _FE_CLONE_H_
+#define _FE_CLONE_H_
+
+#include <storage/sdmmc.h>
+#include <utils/types.h>
+
+#define CLONE_SLOT_SCTS      8192    // 4MB per ring slot.
+#define CLONE_CKPT_INTV_SCTS 0x80000 // Save a checkpoint every 256MB.
+#define CLONE_RETRIES        3
+
+#define CLONE_CKPT_MAGIC   0x4B434C43 // "CLCK".
+#define CLONE_CKPT_VERSION 2
+
+typedef enum _clone_verify_t
+{
+	CLONE_VERIFY_NONE    = 0,
+	CLONE_VERIFY_SAMPLED = 1,
+	CLONE_VERIFY_FULL    = 2
+} clone_verify_t;
+
+typedef enum _clone_res_t
+{
+	CLONE_OK         = 0,
+	CLONE_ERR_READ   = 1,
+	CLONE_ERR_WRITE  = 2,
+	CLONE_ERR_VERIFY = 3,
+	CLONE_ERR_CANCEL = 4
+} clone_res_t;
+
+// Same signature as sdmmc_storage_read/write. Returns 1 on success.
+typedef int (*clone_rw_t)(void *storage, u32 sector, u32 num_sectors, void *buf);
+typedef int (*clone_wait_t)(void *storage);
+typedef int (*clone_discard_t)(void *storage, u32 sector, u32 num_sectors);
+
+typedef struct _clone_dev_t
+{
+	void *storage;
+	clone_rw_t read;
+	clone_rw_t write;
+	clone_rw_t write_start;  // Optional. Returns with the write DMA in flight.
+	clone_wait_t write_wait; // Optional. Finishes write_start. Returns 1 on success.
+	clone_discard_t discard; // Optional. Best effort.
+	u8  cid[0x10];           // Device identity. Part of the checkpoint key.
+	u32 sec_cnt;
+} clone_dev_t;
+
+typedef struct _clone_ckpt_t
+{
+	u32 magic;
+	u32 version;
+	u8  src_cid[0x10];
+	u32 src_sec_cnt;
+	u8  dst_cid[0x10];
+	u32 dst_sec_cnt;
+	u32 src_start;
+	u32 dst_start;
+	u32 sectors;
+	u32 done;
+	u32 crc32;
+} clone_ckpt_t;
+
+typedef struct _clone_job_t
+{
+	clone_dev_t *src;
+	clone_dev_t *dst;
+	u32 src_start;
+	u32 dst_start;
+	u32 sectors;
+
+	u8 *buf;              // (slots + 1) * CLONE_SLOT_SCTS sectors. Last slot is for verification.
+	u32 slots;            // Ring slots. At least 2 for overlap.
+	u32 verify;
+	u32 verify_intv;      // Chunks per verified chunk, when sampled.
+	bool discard;         // Discard the destination range left to copy.
+
+	const char *ckpt_path; // Optional. Enables resume on the same source and destination.
+
+	void *data;
+	bool (*progress)(void *data, u32 done, u32 total); // Returns true to cancel.
+	void (*retry)(void *data, u32 err, u32 sector, u32 num, u32 tries);
+
+	u32 done;
+	u32 resumed_from;
+	u32 err_sector;
+} clone_job_t;
+
+void clone_dev_init_sdmmc(clone_dev_t *dev, sdmmc_storage_t *storage);
+int  clone_run(clone_job_t *job);
+
+#endif
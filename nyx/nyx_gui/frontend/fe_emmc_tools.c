@@ -1278,6 +1278,18 @@ static int _restore_emmc_part(emmc_tool_gui_t *gui, char *sd_path, int active_pa
 	f_close(&fp);
 	free(clmt);
 
+	// Write back the eMMC cache, so verification checks what was stored.
+	if (!sdmmc_storage_flush(storage))
+	{
+		s_printf(gui->txt_buf, "\n#FF0000 Failed to flush eMMC cache!#\n"
+			"#FF0000 Your device may be in an inoperative state!#\n"
+			"#FFDD00 Please try again now!#\n");
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		return 0;
+	}
+
 	if (n_cfg.verification && !gui->raw_emummc)
 	{
 		// Verify restored data.
@@ -1379,6 +1391,9 @@ void restore_emmc_selected(emmcPartType_t restoreType, emmc_tool_gui_t *gui)
 		goto out;
 	}
 
+	// Cache writes if supported. Flushed after each partition and on storage end.
+	sdmmc_storage_set_mmc_cache(&storage, true);
+
 	int i = 0;
 	char sdPath[OUT_FILENAME_SZ];
 
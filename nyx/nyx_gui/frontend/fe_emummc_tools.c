@@ -23,6 +23,7 @@
 
 #include "gui.h"
 #include "fe_emummc_tools.h"
+#include "fe_clone.h"
 #include "../config.h"
 #include <utils/ini.h>
 #include <libs/fatfs/ff.h>
@@ -40,6 +41,7 @@
 #define OUT_FILENAME_SZ 128
 
 extern hekate_config h_cfg;
+extern nyx_config n_cfg;
 
 void load_emummc_cfg(emummc_cfg_t *emu_info)
 {
@@ -494,6 +496,74 @@ out:
 	sd_unmount();
 }
 
+typedef struct _emummc_clone_ctxt_t
+{
+	emmc_tool_gui_t *gui;
+	u32 prev_pct;
+} emummc_clone_ctxt_t;
+
+static bool _emummc_clone_progress(void *data, u32 done, u32 total)
+{
+	emummc_clone_ctxt_t *ctxt = (emummc_clone_ctxt_t *)data;
+	emmc_tool_gui_t *gui = ctxt->gui;
+
+	// Check for cancellation combo.
+	if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
+		return true;
+
+	u32 pct = (u64)((u64)done * 100u) / (u64)total;
+	if (pct != ctxt->prev_pct)
+	{
+		lv_bar_set_value(gui->bar, pct);
+		s_printf(gui->txt_buf, " "SYMBOL_DOT" %d%%", pct);
+		lv_label_set_text(gui->label_pct, gui->txt_buf);
+		manual_system_maintenance(true);
+
+		ctxt->prev_pct = pct;
+	}
+	else
+		manual_system_maintenance(false);
+
+	return false;
+}
+
+static void _emummc_clone_retry(void *data, u32 err, u32 sector, u32 num, u32 tries)
+{
+	emummc_clone_ctxt_t *ctxt = (emummc_clone_ctxt_t *)data;
+	emmc_tool_gui_t *gui = ctxt->gui;
+
+	switch (err)
+	{
+	case CLONE_ERR_READ:
+		s_printf(gui->txt_buf,
+			"\n#FFDD00 Error reading %d blocks @LBA %08X,#\n"
+			"#FFDD00 from eMMC (try %d). #",
+			num, sector, tries);
+		break;
+	case CLONE_ERR_WRITE:
+		s_printf(gui->txt_buf,
+			"\n#FFDD00 Error writing %d blocks @LBA %08X,#\n"
+			"#FFDD00 to SD (try %d). #",
+			num, sector, tries);
+		break;
+	case CLONE_ERR_VERIFY:
+		s_printf(gui->txt_buf,
+			"\n#FFDD00 Error reading %d blocks @LBA %08X,#\n"
+			"#FFDD00 from SD for verification (try %d). #",
+			num, sector, tries);
+		break;
+	}
+	lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+	manual_system_maintenance(true);
+
+	if (tries < CLONE_RETRIES)
+	{
+		s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+	}
+}
+
 static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part_idx, u32 sd_part_off, sdmmc_storage_t *storage, emmc_part_t *part)
 {
 	u32 totalSectors = part->lba_end - part->lba_start + 1;
@@ -511,109 +581,73 @@ static int _dump_emummc_raw_part(emmc_tool_gui_t *gui, int active_part, int part
 	lv_label_ins_text(gui->label_info, LV_LABEL_POS_LAST, gui->txt_buf);
 	manual_system_maintenance(true);
 
-	u8 *buf = (u8 *)MIXD_BUF_ALIGNED;
-	u32 sd_sector_off = sd_part_off + (0x2000 * active_part);
-	u32 lba_curr = part->lba_start;
-	u32 prevPct = 200;
-	int retryCount = 0;
-
-	u32 num = 0;
-	u32 pct = 0;
-
 	lv_obj_set_opa_scale(gui->bar, LV_OPA_COVER);
 	lv_obj_set_opa_scale(gui->label_pct, LV_OPA_COVER);
 
-	while (totalSectors > 0)
+	char ckpt_path[OUT_FILENAME_SZ];
+	s_printf(ckpt_path, "%sclone_%d.ckpt", gui->base_path, active_part);
+
+	clone_dev_t src, dst;
+	clone_dev_init_sdmmc(&src, storage);
+	clone_dev_init_sdmmc(&dst, &sd_storage);
+
+	emummc_clone_ctxt_t ctxt;
+	ctxt.gui = gui;
+	ctxt.prev_pct = 200;
+
+	// 3 ring slots and 1 verification slot fill the 16MB DMA buffer.
+	clone_job_t job;
+	memset(&job, 0, sizeof(clone_job_t));
+	job.src = &src;
+	job.dst = &dst;
+	job.src_start = part->lba_start;
+	job.dst_start = sd_part_off + (0x2000 * active_part) + part->lba_start;
+	job.sectors = totalSectors;
+	job.buf = (u8 *)MIXD_BUF_ALIGNED;
+	job.slots = 3;
+	job.verify = n_cfg.verification >= 2 ? CLONE_VERIFY_FULL : n_cfg.verification;
+	job.verify_intv = 4;
+	job.discard = n_cfg.sd_discard;
+	job.ckpt_path = ckpt_path;
+	job.data = &ctxt;
+	job.progress = _emummc_clone_progress;
+	job.retry = _emummc_clone_retry;
+
+	int res = clone_run(&job);
+
+	if (job.resumed_from)
 	{
-		// Check for cancellation combo.
-		if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
-		{
-			s_printf(gui->txt_buf, "#FFDD00 The emuMMC was cancelled!#\n");
-			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-			manual_system_maintenance(true);
-
-			msleep(1000);
-
-			return 0;
-		}
-
-		retryCount = 0;
-		num = MIN(totalSectors, NUM_SECTORS_PER_ITER);
-
-		// Read data from eMMC.
-		while (!sdmmc_storage_read(storage, lba_curr, num, buf))
-		{
-			s_printf(gui->txt_buf,
-				"\n#FFDD00 Error reading %d blocks @LBA %08X,#\n"
-				"#FFDD00 from eMMC (try %d). #",
-				num, lba_curr, ++retryCount);
-			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-			manual_system_maintenance(true);
-
-			msleep(150);
-			if (retryCount >= 3)
-			{
-				s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
-
-				return 0;
-			}
-			else
-			{
-				s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
-			}
-		}
-
-		manual_system_maintenance(false);
-
-		retryCount = 0;
-
-		// Write data to SD card.
-		while (!sdmmc_storage_write(&sd_storage, sd_sector_off + lba_curr, num, buf))
-		{
-			s_printf(gui->txt_buf,
-				"\n#FFDD00 Error writing %d blocks @LBA %08X,#\n"
-				"#FFDD00 to SD (try %d). #",
-				num, lba_curr, ++retryCount);
-			lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-			manual_system_maintenance(true);
-
-			msleep(150);
-			if (retryCount >= 3)
-			{
-				s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
+		s_printf(gui->txt_buf, "#96FF00 Resumed at:# #FF8000 0x%08X# ", part->lba_start + job.resumed_from);
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
+	}
 
-				return 0;
-			}
-			else
-			{
-				s_printf(gui->txt_buf, "#FFDD00 Retrying...#\n");
-				lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
-				manual_system_maintenance(true);
-			}
-		}
+	switch (res)
+	{
+	case CLONE_OK:
+		break;
+	case CLONE_ERR_CANCEL:
+		s_printf(gui->txt_buf, "#FFDD00 The emuMMC was cancelled!#\n");
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
 
-		manual_system_maintenance(false);
+		msleep(1000);
 
-		pct = (u64)((u64)(lba_curr - part->lba_start) * 100u) / (u64)(part->lba_end - part->lba_start);
-		if (pct != prevPct)
-		{
-			lv_bar_set_value(gui->bar, pct);
-			s_printf(gui->txt_buf, " "SYMBOL_DOT" %d%%", pct);
-			lv_label_set_text(gui->label_pct, gui->txt_buf);
-			manual_system_maintenance(true);
+		return 0;
+	case CLONE_ERR_VERIFY:
+		s_printf(gui->txt_buf, "\n#FF0000 Verification failed @LBA %08X!#\nPlease try again...\n", job.err_sector);
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
 
-			prevPct = pct;
-		}
+		return 0;
+	default:
+		s_printf(gui->txt_buf, "#FF0000 Aborting...#\nPlease try again...\n");
+		lv_label_ins_text(gui->label_log, LV_LABEL_POS_LAST, gui->txt_buf);
+		manual_system_maintenance(true);
 
-		lba_curr += num;
-		totalSectors -= num;
+		return 0;
 	}
+
 	lv_bar_set_value(gui->bar, 100);
 	lv_label_set_text(gui->label_pct, " "SYMBOL_DOT" 100%");
 	manual_system_maintenance(true);
@@ -1190,6 +1190,10 @@ static void _create_tab_about(lv_theme_t * th, lv_obj_t * parent)
 		"#00CCFF               `      '-;         (-'#"
 	);
 
+	// Make sure logos are unpacked.
+	nyx_res_load(hekate_logo.data, hekate_logo.data_size);
+	nyx_res_load(ctcaer_logo.data, ctcaer_logo.data_size);
+
 	lv_obj_t *hekate_img = lv_img_create(parent, NULL);
 	lv_img_set_src(hekate_img, &hekate_logo);
 	lv_obj_align(hekate_img, lbl_octopus, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI * 2 / 3);
@@ -1598,6 +1602,14 @@ static lv_res_t _create_window_home_launch(lv_obj_t *btn)
 		bool icon_sw_custom = !f_stat("bootloader/res/icon_switch_custom.bmp", NULL);
 		bool icon_pl_custom = !f_stat("bootloader/res/icon_payload_custom.bmp", NULL);
 
+		// Load system icons on first use.
+		if (!icon_switch)
+			icon_switch = bmp_to_lvimg_obj(icon_sw_custom ?
+				"bootloader/res/icon_switch_custom.bmp" : "bootloader/res/icon_switch.bmp");
+		if (!icon_payload)
+			icon_payload = bmp_to_lvimg_obj(icon_pl_custom ?
+				"bootloader/res/icon_payload_custom.bmp" : "bootloader/res/icon_payload.bmp");
+
 		// Choose what to parse.
 		bool ini_parse_success = false;
 		if (!more_cfg)
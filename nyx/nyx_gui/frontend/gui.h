@@ -67,5 +67,6 @@ void nyx_create_onoff_button(lv_theme_t *th, lv_obj_t *parent, lv_obj_t *btn, co
 lv_res_t nyx_generic_onoff_toggle(lv_obj_t *btn);
 void manual_system_maintenance(bool refresh);
 void nyx_load_and_run();
+void nyx_res_load(const void *addr, u32 size);
 
 #endif
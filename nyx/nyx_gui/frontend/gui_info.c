@@ -17,6 +17,7 @@
  */
 
 #include "gui.h"
+#include "fe_bench.h"
 #include <gfx/di.h>
 #include "../config.h"
 #include "../hos/hos.h"
@@ -41,6 +42,7 @@
 #include "../storage/nx_emmc_bis.h"
 #include <storage/nx_sd.h>
 #include <storage/sdmmc.h>
+#include <storage/sdmmc_telemetry.h>
 #include <utils/btn.h>
 #include <utils/sprintf.h>
 #include <utils/util.h>
@@ -54,6 +56,7 @@ extern volatile nyx_storage_t *nyx_str;
 extern void emmcsn_path_impl(char *path, char *sub_dir, char *filename, sdmmc_storage_t *storage);
 
 static u8 *cal0_buf = NULL;
+static bool telem_sd = false;
 
 static lv_res_t _create_window_dump_done(int error, char *dump_filenames)
 {
@@ -1098,6 +1101,46 @@ out:
 	return LV_RES_OK;
 }
 
+static lv_obj_t *bench_bar;
+static bool bench_aborted;
+
+static bool _bench_progress(u32 pct)
+{
+	lv_bar_set_value(bench_bar, pct);
+	manual_system_maintenance(true);
+
+	if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
+		bench_aborted = true;
+
+	return bench_aborted;
+}
+
+static void _bench_print_result(char *txt_buf, const bench_result_t *res)
+{
+	if (res->error)
+	{
+		s_printf(txt_buf + strlen(txt_buf), "\n#C7EA46 %s#: #FFDD00 Failed!#", res->name);
+		return;
+	}
+
+	u32 rate_mb = res->rate_kb / 1024;
+	u32 rate_mb_dec = ((res->rate_kb % 1024) * 100) / 1024;
+
+	if (res->type == BENCH_RAND_READ)
+	{
+		s_printf(txt_buf + strlen(txt_buf),
+			"\n#C7EA46 %s#: Rate: #C7EA46 %d.%02d MB/s#, IOPS: #C7EA46 %d#, Lat: #C7EA46 %d/%d/%d us#",
+			res->name, rate_mb, rate_mb_dec, res->iops, res->lat_p50, res->lat_p90, res->lat_p99);
+	}
+	else
+	{
+		u32 timer = res->time_us / 1000;
+		s_printf(txt_buf + strlen(txt_buf),
+			"\n#C7EA46 %s#: Offset: #C7EA46 %08X#, Time: #C7EA46 %d.%02ds#, Rate: #C7EA46 %d.%02d MB/s#",
+			res->name, res->offset, timer / 1000, (timer % 1000) / 10, rate_mb, rate_mb_dec);
+	}
+}
+
 static lv_res_t _create_mbox_benchmark(bool sd_bench)
 {
 	sdmmc_t emmc_sdmmc;
@@ -1115,15 +1158,15 @@ static lv_res_t _create_mbox_benchmark(bool sd_bench)
 
 	char *txt_buf = (char *)malloc(0x1000);
 
-	s_printf(txt_buf, "#FF8000 %s Benchmark#\n[3 x %s raw reads] Abort: VOL- & VOL+\n",
-		sd_bench ? "SD Card" : "eMMC", sd_bench ? "2GB" : "8GB");
+	s_printf(txt_buf, "#FF8000 %s Benchmark#\n[%s seq reads, %s4K/32K random reads] Abort: VOL- & VOL+\n",
+		sd_bench ? "SD Card" : "eMMC", sd_bench ? "2GB" : "8GB", sd_bench ? "512MB scratch file writes, " : "");
 
 	lv_mbox_set_text(mbox, txt_buf);
 
-	lv_obj_t * bar = lv_bar_create(mbox, NULL);
-	lv_obj_set_size(bar, LV_DPI * 2, LV_DPI / 5);
-	lv_bar_set_range(bar, 0, 100);
-	lv_bar_set_value(bar, 0);
+	bench_bar = lv_bar_create(mbox, NULL);
+	lv_obj_set_size(bench_bar, LV_DPI * 2, LV_DPI / 5);
+	lv_bar_set_range(bench_bar, 0, 100);
+	lv_bar_set_value(bench_bar, 0);
 
 	lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
 	lv_obj_set_top(mbox, true);
@@ -1148,6 +1191,10 @@ static lv_res_t _create_mbox_benchmark(bool sd_bench)
 		lv_mbox_set_text(mbox, "#FFDD00 Failed to init Storage!#");
 	else
 	{
+		bench_dev_t dev;
+		bench_result_t results[6];
+		u32 results_cnt = 0;
+
 		u32 iters = 3;
 		u32 sector_num = 0x8000;
 		u32 data_scts = sd_bench ? 0x400000 : 0x1000000; // SD 2GB or eMMC 8GB.
@@ -1155,62 +1202,85 @@ static lv_res_t _create_mbox_benchmark(bool sd_bench)
 		if (storage->sec_cnt < 0xC00000)
 			iters -= 2; // 4GB card.
 
-		for (u32 iter_curr = 0; iter_curr < iters; iter_curr++)
-		{
-			u32 pct = 0;
-			u32 prevPct = 200;
-			u32 lba_curr = 0;
-			u32 sector = offset_chunk_start * iter_curr;
-			u32 data_remaining = data_scts;
+		// Writes never touch raw storage. They only go to a scratch file on SD, which is deleted after.
+		const bench_profile_t profiles[] = {
+			{ "Seq Read",   BENCH_SEQ_READ,  sector_num, data_scts,        0 },    // 16MB requests.
+			{ "Rand 4K",    BENCH_RAND_READ, 8,          data_scts,        4096 },
+			{ "Rand 32K",   BENCH_RAND_READ, 64,         data_scts,        2048 },
+			{ "Seq Write",  BENCH_SEQ_WRITE, sector_num, data_scts / 4,    0 }     // 16MB requests. SD only.
+		};
+		u32 prof_cnt = ARRAY_SIZE(profiles) - (sd_bench ? 0 : 1);
 
-			u32 timer = get_tmr_ms();
+		bench_dev_init_sdmmc(&dev, storage);
+		bench_aborted = false;
 
-			strcat(txt_buf, "\n");
-			lv_mbox_set_text(mbox, txt_buf);
+		strcat(txt_buf, "\n");
 
-			while (data_remaining)
-			{
-				// Read 16MB chunks.
-				sdmmc_storage_read(storage, sector + lba_curr, sector_num, (u8 *)MIXD_BUF_ALIGNED);
-				manual_system_maintenance(false);
-				data_remaining -= sector_num;
-				lba_curr += sector_num;
-
-				pct = (lba_curr * 100) / data_scts;
-				if (pct != prevPct)
-				{
-					lv_bar_set_value(bar, pct);
-					manual_system_maintenance(true);
+		for (u32 iter_curr = 0; iter_curr < iters + prof_cnt - 1; iter_curr++)
+		{
+			// Sequential reads run at multiple offsets. The rest run on the middle one.
+			u32 prof_idx = iter_curr < iters ? 0 : iter_curr - iters + 1;
+			u32 sector = offset_chunk_start * (iter_curr < iters ? iter_curr : (iters > 1 ? 1 : 0));
+			bool scratch = profiles[prof_idx].type == BENCH_SEQ_WRITE;
 
-					prevPct = pct;
+			lv_bar_set_value(bench_bar, 0);
+			manual_system_maintenance(true);
 
-					if (btn_read_vol() == (BTN_VOL_UP | BTN_VOL_DOWN))
-						break;
+			if (!scratch)
+				bench_run(&dev, &profiles[prof_idx], sector, (u8 *)MIXD_BUF_ALIGNED, _bench_progress, &results[results_cnt]);
+			else
+			{
+				FIL fp;
+				bench_dev_t scratch_dev;
+
+				if (bench_dev_open_scratch(&scratch_dev, &fp, profiles[prof_idx].span_scts))
+				{
+					bench_run(&scratch_dev, &profiles[prof_idx], 0, (u8 *)MIXD_BUF_ALIGNED, _bench_progress, &results[results_cnt]);
+					bench_dev_close_scratch(&scratch_dev);
+				}
+				else
+				{
+					memset(&results[results_cnt], 0, sizeof(bench_result_t));
+					results[results_cnt].name = profiles[prof_idx].name;
+					results[results_cnt].type = profiles[prof_idx].type;
+					results[results_cnt].error = 1;
 				}
 			}
-			timer = get_tmr_ms() - timer;
-			timer -= sd_bench ? 175 : 185; // Compensate 175ms/185ms for maintenance/drawing/calc ops.
-
-			lv_bar_set_value(bar, 100);
-			u32 rate_1k = (sd_bench ? (2048 * 1000 * 1000) : (u64)((u64)8192 * 1000 * 1000)) / timer;
-			s_printf(txt_buf + strlen(txt_buf),
-				"#C7EA46 %d#: Offset: #C7EA46 %08X#, Time: #C7EA46 %d.%02ds#, Rate: #C7EA46 %d.%02d MB/s#",
-				iter_curr, sector, timer / 1000, (timer % 1000) / 10, rate_1k / 1000, (rate_1k % 1000) / 10);
+
+			lv_bar_set_value(bench_bar, 100);
+			_bench_print_result(txt_buf, &results[results_cnt]);
+			results_cnt++;
+
 			lv_mbox_set_text(mbox, txt_buf);
 			lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
 			manual_system_maintenance(true);
+
+			if (bench_aborted)
+				break;
 		}
 
-		lv_obj_del(bar);
+		lv_obj_del(bench_bar);
 
-		if (sd_bench)
-			sd_unmount();
-		else
+		// Save results to SD.
+		if (sd_bench || sd_mount())
+		{
+			char path[128];
+			emmcsn_path_impl(path, "/dumps", sd_bench ? "bench_sd.csv" : "bench_emmc.csv", sd_bench ? NULL : &emmc_storage);
+			if (!bench_save_csv(path, results, results_cnt))
+				s_printf(txt_buf + strlen(txt_buf), "\n\nResults saved to %s", path);
+			lv_mbox_set_text(mbox, txt_buf);
+			lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+		}
+
+		sd_unmount();
+		if (!sd_bench)
 			sdmmc_storage_end(&emmc_storage);
 	}
 
 	lv_mbox_add_btns(mbox, mbox_btn_map, mbox_action); // Important. After set_text.
 
+	free(txt_buf);
+
 	return LV_RES_OK;
 }
 
@@ -1228,10 +1298,122 @@ static lv_res_t _create_mbox_sd_bench(lv_obj_t * btn)
 	return LV_RES_OK;
 }
 
+static lv_res_t _telem_dump_window_action(lv_obj_t *btns, const char * txt)
+{
+	int btn_idx = lv_btnm_get_pressed(btns);
+
+	mbox_action(btns, txt);
+
+	if (btn_idx == 1)
+	{
+		char *filename = telem_sd ? "storage_sd.csv" : "storage_emmc.csv";
+
+		// Snapshot it first, so mounting does not show up in the export.
+		char *csv_buf = (char *)malloc(SDMMC_TELEM_CSV_MAX);
+		u32 csv_size = sdmmc_telem_csv(sdmmc_telem_get(telem_sd ? SDMMC_1 : SDMMC_4), csv_buf);
+
+		int error = !sd_mount();
+
+		if (!error)
+		{
+			char path[64];
+			emmcsn_path_impl(path, "/dumps", filename, NULL);
+			error = sd_save_to_file(csv_buf, csv_size, path);
+
+			sd_unmount();
+		}
+
+		free(csv_buf);
+
+		_create_window_dump_done(error, filename);
+	}
+
+	return LV_RES_INV;
+}
+
+static lv_res_t _create_mbox_storage_telem(bool sd)
+{
+	static const char *op_names[SDMMC_TELEM_OP_MAX] = { "Read ", "Write", "Erase", "Flush" };
+
+	lv_obj_t *dark_bg = lv_obj_create(lv_scr_act(), NULL);
+	lv_obj_set_style(dark_bg, &mbox_darken);
+	lv_obj_set_size(dark_bg, LV_HOR_RES, LV_VER_RES);
+
+	static const char * mbox_btn_map[] = { "\211", "\222Save CSV", "\222Close", "\211", "" };
+	lv_obj_t * mbox = lv_mbox_create(dark_bg, NULL);
+	lv_mbox_set_recolor_text(mbox, true);
+	lv_obj_set_width(mbox, LV_HOR_RES / 9 * 6);
+
+	lv_mbox_set_text(mbox, sd ? "#C7EA46 SD Card Telemetry#" : "#C7EA46 eMMC Telemetry#");
+
+	lv_obj_t * lb_desc = lv_label_create(mbox, NULL);
+	lv_label_set_long_mode(lb_desc, LV_LABEL_LONG_BREAK);
+	lv_label_set_recolor(lb_desc, true);
+	lv_label_set_style(lb_desc, &monospace_text);
+	lv_obj_set_width(lb_desc, LV_HOR_RES / 9 * 5);
+
+	telem_sd = sd;
+	const sdmmc_telem_t *t = sdmmc_telem_get(sd ? SDMMC_1 : SDMMC_4);
+	char *txt_buf = (char *)malloc(0x1000);
+
+	strcpy(txt_buf, "#00DDFF Op         Ops   Avg KiB    p50 us    p99 us    Max us#\n");
+	for (u32 op = 0; op < SDMMC_TELEM_OP_MAX; op++)
+	{
+		s_printf(txt_buf + strlen(txt_buf), "%s %9d %9d %9d %9d %9d\n", op_names[op], t->ops[op],
+			t->ops[op] ? t->sectors[op] / t->ops[op] / 2 : 0,
+			sdmmc_telem_percentile(t, op, SDMMC_TELEM_SZ_MAX, 50),
+			sdmmc_telem_percentile(t, op, SDMMC_TELEM_SZ_MAX, 99), t->lat_max[op]);
+	}
+
+	s_printf(txt_buf + strlen(txt_buf),
+		"\n#00DDFF Retries:# %d  #00DDFF Reinits:# %d  #00DDFF Fails:# %d\n"
+		"#00DDFF DMA timeouts:# %d  #00DDFF DMA errors:# %d  #00DDFF Busy timeouts:# %d\n",
+		t->counters[SDMMC_TELEM_CNT_RETRY], t->counters[SDMMC_TELEM_CNT_REINIT], t->counters[SDMMC_TELEM_CNT_FAIL],
+		t->counters[SDMMC_TELEM_CNT_DMA_TIMEOUT], t->counters[SDMMC_TELEM_CNT_DMA_ERROR],
+		t->counters[SDMMC_TELEM_CNT_BUSY_TIMEOUT]);
+
+	sdmmc_telem_slow_t slow[5];
+	u32 slow_cnt = sdmmc_telem_slowest(t, slow, ARRAY_SIZE(slow));
+	if (slow_cnt)
+	{
+		strcat(txt_buf, "\n#FF8000 Slowest requests:#\n");
+		for (u32 i = 0; i < slow_cnt; i++)
+		{
+			s_printf(txt_buf + strlen(txt_buf), "%s %08X %9d KiB %9d us%s\n", op_names[slow[i].op],
+				slow[i].sector, slow[i].num_sectors / 2, slow[i].lat_us, slow[i].ok ? "" : " #FFDD00 (failed)#");
+		}
+	}
+
+	lv_label_set_text(lb_desc, txt_buf);
+	free(txt_buf);
+
+	lv_mbox_add_btns(mbox, mbox_btn_map, _telem_dump_window_action);
+
+	lv_obj_align(mbox, NULL, LV_ALIGN_CENTER, 0, 0);
+	lv_obj_set_top(mbox, true);
+
+	return LV_RES_OK;
+}
+
+static lv_res_t _create_mbox_emmc_telem(lv_obj_t * btn)
+{
+	_create_mbox_storage_telem(false);
+
+	return LV_RES_OK;
+}
+
+static lv_res_t _create_mbox_sd_telem(lv_obj_t * btn)
+{
+	_create_mbox_storage_telem(true);
+
+	return LV_RES_OK;
+}
+
 static lv_res_t _create_window_emmc_info_status(lv_obj_t *btn)
 {
 	lv_obj_t *win = nyx_create_standard_window(SYMBOL_CHIP" Internal eMMC Info");
 	lv_win_add_btn(win, NULL, SYMBOL_CHIP" Benchmark", _create_mbox_emmc_bench);
+	lv_win_add_btn(win, NULL, SYMBOL_LIST" Telemetry", _create_mbox_emmc_telem);
 
 	lv_obj_t *desc = lv_cont_create(win, NULL);
 	lv_obj_set_size(desc, LV_HOR_RES / 2 / 6 * 2, LV_VER_RES - (LV_DPI * 11 / 7) - 5);
@@ -1440,6 +1622,7 @@ static lv_res_t _create_window_sdcard_info_status(lv_obj_t *btn)
 {
 	lv_obj_t *win = nyx_create_standard_window(SYMBOL_SD" microSD Card Info");
 	lv_win_add_btn(win, NULL, SYMBOL_SD" Benchmark", _create_mbox_sd_bench);
+	lv_win_add_btn(win, NULL, SYMBOL_LIST" Telemetry", _create_mbox_sd_telem);
 
 	lv_obj_t *desc = lv_cont_create(win, NULL);
 	lv_obj_set_size(desc, LV_HOR_RES / 2 / 5 * 2, LV_VER_RES - (LV_DPI * 11 / 8) * 5 / 2);
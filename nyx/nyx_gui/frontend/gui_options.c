@@ -77,6 +77,21 @@ static lv_res_t auto_nogc_toggle(lv_obj_t *btn)
 	return LV_RES_OK;
 }
 
+static lv_res_t _sd_discard_toggle(lv_obj_t *btn)
+{
+	n_cfg.sd_discard = !n_cfg.sd_discard;
+	sd_set_discard(n_cfg.sd_discard);
+
+	if (!n_cfg.sd_discard)
+		lv_btn_set_state(btn, LV_BTN_STATE_REL);
+	else
+		lv_btn_set_state(btn, LV_BTN_STATE_TGL_REL);
+
+	nyx_generic_onoff_toggle(btn);
+
+	return LV_RES_OK;
+}
+
 static lv_res_t _update_r2p_action(lv_obj_t *btn)
 {
 	h_cfg.updater2p = !h_cfg.updater2p;
@@ -981,6 +996,26 @@ lv_res_t create_win_nyx_options(lv_obj_t *parrent_btn)
 	lv_obj_set_style(label_txt2, &hint_small_style);
 	lv_obj_align(label_txt2, btn2, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 4);
 
+	line_sep = lv_line_create(sw_h2, line_sep);
+	lv_obj_align(line_sep, label_txt2, LV_ALIGN_OUT_BOTTOM_LEFT, -(LV_DPI / 4), LV_DPI / 4);
+
+	// Create SD Discard button.
+	lv_obj_t *btn_discard = lv_btn_create(sw_h2, NULL);
+	nyx_create_onoff_button(th, sw_h2, btn_discard, SYMBOL_SD" SD Discard", _sd_discard_toggle, true);
+	lv_obj_align(btn_discard, line_sep, LV_ALIGN_OUT_BOTTOM_LEFT, 0, LV_DPI / 10);
+
+	label_txt2 = lv_label_create(sw_h2, NULL);
+	lv_label_set_recolor(label_txt2, true);
+	lv_label_set_static_text(label_txt2,
+		"Discard freed SD clusters and unused space on format.\n"
+		"#FF8000 Some counterfeit cards corrupt data on discard.#");
+	lv_obj_set_style(label_txt2, &hint_small_style);
+	lv_obj_align(label_txt2, btn_discard, LV_ALIGN_OUT_BOTTOM_LEFT, LV_DPI / 4, LV_DPI / 12);
+
+	if (n_cfg.sd_discard)
+		lv_btn_set_state(btn_discard, LV_BTN_STATE_TGL_REL);
+	nyx_generic_onoff_toggle(btn_discard);
+
 	label_sep = lv_label_create(sw_h3, NULL);
 	lv_label_set_static_text(label_sep, "");
 
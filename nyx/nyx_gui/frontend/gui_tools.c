@@ -812,69 +812,129 @@ static lv_res_t _create_window_usb_tools(lv_obj_t *parent)
 	return LV_RES_OK;
 }
 
+#define FIX_ATTR_MAX_DEPTH  64
+#define FIX_ATTR_UI_INTV_MS 100
+
+typedef struct _fix_attr_dir_t
+{
+	DIR dir;
+	u32 path_len;
+	u8  attrib;
+	bool is_hos_special;
+} fix_attr_dir_t;
+
+static void _fix_attributes_dir(char *path, fix_attr_dir_t *node, u32 *total)
+{
+	// Set archive bit to HOS single file folders.
+	if (node->is_hos_special)
+	{
+		if (!(node->attrib & AM_ARC))
+		{
+			total[0]++;
+			f_chmod_fast(path, AM_ARC, AM_ARC);
+		}
+	}
+	else if (node->attrib & AM_ARC) // If not, clear the archive bit.
+	{
+		total[1]++;
+		f_chmod_fast(path, 0, AM_ARC);
+	}
+}
+
 static int _fix_attributes(lv_obj_t *lb_val, char *path, u32 *total)
 {
 	FRESULT res;
-	DIR dir;
-	u32 dirLength = 0;
-	static FILINFO fno;
+	FILINFO fno;
+	int depth = 0;
+	u32 timer = 0;
+
+	// Use an explicit stack of open directories instead of recursing.
+	fix_attr_dir_t *stack = (fix_attr_dir_t *)malloc(sizeof(fix_attr_dir_t) * FIX_ATTR_MAX_DEPTH);
 
 	// Open directory.
-	res = f_opendir(&dir, path);
+	res = f_opendir(&stack[0].dir, path);
 	if (res != FR_OK)
+	{
+		free(stack);
 		return res;
+	}
 
-	dirLength = strlen(path);
-	for (;;)
+	stack[0].path_len = strlen(path);
+	stack[0].is_hos_special = false;
+
+	while (depth >= 0)
 	{
+		fix_attr_dir_t *node = &stack[depth];
+
 		// Clear file or folder path.
-		path[dirLength] = 0;
+		path[node->path_len] = 0;
 
 		// Read a directory item.
-		res = f_readdir(&dir, &fno);
+		res = f_readdir(&node->dir, &fno);
 
 		// Break on error or end of dir.
 		if (res != FR_OK || fno.fname[0] == 0)
-			break;
+		{
+			f_closedir(&node->dir);
+			depth--;
+
+			if (res != FR_OK)
+				break;
+
+			// Fix the folder itself now that all its items are known. Root is left as is.
+			if (depth >= 0)
+				_fix_attributes_dir(path, node, total);
+
+			continue;
+		}
+
+		// Check if it's a HOS single file folder.
+		if (fno.fname[0] == '0' && fno.fname[1] == '0' && !fno.fname[2])
+			node->is_hos_special = true;
 
-		// Set new directory or file.
-		memcpy(&path[dirLength], "/", 1);
-		strcpy(&path[dirLength + 1], fno.fname);
+		// Skip files.
+		if (!(fno.fattrib & AM_DIR))
+			continue;
 
-		// Is it a directory?
-		if (fno.fattrib & AM_DIR)
+		// Count folders nested too deep, so they get reported.
+		if (depth == (FIX_ATTR_MAX_DEPTH - 1))
 		{
-			// Check if it's a HOS single file folder.
-			strcat(path, "/00");
-			bool is_hos_special = !f_stat(path, NULL);
-			path[strlen(path) - 3] = 0;
+			total[2]++;
+			continue;
+		}
 
-			// Set archive bit to HOS single file folders.
-			if (is_hos_special)
-			{
-				if (!(fno.fattrib & AM_ARC))
-				{
-					total[0]++;
-					f_chmod(path, AM_ARC, AM_ARC);
-				}
-			}
-			else if (fno.fattrib & AM_ARC) // If not, clear the archive bit.
-			{
-				total[1]++;
-				f_chmod(path, 0, AM_ARC);
-			}
+		// Set new directory.
+		path[node->path_len] = '/';
+		strcpy(&path[node->path_len + 1], fno.fname);
 
+		// Throttle status updates.
+		if (get_tmr_ms() - timer >= FIX_ATTR_UI_INTV_MS)
+		{
 			lv_label_set_text(lb_val, path);
 			manual_system_maintenance(true);
-
-			// Enter the directory.
-			res = _fix_attributes(lb_val, path, total);
-			if (res != FR_OK)
-				break;
+			timer = get_tmr_ms();
 		}
+
+		// Enter the directory.
+		fix_attr_dir_t *child = &stack[depth + 1];
+		res = f_opendir(&child->dir, path);
+		if (res != FR_OK)
+			break;
+
+		child->path_len = strlen(path);
+		child->attrib = fno.fattrib;
+		child->is_hos_special = false;
+		depth++;
 	}
 
-	f_closedir(&dir);
+	// Close any directories left open on error.
+	for (; depth >= 0; depth--)
+		f_closedir(&stack[depth].dir);
+
+	// Write back all batched attribute changes.
+	f_sync_vol("");
+
+	free(stack);
 
 	return res;
 }
@@ -915,7 +975,7 @@ static lv_res_t _create_window_unset_abit_tool(lv_obj_t *btn)
 		lv_obj_set_width(lb_val, lv_obj_get_width(val));
 		lv_obj_align(val, desc, LV_ALIGN_OUT_BOTTOM_LEFT, 0, 0);
 
-		u32 total[2] = { 0 };
+		u32 total[3] = { 0 };
 		_fix_attributes(lb_val, path, total);
 
 		sd_unmount();
@@ -927,6 +987,8 @@ static lv_res_t _create_window_unset_abit_tool(lv_obj_t *btn)
 		char *txt_buf = (char *)malloc(0x500);
 
 		s_printf(txt_buf, "#96FF00 Total archive bits fixed:# #FF8000 %d unset, %d set!#", total[1], total[0]);
+		if (total[2])
+			s_printf(txt_buf + strlen(txt_buf), "\n#FFDD00 %d folders were nested too deep and were skipped!#", total[2]);
 
 		lv_label_set_text(lb_desc2, txt_buf);
 		lv_obj_set_width(lb_desc2, lv_obj_get_width(desc2));
@@ -19,6 +19,7 @@
 #include "gui.h"
 #include "gui_tools.h"
 #include "gui_tools_partition_manager.h"
+#include "../config.h"
 #include <libs/fatfs/diskio.h>
 #include <libs/lvgl/lvgl.h>
 #include <mem/heap.h>
@@ -37,6 +38,7 @@
 
 extern volatile boot_cfg_t *b_cfg;
 extern volatile nyx_storage_t *nyx_str;
+extern nyx_config n_cfg;
 
 typedef struct _partition_ctxt_t
 {
@@ -214,6 +216,11 @@ static void _prepare_and_flash_mbr_gpt()
 	// Read current MBR.
 	sdmmc_storage_read(&sd_storage, 0, 1, &mbr);
 
+	// Discard the reserved area. The FAT partition was already discarded by f_mkfs.
+	u32 rsvd_start = 0x8000 + (part_info.hos_size << 11);
+	if (n_cfg.sd_discard && rsvd_start < sd_storage.sec_cnt)
+		sdmmc_storage_erase(&sd_storage, rsvd_start, sd_storage.sec_cnt - rsvd_start, SDMMC_ERASE_DISCARD);
+
 	// Clear the first 16MB.
 	memset((void *)SDMMC_UPPER_BUFFER, 0, 0x8000);
 	sdmmc_storage_write(&sd_storage, 0, 0x8000, (void *)SDMMC_UPPER_BUFFER);
@@ -437,34 +437,63 @@ void gfx_set_pixel(u32 x, u32 y, u32 color)
 	gfx_ctxt.fb[y + (gfx_ctxt.width - x) * gfx_ctxt.stride] = color;
 }
 
-void __attribute__((optimize("unroll-loops"))) gfx_set_rect_land_pitch(u32 *fb, const u32 *buf, u32 stride, u32 pos_x, u32 pos_y, u32 pos_x2, u32 pos_y2)
+static inline void _gfx_rotate_tile_8x8(u32 *fb, const u32 *buf, u32 buf_w, u32 stride)
 {
-	u32 *ptr = (u32 *)buf;
+	// Each source column of the tile becomes a contiguous 8 pixel run in fb.
+	for (u32 i = 0; i < 8; i++)
+	{
+		const u32 *src = &buf[i];
+
+		fb[0] = src[0];
+		fb[1] = src[buf_w];
+		fb[2] = src[buf_w * 2];
+		fb[3] = src[buf_w * 3];
+		fb[4] = src[buf_w * 4];
+		fb[5] = src[buf_w * 5];
+		fb[6] = src[buf_w * 6];
+		fb[7] = src[buf_w * 7];
+
+		fb += stride;
+	}
+}
 
+void __attribute__((optimize("unroll-loops"))) gfx_set_rect_land_pitch(u32 *fb, const u32 *buf, u32 stride, u32 pos_x, u32 pos_y, u32 pos_x2, u32 pos_y2)
+{
 	u32 pixels_w = pos_x2 - pos_x + 1;
+	u32 pixels_h = pos_y2 - pos_y + 1;
+	u32 tiled_w  = pixels_w & ~7;
+	u32 tiled_h  = pixels_h & ~7;
 
-	if (!(pixels_w % 8))
+	fb += pos_x * stride + pos_y;
+
+	// Rotate in 8x8 tiles so both buffers are accessed in cache line sized runs.
+	for (u32 y = 0; y < tiled_h; y += 8)
 	{
-		for (u32 y = pos_y; y < (pos_y2 + 1); y++)
-			for (u32 x = pos_x; x < (pos_x2 + 1); x+=8)
-			{
-				u32 *fbx = &fb[x * stride + y];
-
-				fbx[0]          = *ptr++;
-				fbx[stride]     = *ptr++;
-				fbx[stride * 2] = *ptr++;
-				fbx[stride * 3] = *ptr++;
-				fbx[stride * 4] = *ptr++;
-				fbx[stride * 5] = *ptr++;
-				fbx[stride * 6] = *ptr++;
-				fbx[stride * 7] = *ptr++;
-			}
+		const u32 *src = &buf[y * pixels_w];
+		u32 *dst = &fb[y];
+
+		for (u32 x = 0; x < tiled_w; x += 8)
+		{
+			_gfx_rotate_tile_8x8(dst, src, pixels_w, stride);
+			src += 8;
+			dst += stride * 8;
+		}
 	}
-	else
+
+	// Right edge. Columns past the last full tile.
+	for (u32 x = tiled_w; x < pixels_w; x++)
+	{
+		u32 *dst = &fb[x * stride];
+		for (u32 y = 0; y < pixels_h; y++)
+			dst[y] = buf[y * pixels_w + x];
+	}
+
+	// Bottom edge. Rows past the last full tile.
+	for (u32 x = 0; x < tiled_w; x++)
 	{
-		for (u32 y = pos_y; y < (pos_y2 + 1); y++)
-			for (u32 x = pos_x; x < (pos_x2 + 1); x++)
-				fb[x * stride + y] = *ptr++;
+		u32 *dst = &fb[x * stride];
+		for (u32 y = tiled_h; y < pixels_h; y++)
+			dst[y] = buf[y * pixels_w + x];
 	}
 }
 
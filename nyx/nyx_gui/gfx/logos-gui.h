@@ -392,7 +392,7 @@ lv_img_dsc_t hekate_logo = {
 	.header.h = 76,
 	.data_size = 14668 * LV_IMG_PX_SIZE_ALPHA_BYTE,
 	.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA,
-	.data = (const uint8_t *)(NYX_RES_ADDR + 0x1D900),
+	.data = (const uint8_t *)(NYX_RES_ADDR + NYX_RES_HEKATE_LOGO_OFF),
 };
 
 lv_img_dsc_t ctcaer_logo = {
@@ -401,7 +401,7 @@ lv_img_dsc_t ctcaer_logo = {
 	.header.h = 76,
 	.data_size = 11172 * LV_IMG_PX_SIZE_ALPHA_BYTE,
 	.header.cf = LV_IMG_CF_TRUE_COLOR_ALPHA,
-	.data = (const uint8_t *)(NYX_RES_ADDR + 0x2BF00),
+	.data = (const uint8_t *)(NYX_RES_ADDR + NYX_RES_CTCAER_LOGO_OFF),
 };
 
 #endif
@@ -107,6 +107,19 @@ DRESULT disk_ioctl (
 		case GET_BLOCK_SIZE:
 			*buf = 32768; // Align to 16MB.
 			break;
+		case GET_AU_SIZE:
+			*buf = sd_storage.ssr.au_size; // 0 if SD Status was not read.
+			break;
+		case CTRL_SYNC:
+			if (!sdmmc_storage_flush(&sd_storage))
+				return RES_ERROR;
+			break;
+		case CTRL_TRIM:
+			if (!sd_get_discard())
+				break;
+			if (!sdmmc_storage_erase(&sd_storage, buf[0], buf[1] - buf[0] + 1, SDMMC_ERASE_DISCARD))
+				return RES_ERROR;
+			break;
 		}
 	}
 	else if (pdrv == DRIVE_RAM)
@@ -27,6 +27,7 @@
 #include "hos/hos.h"
 #include <ianos/ianos.h>
 #include <libs/compr/blz.h>
+#include <libs/compr/lz4_pak.h>
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
 #include <mem/minerva.h>
@@ -41,6 +42,7 @@
 #include <soc/t210.h>
 #include <soc/uart.h>
 #include <storage/nx_sd.h>
+#include <storage/sd_stream.h>
 #include <storage/sdmmc.h>
 #include <utils/btn.h>
 #include <utils/dirlist.h>
@@ -151,8 +153,8 @@ lv_res_t launch_payload(lv_obj_t *list)
 
 	if (sd_mount())
 	{
-		FIL fp;
-		if (f_open(&fp, path, FA_READ))
+		sd_stream_t st;
+		if (sd_stream_open(&st, path, 0))
 		{
 			EPRINTFARGS("Payload file is missing!\n(%s)", path);
 
@@ -161,7 +163,7 @@ lv_res_t launch_payload(lv_obj_t *list)
 
 		// Read and copy the payload to our chosen address
 		void *buf;
-		u32 size = f_size(&fp);
+		u32 size = f_size(&st.fp);
 
 		if (size < 0x30000)
 			buf = (void *)RCM_PAYLOAD_ADDR;
@@ -171,7 +173,7 @@ lv_res_t launch_payload(lv_obj_t *list)
 			buf = coreboot_addr;
 			if (h_cfg.t210b01)
 			{
-				f_close(&fp);
+				sd_stream_close(&st);
 
 				EPRINTF("T210B01: Coreboot not allowed!");
 
@@ -179,14 +181,14 @@ lv_res_t launch_payload(lv_obj_t *list)
 			}
 		}
 
-		if (f_read(&fp, buf, size, NULL))
+		if (sd_stream_read(&st, buf, size, NULL))
 		{
-			f_close(&fp);
+			sd_stream_close(&st);
 
 			goto out;
 		}
 
-		f_close(&fp);
+		sd_stream_close(&st);
 
 		sd_end();
 
@@ -224,36 +226,31 @@ void load_saved_configuration()
 	// Load hekate configuration.
 	if (ini_parse(&ini_sections, "bootloader/hekate_ipl.ini", false))
 	{
-		LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, &ini_sections, link)
+		// Only parse config sections. Later ones override earlier ones.
+		for (ini_sec_t *ini_sec = ini_get_sec(&ini_sections, "config"); ini_sec; ini_sec = ini_get_sec_next(ini_sec))
 		{
-			// Only parse config section.
-			if (ini_sec->type == INI_CHOICE && !strcmp(ini_sec->name, "config"))
+			LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
 			{
-				LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
+				if (!strcmp("autoboot", kv->key))
+					h_cfg.autoboot = atoi(kv->val);
+				else if (!strcmp("autoboot_list", kv->key))
+					h_cfg.autoboot_list = atoi(kv->val);
+				else if (!strcmp("bootwait", kv->key))
+					h_cfg.bootwait = atoi(kv->val);
+				else if (!strcmp("backlight", kv->key))
 				{
-					if (!strcmp("autoboot", kv->key))
-						h_cfg.autoboot = atoi(kv->val);
-					else if (!strcmp("autoboot_list", kv->key))
-						h_cfg.autoboot_list = atoi(kv->val);
-					else if (!strcmp("bootwait", kv->key))
-						h_cfg.bootwait = atoi(kv->val);
-					else if (!strcmp("backlight", kv->key))
-					{
-						h_cfg.backlight = atoi(kv->val);
-						if (h_cfg.backlight <= 20)
-							h_cfg.backlight = 30;
-					}
-					else if (!strcmp("autohosoff", kv->key))
-						h_cfg.autohosoff = atoi(kv->val);
-					else if (!strcmp("autonogc", kv->key))
-						h_cfg.autonogc = atoi(kv->val);
-					else if (!strcmp("updater2p", kv->key))
-						h_cfg.updater2p = atoi(kv->val);
-					else if (!strcmp("bootprotect", kv->key))
-						h_cfg.bootprotect = atoi(kv->val);
+					h_cfg.backlight = atoi(kv->val);
+					if (h_cfg.backlight <= 20)
+						h_cfg.backlight = 30;
 				}
-
-				break;
+				else if (!strcmp("autohosoff", kv->key))
+					h_cfg.autohosoff = atoi(kv->val);
+				else if (!strcmp("autonogc", kv->key))
+					h_cfg.autonogc = atoi(kv->val);
+				else if (!strcmp("updater2p", kv->key))
+					h_cfg.updater2p = atoi(kv->val);
+				else if (!strcmp("bootprotect", kv->key))
+					h_cfg.bootprotect = atoi(kv->val);
 			}
 		}
 	}
@@ -261,30 +258,27 @@ void load_saved_configuration()
 	// Load Nyx configuration.
 	if (ini_parse(&ini_nyx_sections, "bootloader/nyx.ini", false))
 	{
-		LIST_FOREACH_ENTRY(ini_sec_t, ini_sec, &ini_nyx_sections, link)
+		// Only parse config sections. Later ones override earlier ones.
+		for (ini_sec_t *ini_sec = ini_get_sec(&ini_nyx_sections, "config"); ini_sec; ini_sec = ini_get_sec_next(ini_sec))
 		{
-			// Only parse config section.
-			if (ini_sec->type == INI_CHOICE && !strcmp(ini_sec->name, "config"))
+			LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
 			{
-				LIST_FOREACH_ENTRY(ini_kv_t, kv, &ini_sec->kvs, link)
-				{
-					if (!strcmp("themecolor", kv->key))
-						n_cfg.themecolor = atoi(kv->val);
-					else if (!strcmp("timeoff", kv->key))
-						n_cfg.timeoff = strtol(kv->val, NULL, 16);
-					else if (!strcmp("homescreen", kv->key))
-						n_cfg.home_screen = atoi(kv->val);
-					else if (!strcmp("verification", kv->key))
-						n_cfg.verification = atoi(kv->val);
-					else if (!strcmp("umsemmcrw", kv->key))
-						n_cfg.ums_emmc_rw = atoi(kv->val) == 1;
-					else if (!strcmp("jcdisable", kv->key))
-						n_cfg.jc_disable = atoi(kv->val) == 1;
-					else if (!strcmp("newpowersave", kv->key))
-						n_cfg.new_powersave = atoi(kv->val) == 1;
-				}
-
-				break;
+				if (!strcmp("themecolor", kv->key))
+					n_cfg.themecolor = atoi(kv->val);
+				else if (!strcmp("timeoff", kv->key))
+					n_cfg.timeoff = strtol(kv->val, NULL, 16);
+				else if (!strcmp("homescreen", kv->key))
+					n_cfg.home_screen = atoi(kv->val);
+				else if (!strcmp("verification", kv->key))
+					n_cfg.verification = atoi(kv->val);
+				else if (!strcmp("umsemmcrw", kv->key))
+					n_cfg.ums_emmc_rw = atoi(kv->val) == 1;
+				else if (!strcmp("jcdisable", kv->key))
+					n_cfg.jc_disable = atoi(kv->val) == 1;
+				else if (!strcmp("newpowersave", kv->key))
+					n_cfg.new_powersave = atoi(kv->val) == 1;
+				else if (!strcmp("sddiscard", kv->key))
+					n_cfg.sd_discard = atoi(kv->val) == 1;
 			}
 		}
 	}
@@ -345,6 +339,68 @@ static void _show_errors()
 	}
 }
 
+static u8 *res_pak = NULL;
+static u8 *res_pak_loaded = NULL;
+static u32 res_pak_left = 0;
+
+void nyx_res_load(const void *addr, u32 size)
+{
+	if (!res_pak || !size)
+		return;
+
+	const lz4_pak_hdr_t *hdr = (const lz4_pak_hdr_t *)res_pak;
+	const lz4_pak_entry_t *entries = (const lz4_pak_entry_t *)(hdr + 1);
+	u32 start = (u32)addr - NYX_RES_ADDR;
+	u32 end = start + size;
+
+	int idx = lz4_pak_find(res_pak, start);
+	if (idx < 0)
+		return;
+
+	// Entries are contiguous, so unpack forward until the whole range is covered.
+	for (u32 i = idx; i < hdr->count && entries[i].raw_off < end; i++)
+	{
+		if (res_pak_loaded[i])
+			continue;
+
+		if (!lz4_pak_unpack_entry(res_pak, i, (void *)NYX_RES_ADDR))
+		{
+			// Corrupt pak. Continue as if res.pak was missing and blank what is not unpacked yet.
+			for (u32 j = 0; j < hdr->count; j++)
+				if (!res_pak_loaded[j])
+					memset((void *)(NYX_RES_ADDR + entries[j].raw_off), 0, entries[j].raw_size);
+			res_pak_left = 0;
+			break;
+		}
+
+		res_pak_loaded[i] = 1;
+		res_pak_left--;
+	}
+
+	// Release the pak when everything is unpacked.
+	if (!res_pak_left)
+	{
+		free(res_pak);
+		free(res_pak_loaded);
+		res_pak = NULL;
+	}
+}
+
+static void _nyx_res_pak_init(u32 size)
+{
+	const lz4_pak_hdr_t *hdr = lz4_pak_get_hdr((void *)NYX_RES_ADDR, size);
+	if (!hdr || hdr->raw_size > NYX_RES_SZ)
+		return;
+
+	// Move the pak out of the resource area. Resources are unpacked there on first use.
+	res_pak = (u8 *)malloc(size);
+	res_pak_loaded = (u8 *)calloc(hdr->count, 1);
+	res_pak_left = hdr->count;
+	memcpy(res_pak, (void *)NYX_RES_ADDR, size);
+
+	lv_font_set_bitmap_loader(nyx_res_load);
+}
+
 void nyx_init_load_res()
 {
 	bpmp_mmu_enable();
@@ -368,24 +424,21 @@ void nyx_init_load_res()
 
 	load_saved_configuration();
 
-	FIL fp;
-	if (!f_open(&fp, "bootloader/sys/res.pak", FA_READ))
+	// Allow FatFs TRIM only if enabled in Nyx options.
+	sd_set_discard(n_cfg.sd_discard);
+
+	sd_stream_t st;
+	if (!sd_stream_open(&st, "bootloader/sys/res.pak", 0))
 	{
-		f_read(&fp, (void *)NYX_RES_ADDR, f_size(&fp), NULL);
-		f_close(&fp);
-	}
+		u32 res_size = f_size(&st.fp);
+		sd_stream_read(&st, (void *)NYX_RES_ADDR, res_size, NULL);
+		sd_stream_close(&st);
 
-	// If no custom switch icon exists, load normal.
-	if (f_stat("bootloader/res/icon_switch_custom.bmp", NULL))
-		icon_switch = bmp_to_lvimg_obj("bootloader/res/icon_switch.bmp");
-	else
-		icon_switch = bmp_to_lvimg_obj("bootloader/res/icon_switch_custom.bmp");
+		// If LZ4 packed, resources get unpacked on first use.
+		_nyx_res_pak_init(res_size);
+	}
 
-	// If no custom payload icon exists, load normal.
-	if (f_stat("bootloader/res/icon_payload_custom.bmp", NULL))
-		icon_payload = bmp_to_lvimg_obj("bootloader/res/icon_payload.bmp");
-	else
-		icon_payload = bmp_to_lvimg_obj("bootloader/res/icon_payload_custom.bmp");
+	// System icons are loaded when the launch window is first opened.
 
 	// Load background resource if any.
 	hekate_bg = bmp_to_lvimg_obj("bootloader/res/background.bmp");
@@ -16,13 +16,16 @@
  */
 
 #include <storage/nx_sd.h>
+#include <storage/sd_stream.h>
 #include <storage/sdmmc.h>
 #include <storage/sdmmc_driver.h>
 #include <gfx_utils.h>
 #include <libs/fatfs/ff.h>
 #include <mem/heap.h>
+#include <utils/util.h>
 
 static bool sd_mounted = false;
+static bool sd_discard = false; // FatFs TRIM passthrough.
 static bool sd_init_done = false;
 static u16  sd_errors[3] = { 0 }; // Init and Read/Write errors.
 static u32  sd_mode = SD_UHS_SDR104;
@@ -31,6 +34,8 @@ sdmmc_t sd_sdmmc;
 sdmmc_storage_t sd_storage;
 FATFS sd_fs;
 
+extern volatile nyx_storage_t *nyx_str;
+
 void sd_error_count_increment(u8 type)
 {
 	switch (type)
@@ -65,6 +70,16 @@ u32 sd_get_mode()
 	return sd_mode;
 }
 
+void sd_set_discard(bool enable)
+{
+	sd_discard = enable;
+}
+
+bool sd_get_discard()
+{
+	return sd_discard;
+}
+
 int sd_init_retry(bool power_cycle)
 {
 	u32 bus_width = SDMMC_BUS_WIDTH_4;
@@ -102,10 +117,27 @@ int sd_init_retry(bool power_cycle)
 	return sdmmc_storage_init_sd(&sd_storage, &sd_sdmmc, bus_width, type);
 }
 
+static bool _sd_init_handoff()
+{
+	sdmmc_handoff_t *ho = (sdmmc_handoff_t *)&nyx_str->sd_handoff;
+
+	if (ho->magic != SDMMC_HANDOFF_MAGIC || sd_mode != SD_UHS_SDR104)
+		return false;
+
+	int res = sdmmc_storage_init_sd_handoff(&sd_storage, &sd_sdmmc, ho, SDHCI_TIMING_UHS_SDR104);
+
+	// Card state can only be taken over once.
+	ho->magic = 0;
+
+	return res;
+}
+
 bool sd_initialize(bool power_cycle)
 {
 	if (power_cycle)
 		sdmmc_storage_end(&sd_storage);
+	else if (_sd_init_handoff())
+		return true;
 
 	int res = !sd_init_retry(false);
 
@@ -194,25 +226,26 @@ void sd_end()     { _sd_deinit(true); }
 
 void *sd_file_read(const char *path, u32 *fsize)
 {
-	FIL fp;
-	if (f_open(&fp, path, FA_READ) != FR_OK)
+	sd_stream_t st;
+	if (sd_stream_open(&st, path, 0) != FR_OK)
 		return NULL;
 
-	u32 size = f_size(&fp);
+	u32 size = f_size(&st.fp);
 	if (fsize)
 		*fsize = size;
 
 	void *buf = malloc(size);
 
-	if (f_read(&fp, buf, size, NULL) != FR_OK)
+	// Cluster chain is already resolved. Contiguous runs are read in one go.
+	if (sd_stream_read(&st, buf, size, NULL) != FR_OK)
 	{
 		free(buf);
-		f_close(&fp);
+		sd_stream_close(&st);
 
 		return NULL;
 	}
 
-	f_close(&fp);
+	sd_stream_close(&st);
 
 	return buf;
 }
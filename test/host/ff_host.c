@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <ctype.h>
+#include <string.h>
+
+#include <libs/fatfs/ff.h>
+
+typedef struct _ff_host_file_t
+{
+	char path[256];
+	const u8 *data;
+	u32 size;
+	u8 attrib;
+} ff_host_file_t;
+
+static ff_host_file_t files[FF_HOST_FILES_MAX];
+static int files_cnt;
+
+void ff_host_reset()
+{
+	files_cnt = 0;
+}
+
+void ff_host_add(const char *path, const void *data, u32 size, u8 attrib)
+{
+	if (files_cnt == FF_HOST_FILES_MAX)
+		return;
+
+	ff_host_file_t *f = &files[files_cnt++];
+	strncpy(f->path, path, sizeof(f->path) - 1);
+	f->path[sizeof(f->path) - 1] = 0;
+	f->data = data;
+	f->size = size;
+	f->attrib = attrib;
+}
+
+static int _ff_host_find(const char *path)
+{
+	for (int i = 0; i < files_cnt; i++)
+		if (!strcmp(files[i].path, path))
+			return i;
+
+	return -1;
+}
+
+static const char *_ff_host_name(const char *path)
+{
+	const char *name = strrchr(path, '/');
+
+	return name ? name + 1 : path;
+}
+
+static void _ff_host_info(int i, FILINFO *fno)
+{
+	fno->fsize = files[i].size;
+	fno->fdate = 0;
+	fno->ftime = 0;
+	fno->fattrib = files[i].attrib;
+	strcpy(fno->fname, _ff_host_name(files[i].path));
+}
+
+FRESULT f_open(FIL *fp, const char *path, u8 mode)
+{
+	(void)mode;
+
+	int i = _ff_host_find(path);
+	if (i < 0 || (files[i].attrib & AM_DIR))
+		return FR_NO_FILE;
+
+	fp->file = i;
+	fp->fptr = 0;
+	fp->size = files[i].size;
+
+	return FR_OK;
+}
+
+FRESULT f_close(FIL *fp)
+{
+	fp->file = -1;
+
+	return FR_OK;
+}
+
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br)
+{
+	UINT left = fp->size - fp->fptr;
+	if (btr > left)
+		btr = left;
+
+	memcpy(buff, files[fp->file].data + fp->fptr, btr);
+	fp->fptr += btr;
+	*br = btr;
+
+	return FR_OK;
+}
+
+FRESULT f_stat(const char *path, FILINFO *fno)
+{
+	int i = _ff_host_find(path);
+	if (i < 0)
+		return FR_NO_FILE;
+
+	if (fno)
+		_ff_host_info(i, fno);
+
+	return FR_OK;
+}
+
+// FF_USE_STRFUNC 2: '\r' is dropped.
+char *f_gets(char *buff, int len, FIL *fp)
+{
+	int nc = 0;
+	char *p = buff;
+
+	while (nc < len - 1 && fp->fptr < fp->size)
+	{
+		char c = files[fp->file].data[fp->fptr++];
+		if (c == '\r')
+			continue;
+		*p++ = c;
+		nc++;
+		if (c == '\n')
+			break;
+	}
+	*p = 0;
+
+	return nc ? buff : NULL;
+}
+
+// Case insensitive, with '*' and '?', like FatFs pattern matching.
+static int _ff_host_match(const char *pat, const char *name)
+{
+	if (!*pat)
+		return !*name;
+
+	if (*pat == '*')
+		return _ff_host_match(pat + 1, name) || (*name && _ff_host_match(pat, name + 1));
+
+	if (*name && (*pat == '?' || toupper((u8)*pat) == toupper((u8)*name)))
+		return _ff_host_match(pat + 1, name + 1);
+
+	return 0;
+}
+
+FRESULT f_opendir(DIR *dp, const char *path)
+{
+	int i = _ff_host_find(path);
+	if (i < 0 || !(files[i].attrib & AM_DIR))
+		return FR_NO_PATH;
+
+	strcpy(dp->path, path);
+	dp->pat = NULL;
+	dp->pos = 0;
+
+	return FR_OK;
+}
+
+FRESULT f_closedir(DIR *dp)
+{
+	dp->pos = files_cnt;
+
+	return FR_OK;
+}
+
+FRESULT f_readdir(DIR *dp, FILINFO *fno)
+{
+	u32 len = strlen(dp->path);
+
+	fno->fname[0] = 0;
+	for (; dp->pos < files_cnt; dp->pos++)
+	{
+		const char *path = files[dp->pos].path;
+
+		// Direct children only.
+		if (strncmp(path, dp->path, len) || path[len] != '/' || strchr(path + len + 1, '/'))
+			continue;
+
+		if (dp->pat && !_ff_host_match(dp->pat, path + len + 1))
+			continue;
+
+		_ff_host_info(dp->pos++, fno);
+		break;
+	}
+
+	return FR_OK;
+}
+
+FRESULT f_findfirst(DIR *dp, FILINFO *fno, const char *path, const char *pattern)
+{
+	FRESULT res = f_opendir(dp, path);
+	if (res)
+		return res;
+
+	dp->pat = pattern;
+
+	return f_readdir(dp, fno);
+}
+
+FRESULT f_findnext(DIR *dp, FILINFO *fno)
+{
+	return f_readdir(dp, fno);
+}
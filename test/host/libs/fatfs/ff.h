@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_FF_H_
+#define _HOST_FF_H_
+
+#include <utils/types.h>
+
+/*
+ * FatFs subset backed by an in-memory file table.
+ * Directory entries are returned in the order they were added.
+ */
+
+#define FF_HOST_FILES_MAX 512
+
+typedef u64 FSIZE_t;
+
+typedef enum {
+	FR_OK = 0,
+	FR_DISK_ERR,
+	FR_NO_FILE = 4,
+	FR_NO_PATH = 5
+} FRESULT;
+
+#define FA_READ 0x01
+
+#define AM_RDO 0x01
+#define AM_HID 0x02
+#define AM_SYS 0x04
+#define AM_DIR 0x10
+#define AM_ARC 0x20
+
+typedef struct {
+	int file;
+	FSIZE_t fptr;
+	FSIZE_t size;
+} FIL;
+
+typedef struct {
+	char path[256];
+	const char *pat;
+	int pos;
+} DIR;
+
+typedef struct {
+	FSIZE_t fsize;
+	u16 fdate;
+	u16 ftime;
+	u8 fattrib;
+	char fname[256];
+} FILINFO;
+
+#define f_eof(fp) ((int)((fp)->fptr == (fp)->size))
+#define f_size(fp) ((fp)->size)
+
+FRESULT f_open(FIL *fp, const char *path, u8 mode);
+FRESULT f_close(FIL *fp);
+FRESULT f_read(FIL *fp, void *buff, UINT btr, UINT *br);
+FRESULT f_stat(const char *path, FILINFO *fno);
+char *f_gets(char *buff, int len, FIL *fp);
+FRESULT f_opendir(DIR *dp, const char *path);
+FRESULT f_closedir(DIR *dp);
+FRESULT f_readdir(DIR *dp, FILINFO *fno);
+FRESULT f_findfirst(DIR *dp, FILINFO *fno, const char *path, const char *pattern);
+FRESULT f_findnext(DIR *dp, FILINFO *fno);
+
+void ff_host_reset();
+// Adds a file, or a folder if attrib has AM_DIR. Data is not copied.
+void ff_host_add(const char *path, const void *data, u32 size, u8 attrib);
+
+#endif
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _HOST_TYPES_H_
+#define _HOST_TYPES_H_
+
+#include <stdint.h>
+#include_next <utils/types.h>
+
+// bdk casts pointers to u32. Use full width pointers on 64-bit hosts.
+#undef OFFSET_OF
+#undef CONTAINER_OF
+#define OFFSET_OF(t, m) ((uintptr_t)&((t *)NULL)->m)
+#define CONTAINER_OF(mp, t, mn) ((t *)((uintptr_t)mp - OFFSET_OF(t, mn)))
+
+#endif
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _TEST_H_
+#define _TEST_H_
+
+#include <stdio.h>
+
+// Minimal host test helpers. Each test binary returns non zero if any check failed.
+
+static int test_fails;
+
+#define CHECK(cond) \
+	do { \
+		if (!(cond)) \
+		{ \
+			printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+			test_fails++; \
+		} \
+	} while (0)
+
+#define TEST_DONE(name) \
+	do { \
+		printf("%s: %s\n", name, test_fails ? "FAIL" : "OK"); \
+		return test_fails ? 1 : 0; \
+	} while (0)
+
+#endif
@@ -0,0 +1,259 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include <libs/compr/blz.h>
+
+#define FUZZ_ITERATIONS 20000
+#define BUF_PAD         0x1100
+
+typedef struct _blz_tok_t
+{
+	u8  seg;
+	u8  lit;
+	u32 size;
+	u32 ofs;
+} blz_tok_t;
+
+static u32 rng = 7;
+
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+// Per-bit decoder as the kernel does it. The fast path must match it byte for byte.
+static int _ref_uncompress_inplace(u8 *buf, u32 comp_size, const blz_footer *footer)
+{
+	u8 *cmp_start = &buf[comp_size] - footer->cmp_and_hdr_size;
+	u32 cmp_ofs = footer->cmp_and_hdr_size - footer->header_size;
+	u32 out_ofs = footer->cmp_and_hdr_size + footer->addl_size;
+
+	while (out_ofs)
+	{
+		if (cmp_ofs < 1)
+			return 0;
+
+		u8 control = cmp_start[--cmp_ofs];
+		for (u32 i = 0; i < 8; i++, control <<= 1)
+		{
+			if (control & 0x80)
+			{
+				if (cmp_ofs < 2)
+					return 0;
+
+				cmp_ofs -= 2;
+				u32 seg_val = (cmp_start[cmp_ofs + 1] << 8) | cmp_start[cmp_ofs];
+				u32 seg_size = (seg_val >> 12) + 3;
+				u32 seg_ofs = (seg_val & 0xFFF) + 3;
+				if (out_ofs < seg_size)
+					seg_size = out_ofs;
+
+				out_ofs -= seg_size;
+				for (u32 j = 0; j < seg_size; j++)
+					cmp_start[out_ofs + j] = cmp_start[out_ofs + j + seg_ofs];
+			}
+			else
+			{
+				if (cmp_ofs < 1)
+					return 0;
+
+				cmp_start[--out_ofs] = cmp_start[--cmp_ofs];
+			}
+
+			if (!out_ofs)
+				return 1;
+		}
+	}
+
+	return 1;
+}
+
+// Serializes tokens into a stream that is consumed backwards from its end.
+static u32 _encode(u8 *dst, const blz_tok_t *tok, u32 ntok, u32 comp_len)
+{
+	u32 pos = comp_len;
+	u32 k = 0;
+
+	while (k < ntok)
+	{
+		u32 ctrl_pos = --pos;
+		u8 ctrl = 0;
+
+		for (u32 b = 0; b < 8 && k < ntok; b++, k++)
+		{
+			if (tok[k].seg)
+			{
+				u32 val = ((tok[k].size - 3) << 12) | (tok[k].ofs - 3);
+
+				ctrl |= 0x80 >> b;
+				pos -= 2;
+				dst[pos] = val & 0xFF;
+				dst[pos + 1] = val >> 8;
+			}
+			else
+				dst[--pos] = tok[k].lit;
+		}
+		dst[ctrl_pos] = ctrl;
+	}
+
+	return pos;
+}
+
+static void test_fuzz()
+{
+	blz_tok_t *tok = malloc(sizeof(blz_tok_t) * 20000);
+	u32 tested = 0;
+
+	for (u32 it = 0; it < FUZZ_ITERATIONS; it++)
+	{
+		u32 out_size = 1 + _rand() % 8000;
+		u32 left = out_size;
+		u32 comp_len = 0;
+		u32 ntok = 0;
+		u32 seg_bias = _rand() % 10;
+		u32 ofs_mode = _rand() % 3;
+
+		// Mix literal runs with short, word aligned and far back-references.
+		while (left)
+		{
+			if (!(ntok % 8))
+				comp_len++;
+
+			u32 max_ofs = out_size - left;
+			if (max_ofs >= 3 && (_rand() % 10) < seg_bias)
+			{
+				u32 ofs;
+				if (ofs_mode == 0)
+					ofs = 3 + _rand() % (max_ofs - 2 > 4096 ? 4096 : max_ofs - 2);
+				else if (ofs_mode == 1)
+					ofs = 4 * (1 + _rand() % 4);
+				else
+					ofs = 3 + _rand() % 8;
+				if (ofs > max_ofs)
+					ofs = 3;
+
+				tok[ntok].seg = 1;
+				tok[ntok].size = 3 + _rand() % 16;
+				tok[ntok].ofs = ofs;
+				comp_len += 2;
+				left = left > tok[ntok].size ? left - tok[ntok].size : 0;
+			}
+			else
+			{
+				tok[ntok].seg = 0;
+				tok[ntok].lit = _rand();
+				comp_len++;
+				left--;
+			}
+			ntok++;
+		}
+
+		u32 hdr_size = _rand() % 16;
+		if (comp_len + hdr_size > out_size)
+			continue;
+
+		blz_footer footer = { comp_len + hdr_size, hdr_size, out_size - comp_len - hdr_size };
+		u8 *ref = calloc(out_size + BUF_PAD, 1);
+		u8 *buf = malloc(out_size + BUF_PAD);
+
+		CHECK(_encode(ref, tok, ntok, comp_len) == 0);
+		for (u32 i = comp_len; i < footer.cmp_and_hdr_size; i++)
+			ref[i] = _rand();
+		memcpy(buf, ref, out_size + BUF_PAD);
+
+		int ref_res = _ref_uncompress_inplace(ref, footer.cmp_and_hdr_size, &footer);
+		int res = blz_uncompress_inplace(buf, footer.cmp_and_hdr_size, &footer);
+		CHECK(res == ref_res);
+		CHECK(!memcmp(buf, ref, out_size + BUF_PAD));
+		tested++;
+
+		free(ref);
+		free(buf);
+	}
+	CHECK(tested > FUZZ_ITERATIONS / 2);
+
+	free(tok);
+}
+
+static void test_srcdest()
+{
+	// One untouched prefix byte, then "wxyz" repeated over 50 bytes. Copies run forward, so each
+	// one may only read bytes that are already out: the offset is never below the size.
+	static const blz_tok_t tok[] = {
+		{ 0, 'z', 0, 0 }, { 0, 'y', 0, 0 }, { 0, 'x', 0, 0 }, { 0, 'w', 0, 0 },
+		{ 1, 0, 4, 4 }, { 1, 0, 8, 8 }, { 1, 0, 16, 16 }, { 1, 0, 18, 32 }
+	};
+	const u32 comp_len = 1 + 4 + 4 * 2;
+	const u32 out_size = 4 + 4 + 8 + 16 + 18;
+	u8 comp[64];
+	u8 out[80];
+
+	// The footer is counted as the header of the compressed part.
+	blz_footer footer = { comp_len + sizeof(blz_footer), sizeof(blz_footer), out_size - comp_len - sizeof(blz_footer) };
+
+	comp[0] = 'H';
+	CHECK(_encode(comp + 1, tok, 8, comp_len) == 0);
+	memcpy(comp + 1 + comp_len, &footer, sizeof(footer));
+
+	memset(out, 0xAA, sizeof(out));
+	CHECK(blz_uncompress_srcdest(comp, 1 + comp_len + sizeof(footer), out, sizeof(out)));
+	CHECK(out[0] == 'H');
+	for (u32 i = 0; i < out_size; i++)
+		CHECK(out[1 + i] == "wxyz"[(i + 2) % 4]);
+
+	// No room for a footer.
+	CHECK(!blz_uncompress_srcdest(comp, sizeof(footer) - 1, out, sizeof(out)));
+}
+
+static void test_corrupt()
+{
+	u8 buf[BUF_PAD];
+	blz_footer footer;
+
+	// Output left to produce but no control byte.
+	memset(buf, 0, sizeof(buf));
+	footer = (blz_footer){ 4, 4, 16 };
+	CHECK(!blz_uncompress_inplace(buf, 4, &footer));
+
+	// Control byte asks for a back-reference with only one byte left.
+	buf[0] = 0;
+	buf[1] = 0x80;
+	footer = (blz_footer){ 2, 0, 8 };
+	CHECK(!blz_uncompress_inplace(buf, 2, &footer));
+
+	// Literals run out before the output does.
+	buf[0] = 'a';
+	buf[1] = 0x00;
+	footer = (blz_footer){ 2, 0, 8 };
+	CHECK(!blz_uncompress_inplace(buf, 2, &footer));
+}
+
+int main()
+{
+	test_fuzz();
+	test_srcdest();
+	test_corrupt();
+
+	TEST_DONE("blz");
+}
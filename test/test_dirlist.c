@@ -0,0 +1,198 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include <libs/fatfs/ff.h>
+#include <utils/dirlist.h>
+
+#define NAMES_MAX 400
+
+static char names[NAMES_MAX][256];
+
+static int _cmp(const void *a, const void *b)
+{
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+// Checks that the list holds exactly the given names, in ASCII order.
+static void _check_sorted(const dirlist_t *dl, char **expected, u32 count)
+{
+	qsort(expected, count, sizeof(char *), _cmp);
+
+	CHECK(dl && dl->count == count);
+	if (!dl || dl->count != count)
+		return;
+
+	for (u32 i = 0; i < count; i++)
+		CHECK(!strcmp(dirlist_name(dl, i), expected[i]));
+}
+
+static void test_filters()
+{
+	static const u8 data[100];
+	char *expected[8];
+
+	ff_host_reset();
+	ff_host_add("d", NULL, 0, AM_DIR);
+	ff_host_add("d/payload.bin", data, 10, AM_ARC);
+	ff_host_add("d/sub", NULL, 0, AM_DIR);
+	ff_host_add("d/Boot.ini", data, 20, AM_ARC);
+	ff_host_add("d/.hidden_dot", data, 1, AM_ARC);
+	ff_host_add("d/hidden.ini", data, 30, AM_ARC | AM_HID);
+	ff_host_add("d/a.INI", data, 40, AM_ARC);
+	ff_host_add("d/sub/nested.ini", data, 50, AM_ARC);
+	ff_host_add("d/.git", NULL, 0, AM_DIR);
+	ff_host_add("d/zdir", NULL, 0, AM_DIR | AM_HID);
+
+	// Files only, no dot or hidden entries, no nested ones.
+	dirlist_t *dl = dirlist_ext("d", NULL, 0);
+	expected[0] = "payload.bin"; expected[1] = "Boot.ini"; expected[2] = "a.INI";
+	_check_sorted(dl, expected, 3);
+	dirlist_free(dl);
+
+	dl = dirlist_ext("d", NULL, DIRLIST_HIDDEN);
+	expected[0] = "payload.bin"; expected[1] = "Boot.ini"; expected[2] = "a.INI"; expected[3] = "hidden.ini";
+	_check_sorted(dl, expected, 4);
+	dirlist_free(dl);
+
+	dl = dirlist_ext("d", NULL, DIRLIST_DIRS);
+	expected[0] = "sub";
+	_check_sorted(dl, expected, 1);
+	dirlist_free(dl);
+
+	dl = dirlist_ext("d", NULL, DIRLIST_DIRS | DIRLIST_HIDDEN);
+	expected[0] = "sub"; expected[1] = "zdir";
+	_check_sorted(dl, expected, 2);
+	dirlist_free(dl);
+
+	// Pattern never returns folders.
+	dl = dirlist_ext("d", "*.ini", DIRLIST_DIRS);
+	expected[0] = "Boot.ini"; expected[1] = "a.INI";
+	_check_sorted(dl, expected, 2);
+	dirlist_free(dl);
+
+	// Info follows each name after sorting.
+	dl = dirlist_ext("d", "*.ini", DIRLIST_INFO | DIRLIST_HIDDEN);
+	CHECK(dl && dl->count == 3);
+	if (dl && dl->count == 3)
+	{
+		CHECK(!strcmp(dirlist_name(dl, 0), "Boot.ini") && dirlist_info(dl, 0)->size == 20);
+		CHECK(!strcmp(dirlist_name(dl, 1), "a.INI") && dirlist_info(dl, 1)->size == 40);
+		CHECK(!strcmp(dirlist_name(dl, 2), "hidden.ini") && dirlist_info(dl, 2)->size == 30);
+		CHECK(dirlist_info(dl, 2)->attrib == (AM_ARC | AM_HID));
+	}
+	dirlist_free(dl);
+
+	// Empty or missing folders.
+	CHECK(!dirlist_ext("d/sub/none", NULL, 0));
+	CHECK(!dirlist_ext("d", "*.txt", 0));
+	CHECK(!dirlist("missing", NULL, false, false));
+	dirlist_free(NULL);
+}
+
+static void test_sort_growth()
+{
+	char *expected[NAMES_MAX];
+
+	srand(2);
+	for (u32 info = 0; info < 2; info++)
+	{
+		for (u32 count = 1; count <= NAMES_MAX; count += 57)
+		{
+			ff_host_reset();
+			ff_host_add("d", NULL, 0, AM_DIR);
+
+			// Random names, long enough to grow the name buffer too, and some duplicates.
+			char path[300];
+			for (u32 i = 0; i < count; i++)
+			{
+				if (i && !(rand() % 16))
+					strcpy(names[i], names[rand() % i]);
+				else
+				{
+					u32 len = 1 + rand() % 200;
+					for (u32 j = 0; j < len; j++)
+						names[i][j] = 'A' + rand() % 58;
+					names[i][len] = 0;
+				}
+				snprintf(path, sizeof(path), "d/%s", names[i]);
+				ff_host_add(path, NULL, i, AM_ARC);
+				expected[i] = names[i];
+			}
+
+			dirlist_t *dl = dirlist_ext("d", NULL, info ? DIRLIST_INFO : 0);
+			_check_sorted(dl, expected, count);
+
+			// Names stay with their own info.
+			if (info && dl)
+				for (u32 i = 0; i < dl->count; i++)
+					CHECK(!strcmp(names[dirlist_info(dl, i)->size], dirlist_name(dl, i)));
+
+			dirlist_free(dl);
+		}
+	}
+}
+
+static void test_compat()
+{
+	char *expected[100];
+
+	ff_host_reset();
+	ff_host_add("d", NULL, 0, AM_DIR);
+
+	// More entries than the wrapper returns, added in reverse order.
+	char path[32];
+	for (int i = 99; i >= 0; i--)
+	{
+		snprintf(names[i], 256, "f%02d.bin", i);
+		snprintf(path, sizeof(path), "d/%s", names[i]);
+		ff_host_add(path, NULL, 0, AM_ARC);
+		expected[i] = names[i];
+	}
+
+	// The first 61 names in ASCII order, then an empty slot.
+	char *list = dirlist("d", NULL, false, false);
+	CHECK(list != NULL);
+	if (!list)
+		return;
+
+	qsort(expected, 100, sizeof(char *), _cmp);
+	for (u32 i = 0; i < 61; i++)
+		CHECK(!strcmp(list + i * 256, expected[i]));
+	CHECK(!list[61 * 256]);
+	free(list);
+
+	// Fewer entries keep the terminator right after the last one.
+	ff_host_reset();
+	ff_host_add("d", NULL, 0, AM_DIR);
+	ff_host_add("d/b", NULL, 0, AM_ARC);
+	ff_host_add("d/a", NULL, 0, AM_ARC);
+	list = dirlist("d", NULL, false, false);
+	CHECK(list && !strcmp(list, "a") && !strcmp(list + 256, "b") && !list[512]);
+	free(list);
+}
+
+int main()
+{
+	test_filters();
+	test_sort_growth();
+	test_compat();
+
+	TEST_DONE("dirlist");
+}
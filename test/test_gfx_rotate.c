@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "test.h"
+#include <gfx/gfx.h>
+
+// Nyx draws a 1280x720 landscape UI into a 720 pixel wide portrait framebuffer.
+#define UI_W      1280
+#define UI_H      720
+#define FB_STRIDE 720
+#define FB_PIXELS (UI_W * FB_STRIDE)
+
+#define BENCH_ROUNDS 200
+
+static u32 rng = 9;
+
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+// One pixel per framebuffer row, as the flush did before tiling.
+static void _ref_rect_land_pitch(u32 *fb, const u32 *buf, u32 stride, u32 pos_x, u32 pos_y, u32 pos_x2, u32 pos_y2)
+{
+	for (u32 y = pos_y; y <= pos_y2; y++)
+		for (u32 x = pos_x; x <= pos_x2; x++)
+			fb[x * stride + y] = *buf++;
+}
+
+static void _check_rect(u32 *fb, u32 *ref, const u32 *buf, u32 x1, u32 y1, u32 x2, u32 y2)
+{
+	// Pixels outside the area must stay untouched.
+	memset(fb, 0x5A, FB_PIXELS * sizeof(u32));
+	memset(ref, 0x5A, FB_PIXELS * sizeof(u32));
+
+	gfx_set_rect_land_pitch(fb, buf, FB_STRIDE, x1, y1, x2, y2);
+	_ref_rect_land_pitch(ref, buf, FB_STRIDE, x1, y1, x2, y2);
+
+	if (memcmp(fb, ref, FB_PIXELS * sizeof(u32)))
+	{
+		printf("mismatch at %d,%d - %d,%d\n", x1, y1, x2, y2);
+		CHECK(0);
+	}
+}
+
+static void test_rects(u32 *fb, u32 *ref, const u32 *buf)
+{
+	// Full screen, single pixel, thin lines and every tile remainder.
+	_check_rect(fb, ref, buf, 0, 0, UI_W - 1, UI_H - 1);
+	_check_rect(fb, ref, buf, 5, 7, 5, 7);
+	_check_rect(fb, ref, buf, 0, 100, UI_W - 1, 100);
+	_check_rect(fb, ref, buf, 640, 0, 640, UI_H - 1);
+	for (u32 w = 1; w <= 17; w++)
+		for (u32 h = 1; h <= 17; h++)
+			_check_rect(fb, ref, buf, 100 + w, 200 + h, 100 + 2 * w - 1, 200 + 2 * h - 1);
+
+	for (u32 it = 0; it < 500 && !test_fails; it++)
+	{
+		u32 x1 = _rand() % UI_W;
+		u32 x2 = _rand() % UI_W;
+		u32 y1 = _rand() % UI_H;
+		u32 y2 = _rand() % UI_H;
+
+		_check_rect(fb, ref, buf, MIN(x1, x2), MIN(y1, y2), MAX(x1, x2), MAX(y1, y2));
+	}
+}
+
+static double _bench(void (*rotate)(u32 *, const u32 *, u32, u32, u32, u32, u32), u32 *fb, const u32 *buf)
+{
+	clock_t start = clock();
+
+	for (u32 i = 0; i < BENCH_ROUNDS; i++)
+		rotate(fb, buf, FB_STRIDE, 0, 0, UI_W - 1, UI_H - 1);
+
+	return (double)(clock() - start) * 1000 / CLOCKS_PER_SEC / BENCH_ROUNDS;
+}
+
+int main(int argc, char *argv[])
+{
+	u32 *fb = malloc(FB_PIXELS * sizeof(u32));
+	u32 *ref = malloc(FB_PIXELS * sizeof(u32));
+	u32 *buf = malloc(UI_W * UI_H * sizeof(u32));
+
+	for (u32 i = 0; i < UI_W * UI_H; i++)
+		buf[i] = _rand();
+
+	// Run with "bench" to time full screen flushes against the per-pixel version.
+	if (argc > 1 && !strcmp(argv[1], "bench"))
+	{
+		double t_ref = _bench(_ref_rect_land_pitch, ref, buf);
+		double t_new = _bench(gfx_set_rect_land_pitch, fb, buf);
+
+		printf("gfx_rotate: per-pixel %.3f ms, tiled %.3f ms per full screen flush\n", t_ref, t_new);
+	}
+	else
+		test_rects(fb, ref, buf);
+
+	free(fb);
+	free(ref);
+	free(buf);
+
+	TEST_DONE("gfx_rotate");
+}
@@ -0,0 +1,333 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include <libs/fatfs/ff.h>
+#include <utils/dirlist.h>
+#include <utils/ini.h>
+
+#define DUMP_MAX 0x100000
+
+static char dump_ref[DUMP_MAX];
+static char dump_new[DUMP_MAX];
+static u32 dump_pos;
+
+static void _dump(char *dump, const char *prefix, const char *a, const char *b)
+{
+	int len = snprintf(dump + dump_pos, DUMP_MAX - dump_pos, "%s[%s]=[%s]\n", prefix, a ? a : "(null)", b ? b : "");
+	if (len > 0)
+		dump_pos += len;
+}
+
+/*
+ * Reference model: the line based parser that ini_parse() replaced.
+ * Reads with f_gets() into a 512 byte buffer and dumps what it would have listed.
+ */
+
+static void _ref_trim(char *dst, const char *str)
+{
+	if (str[0] == ' ')
+		str++;
+
+	strcpy(dst, str);
+
+	u32 len = strlen(dst);
+	if (len && dst[len - 1] == ' ')
+		dst[len - 1] = 0;
+}
+
+static u32 _ref_find_section_name(char *lbuf, u32 lblen, char schar)
+{
+	u32 i;
+	for (i = 0; i < lblen && lbuf[i] != schar && lbuf[i] != '\n'; i++)
+		;
+	lbuf[i] = 0;
+
+	return i;
+}
+
+static void _ref_parse_file(const char *path)
+{
+	FIL fp;
+	char lbuf[512], a[512], b[512];
+	u32 type = 0;
+
+	if (f_open(&fp, path, FA_READ))
+		return;
+
+	do
+	{
+		lbuf[0] = 0;
+		f_gets(lbuf, 512, &fp);
+		u32 lblen = strlen(lbuf);
+
+		if (lblen && lbuf[lblen - 1] == '\n')
+			lbuf[lblen - 1] = 0;
+
+		if (lblen > 2 && lbuf[0] == '[')
+		{
+			_ref_find_section_name(lbuf, lblen, ']');
+			_ref_trim(a, &lbuf[1]);
+			_dump(dump_ref, "S3", a, NULL);
+			type = INI_CHOICE;
+		}
+		else if (lblen > 1 && lbuf[0] == '{')
+		{
+			_ref_find_section_name(lbuf, lblen, '}');
+			_ref_trim(a, &lbuf[1]);
+			_dump(dump_ref, "S5", a, NULL);
+			type = INI_CAPTION;
+		}
+		else if (lblen > 2 && lbuf[0] == '#')
+		{
+			_ref_trim(a, &lbuf[1]);
+			_dump(dump_ref, "S255", a, NULL);
+			type = INI_COMMENT;
+		}
+		else if (lblen < 2)
+		{
+			_dump(dump_ref, "S254", NULL, NULL);
+			type = INI_NEWLINE;
+		}
+		else if (type == INI_CHOICE)
+		{
+			u32 i = _ref_find_section_name(lbuf, lblen, '=');
+			_ref_trim(a, lbuf);
+			_ref_trim(b, i < lblen ? &lbuf[i + 1] : "");
+			_dump(dump_ref, " K", a, b);
+		}
+	} while (!f_eof(&fp));
+
+	f_close(&fp);
+}
+
+static void _ref_parse(const char *path, bool is_dir)
+{
+	dump_pos = 0;
+	dump_ref[0] = 0;
+
+	if (!is_dir)
+	{
+		_ref_parse_file(path);
+		return;
+	}
+
+	char *list = dirlist(path, "*.ini", false, false);
+	for (u32 k = 0; list && list[k * 256]; k++)
+	{
+		char file[512];
+		snprintf(file, sizeof(file), "%s/%s", path, &list[k * 256]);
+		_ref_parse_file(file);
+	}
+	free(list);
+}
+
+// Dumps the parsed list and checks that every hashed lookup agrees with a list scan.
+static void _new_parse(const char *path, bool is_dir)
+{
+	LIST_INIT(secs);
+
+	dump_pos = 0;
+	dump_new[0] = 0;
+
+	if (!ini_parse(&secs, (char *)path, is_dir))
+		return;
+
+	LIST_FOREACH_ENTRY(ini_sec_t, sec, &secs, link)
+	{
+		char type[8];
+		snprintf(type, sizeof(type), "S%u", sec->type);
+		_dump(dump_new, type, sec->name, NULL);
+
+		if (sec->type != INI_CHOICE)
+			continue;
+
+		// First section with that name.
+		ini_sec_t *first = NULL;
+		LIST_FOREACH_ENTRY(ini_sec_t, s, &secs, link)
+			if (s->type == INI_CHOICE && !strcmp(s->name, sec->name))
+			{
+				first = s;
+				break;
+			}
+		CHECK(ini_get_sec(&secs, sec->name) == first);
+
+		LIST_FOREACH_ENTRY(ini_kv_t, kv, &sec->kvs, link)
+		{
+			_dump(dump_new, " K", kv->key, kv->val);
+
+			ini_kv_t *kv_first = NULL;
+			LIST_FOREACH_ENTRY(ini_kv_t, k, &sec->kvs, link)
+				if (!strcmp(k->key, kv->key))
+				{
+					kv_first = k;
+					break;
+				}
+			CHECK(ini_get_kv(sec, kv->key) == kv_first);
+		}
+	}
+}
+
+static const char ini_a[] =
+	"[config]\n"
+	"autoboot=1\n"
+	"bootwait= 3 \n"
+	"\n"
+	"{-- Custom Firmwares --}\n"
+	"[CFW]\r\n"
+	"payload=bootloader/payloads/fusee.bin\r\n"
+	"icon=bootloader/res/icon.bmp\n"
+	"id\n"
+	"#comment line\n"
+	"[config]\n"
+	"autoboot=2\n"
+	"[Stock]\n"
+	"stock=1\n"
+	"stock=0\n";
+
+static const char ini_b[] =
+	"[Linux]\n"
+	"payload=bootloader/payloads/coreboot.rom\n"
+	"[CFW]\n"
+	"payload=second.bin\n";
+
+static void test_lookups()
+{
+	LIST_INIT(secs);
+
+	ff_host_reset();
+	ff_host_add("a.ini", ini_a, sizeof(ini_a) - 1, AM_ARC);
+	ff_host_add("b.ini", ini_b, sizeof(ini_b) - 1, AM_ARC);
+
+	CHECK(ini_parse(&secs, "a.ini", false));
+
+	ini_sec_t *cfg = ini_get_sec(&secs, "config");
+	CHECK(cfg && !strcmp(ini_get_kv(cfg, "autoboot")->val, "1"));
+	CHECK(!strcmp(ini_get_kv(cfg, "bootwait")->val, "3"));
+
+	// Later duplicates are reached in list order.
+	ini_sec_t *cfg2 = ini_get_sec_next(cfg);
+	CHECK(cfg2 && cfg2 != cfg && !strcmp(ini_get_kv(cfg2, "autoboot")->val, "2"));
+	CHECK(!ini_get_sec_next(cfg2));
+
+	ini_sec_t *cfw = ini_get_sec(&secs, "CFW");
+	CHECK(cfw && !strcmp(ini_check_payload_section(cfw), "bootloader/payloads/fusee.bin"));
+	CHECK(ini_get_kv(cfw, "id") && !ini_get_kv(cfw, "id")->val[0]);
+	CHECK(!ini_get_kv(cfw, "missing"));
+
+	// Duplicate keys resolve to the first one.
+	CHECK(!strcmp(ini_get_kv(ini_get_sec(&secs, "Stock"), "stock")->val, "1"));
+
+	// Captions and comments are not looked up.
+	CHECK(!ini_get_sec(&secs, "-- Custom Firmwares --"));
+	CHECK(!ini_get_sec(&secs, "missing"));
+	CHECK(!ini_get_kv(NULL, "x"));
+
+	// A second parse into the same list is searched after the first.
+	CHECK(ini_parse(&secs, "b.ini", false));
+	CHECK(ini_get_sec(&secs, "CFW") == cfw);
+	ini_sec_t *cfw2 = ini_get_sec_next(cfw);
+	CHECK(cfw2 && !strcmp(ini_check_payload_section(cfw2), "second.bin"));
+	CHECK(ini_get_sec(&secs, "Linux"));
+
+	LIST_INIT(empty);
+	CHECK(!ini_get_sec(&empty, "config"));
+	CHECK(!ini_parse(&empty, "missing.ini", false));
+}
+
+static void test_dir()
+{
+	ff_host_reset();
+	ff_host_add("ini", NULL, 0, AM_DIR);
+	ff_host_add("ini/b.ini", ini_b, sizeof(ini_b) - 1, AM_ARC);
+	ff_host_add("ini/a.ini", ini_a, sizeof(ini_a) - 1, AM_ARC);
+	ff_host_add("ini/c.txt", ini_a, sizeof(ini_a) - 1, AM_ARC);
+	ff_host_add("ini/h.ini", ini_a, sizeof(ini_a) - 1, AM_ARC | AM_HID);
+
+	_ref_parse("ini", true);
+	_new_parse("ini", true);
+	CHECK(!strcmp(dump_ref, dump_new));
+
+	// Files are parsed sorted and hidden ones are skipped.
+	LIST_INIT(secs);
+	CHECK(ini_parse(&secs, "ini", true));
+	CHECK(!strcmp(CONTAINER_OF(secs.next, ini_sec_t, link)->name, "config"));
+	CHECK(!strcmp(CONTAINER_OF(secs.prev, ini_sec_t, link)->name, "CFW"));
+}
+
+static u32 _gen(char *buf, u32 max)
+{
+	static const char cs[] = "[]{}#= ab\r\n\n\n";
+	u32 n = rand() % 3000;
+	if (rand() % 10 == 0)
+		n = 0;
+
+	u32 pos = 0;
+	for (u32 i = 0; i < n && pos < max; i++)
+	{
+		// Long lines, split at 511 characters.
+		if (rand() % 200 == 0)
+		{
+			u32 len = 400 + rand() % 700;
+			for (u32 j = 0; j < len && pos < max; j++)
+				buf[pos++] = rand() % 50 ? 'x' : '\r';
+			continue;
+		}
+		buf[pos++] = cs[rand() % (sizeof(cs) - 1)];
+	}
+
+	return pos;
+}
+
+static void test_fuzz()
+{
+	static char a[0x8000], b[0x8000];
+
+	srand(1);
+	for (u32 it = 0; it < 5000; it++)
+	{
+		u32 a_size = _gen(a, sizeof(a));
+		u32 b_size = _gen(b, sizeof(b));
+		bool is_dir = it & 1;
+
+		ff_host_reset();
+		ff_host_add("d", NULL, 0, AM_DIR);
+		ff_host_add("d/a.ini", a, a_size, AM_ARC);
+		ff_host_add("d/b.ini", b, b_size, AM_ARC);
+
+		_ref_parse(is_dir ? "d" : "d/a.ini", is_dir);
+		_new_parse(is_dir ? "d" : "d/a.ini", is_dir);
+
+		if (strcmp(dump_ref, dump_new))
+		{
+			printf("ini: mismatch at iteration %u\n", it);
+			test_fails++;
+			break;
+		}
+	}
+}
+
+int main()
+{
+	test_lookups();
+	test_dir();
+	test_fuzz();
+
+	TEST_DONE("ini");
+}
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include <libs/compr/lz4.h>
+#include <libs/compr/lz4_pak.h>
+
+#define RAW_SIZE   0x30000
+#define SPLIT_1    0x10000
+#define SPLIT_2    0x18000
+#define PAK_ENTRIES 3
+
+static u8 raw[RAW_SIZE];
+
+static u32 rng = 1;
+
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+// Packs raw the same way tools/lz4pak does. Returns the pak size.
+static u32 _pack(u8 *pak, u32 cap, const u32 *splits, u32 count)
+{
+	lz4_pak_hdr_t *hdr = (lz4_pak_hdr_t *)pak;
+	lz4_pak_entry_t *entries = (lz4_pak_entry_t *)(hdr + 1);
+
+	hdr->magic = LZ4_PAK_MAGIC;
+	hdr->version = LZ4_PAK_VERSION;
+	hdr->count = count;
+	hdr->raw_size = RAW_SIZE;
+
+	u32 out_off = sizeof(lz4_pak_hdr_t) + sizeof(lz4_pak_entry_t) * count;
+	for (u32 i = 0; i < count; i++)
+	{
+		u32 raw_off = splits[i];
+		u32 raw_size = ((i + 1) < count ? splits[i + 1] : RAW_SIZE) - raw_off;
+
+		out_off = (out_off + 3) & ~3;
+		int comp_size = LZ4_compress_default((const char *)raw + raw_off, (char *)pak + out_off, raw_size, cap - out_off);
+		if (comp_size <= 0 || (u32)comp_size >= raw_size)
+		{
+			memcpy(pak + out_off, raw + raw_off, raw_size);
+			comp_size = raw_size;
+		}
+
+		entries[i].raw_off = raw_off;
+		entries[i].raw_size = raw_size;
+		entries[i].comp_off = out_off;
+		entries[i].comp_size = comp_size;
+
+		out_off += comp_size;
+	}
+
+	return out_off;
+}
+
+static void test_round_trip(const u8 *pak, u32 pak_size)
+{
+	const lz4_pak_entry_t *entries = (const lz4_pak_entry_t *)((const lz4_pak_hdr_t *)pak + 1);
+	u8 *out = malloc(RAW_SIZE);
+
+	CHECK(lz4_pak_get_hdr(pak, pak_size) == (const lz4_pak_hdr_t *)pak);
+
+	// First and last entries compress, the random middle one is stored as is.
+	CHECK(entries[0].comp_size < entries[0].raw_size);
+	CHECK(entries[1].comp_size == entries[1].raw_size);
+	CHECK(entries[2].comp_size < entries[2].raw_size);
+
+	memset(out, 0xAA, RAW_SIZE);
+	CHECK(lz4_pak_unpack(pak, out));
+	CHECK(!memcmp(out, raw, RAW_SIZE));
+
+	// A single entry touches only its own range.
+	memset(out, 0xAA, RAW_SIZE);
+	CHECK(lz4_pak_unpack_entry(pak, 2, out));
+	CHECK(!memcmp(out + SPLIT_2, raw + SPLIT_2, RAW_SIZE - SPLIT_2));
+	for (u32 i = 0; i < SPLIT_2; i++)
+		if (out[i] != 0xAA)
+		{
+			CHECK(out[i] == 0xAA);
+			break;
+		}
+	CHECK(!lz4_pak_unpack_entry(pak, PAK_ENTRIES, out));
+
+	free(out);
+}
+
+static void test_find(const u8 *pak)
+{
+	CHECK(lz4_pak_find(pak, 0) == 0);
+	CHECK(lz4_pak_find(pak, SPLIT_1 - 1) == 0);
+	CHECK(lz4_pak_find(pak, SPLIT_1) == 1);
+	CHECK(lz4_pak_find(pak, SPLIT_2 - 1) == 1);
+	CHECK(lz4_pak_find(pak, SPLIT_2) == 2);
+	CHECK(lz4_pak_find(pak, RAW_SIZE - 1) == 2);
+	CHECK(lz4_pak_find(pak, RAW_SIZE) == -1);
+}
+
+static void test_bad_hdr(const u8 *pak, u32 pak_size)
+{
+	u8 *bad = malloc(pak_size);
+	lz4_pak_hdr_t *hdr = (lz4_pak_hdr_t *)bad;
+	lz4_pak_entry_t *entries = (lz4_pak_entry_t *)(hdr + 1);
+
+#define BAD_CASE(mod, size) \
+	do { \
+		memcpy(bad, pak, pak_size); \
+		mod; \
+		CHECK(!lz4_pak_get_hdr(bad, size)); \
+	} while (0)
+
+	BAD_CASE(, sizeof(lz4_pak_hdr_t) - 1);
+	BAD_CASE(, pak_size - 1); // Last entry data truncated.
+	BAD_CASE(hdr->magic ^= 1, pak_size);
+	BAD_CASE(hdr->version++, pak_size);
+	BAD_CASE(hdr->count = 0x10000000, pak_size);
+	BAD_CASE(hdr->count = 0, pak_size);
+	BAD_CASE(hdr->count--, pak_size); // Image not fully covered.
+	BAD_CASE(hdr->raw_size++, pak_size);
+	BAD_CASE(entries[1].raw_off++, pak_size); // Gap.
+	BAD_CASE(entries[1].raw_size = 0, pak_size);
+	BAD_CASE(entries[2].raw_size = 0xFFFFFFFF, pak_size);
+	BAD_CASE(entries[2].comp_off = 0xFFFFFFF0, pak_size);
+	BAD_CASE(entries[2].comp_size = 0xFFFFFFF0, pak_size);
+
+#undef BAD_CASE
+
+	free(bad);
+}
+
+static void test_corrupt_data(const u8 *pak, u32 pak_size)
+{
+	u8 *bad = malloc(pak_size);
+	u8 *out = malloc(RAW_SIZE);
+	lz4_pak_entry_t *entries = (lz4_pak_entry_t *)((lz4_pak_hdr_t *)bad + 1);
+
+	// A compressed entry that ends early must fail and not be taken as unpacked.
+	memcpy(bad, pak, pak_size);
+	entries[0].comp_size /= 2;
+	CHECK(lz4_pak_get_hdr(bad, pak_size));
+	CHECK(!lz4_pak_unpack_entry(bad, 0, out));
+	CHECK(!lz4_pak_unpack(bad, out));
+
+	// An entry that decodes to fewer bytes than raw_size also fails.
+	memcpy(bad, pak, pak_size);
+	entries[2].raw_size--;
+	entries[1].raw_size++;
+	entries[2].raw_off++;
+	CHECK(lz4_pak_get_hdr(bad, pak_size));
+	CHECK(!lz4_pak_unpack_entry(bad, 2, out));
+
+	free(bad);
+	free(out);
+}
+
+int main()
+{
+	static const u32 splits[PAK_ENTRIES] = { 0, SPLIT_1, SPLIT_2 };
+	u32 cap = RAW_SIZE * 2;
+	u8 *pak = malloc(cap);
+
+	// Text-like data, then noise that does not compress, then zeroes.
+	for (u32 i = 0; i < SPLIT_1; i++)
+		raw[i] = "hekate nyx "[_rand() % 11];
+	for (u32 i = SPLIT_1; i < SPLIT_2; i++)
+		raw[i] = _rand();
+
+	u32 pak_size = _pack(pak, cap, splits, PAK_ENTRIES);
+
+	test_round_trip(pak, pak_size);
+	test_find(pak);
+	test_bad_hdr(pak, pak_size);
+	test_corrupt_data(pak, pak_size);
+
+	free(pak);
+
+	TEST_DONE("lz4_pak");
+}
@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include <storage/mmc.h>
+#include <storage/mmc_seq.h>
+
+// Mock eMMC card. Only models the states and commands that mmc_seq issues.
+typedef struct _mock_card_t
+{
+	u32 rca;
+	u32 state;
+	u32 prg_polls;    // CMD13 polls to stay in programming state after a flush.
+	u32 cmd23_reject; // Next CMD23s to reject.
+	u32 switch_error; // Reject the next CMD6.
+	u32 cache_ctrl;
+	u32 flushes;
+	u32 last_blkcnt;
+
+	u32 cmds[64];
+	u32 args[64];
+	u32 busy[64];
+	u32 n;
+	u32 ms;
+} mock_card_t;
+
+static mock_card_t card;
+
+static int _mock_cmd_r1(void *ctx, u32 cmd, u32 arg, u32 check_busy, u32 *resp)
+{
+	mock_card_t *c = (mock_card_t *)ctx;
+
+	if (c->n < 64)
+	{
+		c->cmds[c->n] = cmd;
+		c->args[c->n] = arg;
+		c->busy[c->n] = check_busy;
+	}
+	c->n++;
+
+	*resp = c->state << 9;
+
+	switch (cmd)
+	{
+	case MMC_SEND_STATUS:
+		if (arg != c->rca << 16)
+			return 0;
+		if (c->state == R1_STATE_PRG && !c->prg_polls--)
+			c->state = R1_STATE_TRAN;
+		*resp = (c->state << 9) | (c->state == R1_STATE_TRAN ? R1_READY_FOR_DATA : 0);
+		return 1;
+
+	case MMC_SWITCH:
+		if (c->switch_error)
+		{
+			c->switch_error = 0;
+			*resp |= R1_SWITCH_ERROR;
+			return 0;
+		}
+		if (((arg >> 16) & 0xFF) == EXT_CSD_FLUSH_CACHE)
+		{
+			c->flushes++;
+			c->state = R1_STATE_PRG;
+		}
+		else if (((arg >> 16) & 0xFF) == EXT_CSD_CACHE_CTRL)
+			c->cache_ctrl = (arg >> 8) & 0xFF;
+		return 1;
+
+	case MMC_SET_BLOCK_COUNT:
+		if (c->cmd23_reject)
+		{
+			c->cmd23_reject--;
+			*resp |= R1_ILLEGAL_COMMAND;
+			return 0;
+		}
+		c->last_blkcnt = arg;
+		return 1;
+	}
+
+	return 0;
+}
+
+static u32 _mock_get_ms()
+{
+	return card.ms;
+}
+
+static void _mock_sleep_ms(u32 ms)
+{
+	card.ms += ms;
+}
+
+static const mmc_seq_ops_t mock_ops = {
+	.cmd_r1   = _mock_cmd_r1,
+	.get_ms   = _mock_get_ms,
+	.sleep_ms = _mock_sleep_ms
+};
+
+static void _mock_reset(mmc_seq_t *seq)
+{
+	memset(&card, 0, sizeof(card));
+	card.rca = 2;
+	card.state = R1_STATE_TRAN;
+
+	seq->ops = &mock_ops;
+	seq->ctx = &card;
+	seq->rca = card.rca;
+}
+
+static void test_set_block_count()
+{
+	mmc_seq_t seq;
+	u32 fails = 0;
+
+	// Accepted CMD23 pre-defines the transfer.
+	_mock_reset(&seq);
+	CHECK(mmc_seq_set_block_count(&seq, 0x800, &fails) == 1);
+	CHECK(card.n == 1 && card.cmds[0] == MMC_SET_BLOCK_COUNT && card.last_blkcnt == 0x800);
+	CHECK(fails == 0);
+
+	// One rejection only makes that transfer open-ended.
+	card.cmd23_reject = 1;
+	CHECK(mmc_seq_set_block_count(&seq, 0x10, &fails) == 0);
+	CHECK(fails == 1);
+	CHECK(mmc_seq_set_block_count(&seq, 0x20, &fails) == 1);
+	CHECK(card.last_blkcnt == 0x20 && fails == 0);
+
+	// A card that keeps rejecting it stops getting CMD23, until re-init clears the count.
+	card.cmd23_reject = MMC_SEQ_CMD23_MAX_FAILS;
+	for (u32 i = 0; i < MMC_SEQ_CMD23_MAX_FAILS; i++)
+		CHECK(mmc_seq_set_block_count(&seq, 8, &fails) == 0);
+	u32 n = card.n;
+	CHECK(mmc_seq_set_block_count(&seq, 8, &fails) == 0);
+	CHECK(card.n == n);
+
+	fails = 0;
+	CHECK(mmc_seq_set_block_count(&seq, 8, &fails) == 1);
+	CHECK(card.n == n + 1);
+}
+
+static void test_flush()
+{
+	mmc_seq_t seq;
+
+	// CMD6 FLUSH_CACHE without controller busy wait, then CMD13 until ready.
+	_mock_reset(&seq);
+	card.prg_polls = 5;
+	CHECK(mmc_seq_flush(&seq, 100) == 1);
+	CHECK(card.flushes == 1);
+	CHECK(card.cmds[0] == MMC_SWITCH && card.busy[0] == 0);
+	CHECK(card.args[0] == ((MMC_SWITCH_MODE_WRITE_BYTE << 24) | (EXT_CSD_FLUSH_CACHE << 16) | (1 << 8)));
+	CHECK(card.n == 1 + 6);
+	for (u32 i = 1; i < card.n; i++)
+		CHECK(card.cmds[i] == MMC_SEND_STATUS && card.args[i] == card.rca << 16);
+	CHECK(card.state == R1_STATE_TRAN);
+
+	// Card stuck in programming state times out.
+	_mock_reset(&seq);
+	card.prg_polls = 0xFFFFFFFF;
+	CHECK(mmc_seq_flush(&seq, 50) == 0);
+	CHECK(card.ms > 50 && card.ms <= 52);
+
+	// Rejected switch is not polled.
+	_mock_reset(&seq);
+	card.switch_error = 1;
+	CHECK(mmc_seq_flush(&seq, 50) == 0);
+	CHECK(card.n == 1 && card.flushes == 0);
+}
+
+static void test_cache_ctrl()
+{
+	mmc_seq_t seq;
+
+	_mock_reset(&seq);
+	CHECK(mmc_seq_cache_ctrl(&seq, 5) == 1);
+	CHECK(card.cache_ctrl == 1);
+	CHECK(card.n == 2 && card.cmds[0] == MMC_SWITCH && card.busy[0] == 1 && card.cmds[1] == MMC_SEND_STATUS);
+
+	CHECK(mmc_seq_cache_ctrl(&seq, 0) == 1);
+	CHECK(card.cache_ctrl == 0);
+
+	card.switch_error = 1;
+	CHECK(mmc_seq_cache_ctrl(&seq, 1) == 0);
+	CHECK(card.cache_ctrl == 0);
+}
+
+int main()
+{
+	test_set_block_count();
+	test_flush();
+	test_cache_ctrl();
+
+	TEST_DONE("mmc_seq");
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <string.h>
+
+#include "test.h"
+#include <storage/sdmmc_adma.h>
+
+#define DESC_MAX 64
+#define ATTR_MID (SDMMC_ADMA_ATTR_TRAN | SDMMC_ADMA_ATTR_VALID)
+#define ATTR_END (ATTR_MID | SDMMC_ADMA_ATTR_END)
+
+// Buffers are never dereferenced, only their addresses go in the table.
+#define ADDR(a) ((void *)(uintptr_t)(a))
+
+static sdmmc_adma_desc_t desc[DESC_MAX];
+
+static u32 rng = 3;
+
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+// Checks the invariants every table must hold: lengths in (0, max], aligned addresses, END only last.
+static u32 _check_table(u32 cnt)
+{
+	u32 total = 0;
+
+	for (u32 i = 0; i < cnt; i++)
+	{
+		CHECK(desc[i].len && desc[i].len <= SDMMC_ADMA_MAX_LEN);
+		CHECK(!(desc[i].addr_lo & (SDMMC_ADMA_ALIGN - 1)));
+		CHECK(!desc[i].addr_hi && !desc[i].rsvd);
+		CHECK(desc[i].attr == ((i + 1) == cnt ? ATTR_END : ATTR_MID));
+		total += desc[i].len;
+	}
+
+	return total;
+}
+
+static void test_split()
+{
+	sdmmc_sg_t sg = { ADDR(0x80000000), 0x20000 };
+
+	// 128KB: two full descriptors, then the rest. The second one still starts aligned.
+	u32 cnt = sdmmc_adma_build(desc, DESC_MAX, &sg, 1, 0, 0x20000);
+	CHECK(cnt == 3);
+	CHECK(_check_table(cnt) == 0x20000);
+	CHECK(desc[0].addr_lo == 0x80000000 && desc[0].len == 0xFFF8);
+	CHECK(desc[1].addr_lo == 0x8000FFF8 && desc[1].len == 0xFFF8);
+	CHECK(desc[2].addr_lo == 0x8001FFF0 && desc[2].len == 0x10);
+
+	// Exactly the cap fits in one, 64KB never uses the 0 (64KB) length encoding.
+	CHECK(sdmmc_adma_build(desc, DESC_MAX, &sg, 1, 0, 0xFFF8) == 1);
+	CHECK(desc[0].len == 0xFFF8);
+	cnt = sdmmc_adma_build(desc, DESC_MAX, &sg, 1, 0, 0x10000);
+	CHECK(cnt == 2);
+	CHECK(_check_table(cnt) == 0x10000);
+	CHECK(desc[1].len == 8);
+
+	// Lengths can be any byte count.
+	cnt = sdmmc_adma_build(desc, DESC_MAX, &sg, 1, 0, 0x201);
+	CHECK(cnt == 1 && desc[0].len == 0x201);
+}
+
+static void test_sg_offset()
+{
+	sdmmc_sg_t sg[3] = {
+		{ ADDR(0x90000000), 0x200 },
+		{ ADDR(0xA0000000), 0x10000 },
+		{ ADDR(0xB0000000), 0x400 }
+	};
+
+	// Resume 0x100 bytes into the second entry and run into the third.
+	u32 cnt = sdmmc_adma_build(desc, DESC_MAX, sg, 3, 0x300, 0x10000);
+	CHECK(cnt == 2);
+	CHECK(_check_table(cnt) == 0x10000);
+	CHECK(desc[0].addr_lo == 0xA0000100 && desc[0].len == 0xFF00);
+	CHECK(desc[1].addr_lo == 0xB0000000 && desc[1].len == 0x100);
+
+	// Offset on an entry boundary starts on the next entry.
+	cnt = sdmmc_adma_build(desc, DESC_MAX, sg, 3, 0x200, 0x200);
+	CHECK(cnt == 1 && desc[0].addr_lo == 0xA0000000);
+}
+
+static void test_reject()
+{
+	sdmmc_sg_t sg[2] = {
+		{ ADDR(0x80000000), 0x1000 },
+		{ ADDR(0x80100004), 0x1000 }
+	};
+
+	CHECK(!sdmmc_adma_build(desc, DESC_MAX, sg, 1, 0, 0));        // Nothing to do.
+	CHECK(!sdmmc_adma_build(desc, DESC_MAX, sg, 1, 0, 0x1001));   // List too short.
+	CHECK(!sdmmc_adma_build(desc, DESC_MAX, sg, 1, 0x1000, 8));   // Offset past the list.
+	CHECK(!sdmmc_adma_build(desc, DESC_MAX, sg, 1, 4, 8));        // Misaligned offset.
+	CHECK(!sdmmc_adma_build(desc, DESC_MAX, sg, 2, 0, 0x1008));   // Misaligned entry.
+
+	// Table too small for the split.
+	sdmmc_sg_t big = { ADDR(0x80000000), 0x30000 };
+	CHECK(!sdmmc_adma_build(desc, 3, &big, 1, 0, 0x30000));
+	CHECK(sdmmc_adma_build(desc, 4, &big, 1, 0, 0x30000) == 4);
+}
+
+static void test_random()
+{
+	sdmmc_sg_t sg[8];
+
+	for (u32 it = 0; it < 10000; it++)
+	{
+		u32 sg_cnt = 1 + _rand() % 8;
+		u32 list_size = 0;
+		u32 addr = 0x80000000;
+
+		for (u32 i = 0; i < sg_cnt; i++)
+		{
+			// Aligned sizes keep every entry start aligned when resuming mid list.
+			sg[i].buf = ADDR(addr);
+			sg[i].size = 8 * (1 + _rand() % 0x4000);
+			addr += sg[i].size + 8 * (_rand() % 16);
+			list_size += sg[i].size;
+		}
+
+		u32 offset = 8 * (_rand() % (list_size / 8));
+		u32 size = 1 + _rand() % (list_size - offset);
+		u32 cnt = sdmmc_adma_build(desc, DESC_MAX, sg, sg_cnt, offset, size);
+
+		CHECK(cnt);
+		CHECK(_check_table(cnt) == size);
+
+		// Walk the list alongside the table and check every byte lands where expected.
+		u32 idx = 0;
+		u32 pos = offset;
+		while (pos >= sg[idx].size)
+			pos -= sg[idx++].size;
+		for (u32 i = 0; i < cnt; i++)
+		{
+			CHECK(desc[i].addr_lo == (u32)(uintptr_t)sg[idx].buf + pos);
+			pos += desc[i].len;
+			CHECK(pos <= sg[idx].size);
+			if (pos == sg[idx].size)
+			{
+				pos = 0;
+				idx++;
+			}
+		}
+
+		if (test_fails)
+			break;
+	}
+}
+
+int main()
+{
+	test_split();
+	test_sg_offset();
+	test_reject();
+	test_random();
+
+	TEST_DONE("sdmmc_adma");
+}
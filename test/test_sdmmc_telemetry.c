@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+#include <storage/sdmmc_telemetry.h>
+
+static sdmmc_telem_t telem;
+
+static u32 rng = 5;
+
+static u32 _rand()
+{
+	rng ^= rng << 13;
+	rng ^= rng >> 17;
+	rng ^= rng << 5;
+
+	return rng;
+}
+
+static void test_classes()
+{
+	CHECK(sdmmc_telem_bin(0) == 0);
+	CHECK(sdmmc_telem_bin(1) == 0);
+	CHECK(sdmmc_telem_bin(2) == 1);
+	CHECK(sdmmc_telem_bin(3) == 1);
+	CHECK(sdmmc_telem_bin(4) == 2);
+	CHECK(sdmmc_telem_bin((1 << 19) - 1) == 18);
+	CHECK(sdmmc_telem_bin(1 << 19) == SDMMC_TELEM_HIST_BINS - 1);
+	CHECK(sdmmc_telem_bin(0xFFFFFFFF) == SDMMC_TELEM_HIST_BINS - 1);
+
+	CHECK(sdmmc_telem_size_class(1) == SDMMC_TELEM_SZ_4K);
+	CHECK(sdmmc_telem_size_class(8) == SDMMC_TELEM_SZ_4K);
+	CHECK(sdmmc_telem_size_class(9) == SDMMC_TELEM_SZ_64K);
+	CHECK(sdmmc_telem_size_class(128) == SDMMC_TELEM_SZ_64K);
+	CHECK(sdmmc_telem_size_class(129) == SDMMC_TELEM_SZ_1M);
+	CHECK(sdmmc_telem_size_class(2048) == SDMMC_TELEM_SZ_1M);
+	CHECK(sdmmc_telem_size_class(2049) == SDMMC_TELEM_SZ_HUGE);
+}
+
+static void test_totals()
+{
+	sdmmc_telem_reset(&telem);
+
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_READ, 0, 8, 100, true);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_READ, 8, 256, 700, true);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_WRITE, 0, 1, 5000, false);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_MAX, 0, 1, 99999, false); // Ignored.
+
+	CHECK(telem.seq == 3);
+	CHECK(telem.ops[SDMMC_TELEM_OP_READ] == 2 && telem.sectors[SDMMC_TELEM_OP_READ] == 264);
+	CHECK(telem.ops[SDMMC_TELEM_OP_WRITE] == 1 && telem.sectors[SDMMC_TELEM_OP_WRITE] == 1);
+	CHECK(telem.lat_max[SDMMC_TELEM_OP_READ] == 700 && telem.lat_max[SDMMC_TELEM_OP_WRITE] == 5000);
+	CHECK(telem.counters[SDMMC_TELEM_CNT_FAIL] == 1);
+	CHECK(telem.hist[SDMMC_TELEM_OP_READ][SDMMC_TELEM_SZ_4K][sdmmc_telem_bin(100)] == 1);
+	CHECK(telem.hist[SDMMC_TELEM_OP_READ][SDMMC_TELEM_SZ_1M][sdmmc_telem_bin(700)] == 1);
+	CHECK(telem.hist[SDMMC_TELEM_OP_WRITE][SDMMC_TELEM_SZ_4K][sdmmc_telem_bin(5000)] == 1);
+}
+
+static void test_percentile()
+{
+	sdmmc_telem_reset(&telem);
+
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_MAX, 50) == 0);
+
+	// 90 fast 4K reads in [8, 16), 10 slower ones in [512, 1024), one huge read at 100ms.
+	for (u32 i = 0; i < 90; i++)
+		sdmmc_telem_add(&telem, SDMMC_TELEM_OP_READ, i, 8, 10, true);
+	for (u32 i = 0; i < 10; i++)
+		sdmmc_telem_add(&telem, SDMMC_TELEM_OP_READ, i, 8, 600, true);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_READ, 0, 4096, 100000, true);
+
+	// Results are bin upper bounds, so p50 and p90 both land in the fast bin.
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_4K, 50) == 15);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_4K, 90) == 15);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_4K, 91) == 1023);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_4K, 100) == 1023);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_HUGE, 0) == 100000);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_64K, 50) == 0);
+
+	// Merged classes: 101 requests, p99 needs 100 of them, p100 needs the huge one.
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_MAX, 99) == 1023);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_READ, SDMMC_TELEM_SZ_MAX, 100) == 100000);
+
+	// Bin upper bounds never exceed the max seen.
+	sdmmc_telem_reset(&telem);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_FLUSH, 0, 0, 1100, true);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_FLUSH, SDMMC_TELEM_SZ_MAX, 50) == 1100);
+
+	// Open-ended last bin reports the max.
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_FLUSH, 0, 0, 3000000, true);
+	CHECK(sdmmc_telem_percentile(&telem, SDMMC_TELEM_OP_FLUSH, SDMMC_TELEM_SZ_MAX, 100) == 3000000);
+}
+
+static int _cmp_lat_desc(const void *a, const void *b)
+{
+	u32 la = *(const u32 *)a;
+	u32 lb = *(const u32 *)b;
+
+	return (la < lb) - (la > lb);
+}
+
+static void test_slowest()
+{
+	sdmmc_telem_slow_t slow[SDMMC_TELEM_SLOW_MAX];
+	u32 lat[2000];
+
+	for (u32 round = 0; round < 50; round++)
+	{
+		u32 count = 1 + _rand() % 2000;
+
+		sdmmc_telem_reset(&telem);
+		for (u32 i = 0; i < count; i++)
+		{
+			// Plenty of ties, so replacing a fastest entry must still pick a valid one.
+			lat[i] = _rand() % (round & 1 ? 50 : 100000);
+			sdmmc_telem_add(&telem, i & 1, i * 8, 8, lat[i], !(i % 7));
+		}
+
+		u32 cnt = sdmmc_telem_slowest(&telem, slow, SDMMC_TELEM_SLOW_MAX);
+		CHECK(cnt == MIN(count, SDMMC_TELEM_SLOW_MAX));
+
+		// Latencies must be the top ones of all requests, slowest first, each with its own request data.
+		qsort(lat, count, sizeof(u32), _cmp_lat_desc);
+		for (u32 i = 0; i < cnt; i++)
+		{
+			u32 idx = slow[i].seq - 1;
+
+			CHECK(slow[i].lat_us == lat[i]);
+			CHECK(slow[i].sector == idx * 8 && slow[i].op == (idx & 1) && slow[i].ok == !(idx % 7));
+		}
+
+		if (test_fails)
+			break;
+	}
+
+	// Fewer entries asked than recorded.
+	CHECK(sdmmc_telem_slowest(&telem, slow, 4) == 4);
+}
+
+static void test_csv()
+{
+	char *buf = malloc(SDMMC_TELEM_CSV_MAX + 1);
+
+	sdmmc_telem_reset(&telem);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_READ, 0x1000, 8, 10, true);
+	sdmmc_telem_add(&telem, SDMMC_TELEM_OP_ERASE, 0x2000, 4096, 250000, false);
+
+	u32 len = sdmmc_telem_csv(&telem, buf);
+	CHECK(len == strlen(buf));
+	CHECK(!strncmp(buf, "op,size,ops,p50_us,p90_us,p99_us,ge_0us,ge_2us,", 47));
+	CHECK(strstr(buf, "\nread,4K,1,10,10,10,0,0,0,1,0,"));
+	CHECK(strstr(buf, "\nerase,huge,1,250000,250000,250000,"));
+	CHECK(!strstr(buf, "\nwrite,"));
+	CHECK(strstr(buf, "\n\ncounter,value\nread_ops,1\nread_sectors,8\nread_max_us,10\n"));
+	CHECK(strstr(buf, "\nfails,1\n"));
+	CHECK(strstr(buf, "\n\nseq,op,sector,sectors,lat_us,ok\n2,erase,0x00002000,4096,250000,0\n1,read,0x00001000,8,10,1\n"));
+
+	// Worst case: every row present with the widest numbers must still fit.
+	sdmmc_telem_reset(&telem);
+	for (u32 i = 0; i < SDMMC_TELEM_SLOW_MAX; i++)
+		sdmmc_telem_add(&telem, SDMMC_TELEM_OP_WRITE, 0xFFFFFFF0, 0xFFFFFFF0, 0x7FFFFFFF, true);
+	memset(telem.hist, 0x7F, sizeof(telem.hist));
+	memset(telem.ops, 0x7F, sizeof(telem.ops));
+	memset(telem.sectors, 0x7F, sizeof(telem.sectors));
+	memset(telem.lat_max, 0x7F, sizeof(telem.lat_max));
+	memset(telem.counters, 0x7F, sizeof(telem.counters));
+	for (u32 i = 0; i < SDMMC_TELEM_SLOW_MAX; i++)
+		telem.slow[i].seq = 0x7FFFFFFF;
+
+	len = sdmmc_telem_csv(&telem, buf);
+	CHECK(len == strlen(buf));
+	CHECK(len < SDMMC_TELEM_CSV_MAX);
+
+	free(buf);
+}
+
+int main()
+{
+	test_classes();
+	test_totals();
+	test_percentile();
+	test_slowest();
+	test_csv();
+
+	TEST_DONE("sdmmc_telemetry");
+}
@@ -0,0 +1,7 @@
+/*
+ * Host shim for bdk/libs/compr/lz4.c.
+ */
+
+#include <stdlib.h>
+
+typedef unsigned char BYTE;
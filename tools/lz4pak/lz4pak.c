@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2026 agent
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms and conditions of the GNU General Public License,
+ * version 2, as published by the Free Software Foundation.
+ *
+ * This program is distributed in the hope it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Packs a binary into an LZ4 pak (see bdk/libs/compr/lz4_pak.h).
+ *
+ * Usage: lz4pak <in> <out> [split offset]...
+ *
+ * Every split offset starts a new entry, so each region can be unpacked on its own.
+ * The Nyx build splits res.pak on the NYX_RES_*_OFF offsets from bdk/memory_map.h.
+ * Split at 0 is implied and can be passed or not.
+ *
+ * After packing, every entry is unpacked again and compared against the input.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "lz4.h"
+
+// Must match bdk/libs/compr/lz4_pak.h.
+#define LZ4_PAK_MAGIC   0x50345A4C // "LZ4P".
+#define LZ4_PAK_VERSION 1
+
+typedef struct _lz4_pak_hdr_t
+{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t count;
+	uint32_t raw_size;
+} lz4_pak_hdr_t;
+
+typedef struct _lz4_pak_entry_t
+{
+	uint32_t raw_off;
+	uint32_t raw_size;
+	uint32_t comp_off;
+	uint32_t comp_size;
+} lz4_pak_entry_t;
+
+static int _verify(const uint8_t *pak, const uint8_t *raw, uint32_t raw_size)
+{
+	const lz4_pak_hdr_t *hdr = (const lz4_pak_hdr_t *)pak;
+	const lz4_pak_entry_t *entries = (const lz4_pak_entry_t *)(hdr + 1);
+	uint8_t *out = (uint8_t *)calloc(1, raw_size);
+
+	if (!out || hdr->magic != LZ4_PAK_MAGIC || hdr->raw_size != raw_size)
+		return 0;
+
+	for (uint32_t i = 0; i < hdr->count; i++)
+	{
+		const char *src = (const char *)pak + entries[i].comp_off;
+		char *dst = (char *)out + entries[i].raw_off;
+
+		if (entries[i].comp_size == entries[i].raw_size)
+			memcpy(dst, src, entries[i].raw_size);
+		else if (LZ4_decompress_safe(src, dst, entries[i].comp_size, entries[i].raw_size) != (int)entries[i].raw_size)
+			return 0;
+	}
+
+	int res = !memcmp(out, raw, raw_size);
+	free(out);
+
+	return res;
+}
+
+int main(int argc, char *argv[])
+{
+	struct stat statbuf;
+	FILE *in_file, *out_file;
+
+	if (argc < 3)
+	{
+		fprintf(stderr, "Usage: %s <in> <out> [split offset]...\n", argv[0]);
+		return 1;
+	}
+
+	if (stat(argv[1], &statbuf))
+		goto error;
+
+	if ((in_file = fopen(argv[1], "rb")) == NULL)
+		goto error;
+
+	uint32_t in_size = statbuf.st_size;
+	uint8_t *in_buf  = (uint8_t *)malloc(in_size);
+	if (!in_buf || fread(in_buf, 1, in_size, in_file) != in_size)
+		goto error;
+
+	fclose(in_file);
+
+	// Parse split offsets. Entry 0 always starts at 0.
+	uint32_t count = 1;
+	uint32_t *splits = (uint32_t *)malloc(sizeof(uint32_t) * argc);
+	splits[0] = 0;
+	for (int i = 3; i < argc; i++)
+	{
+		uint32_t off = strtoul(argv[i], NULL, 0);
+		if (!off && count == 1)
+			continue;
+
+		if (off <= splits[count - 1] || off >= in_size)
+		{
+			fprintf(stderr, "Split offsets must be ascending and inside the file: %s\n", argv[i]);
+			exit(1);
+		}
+		splits[count++] = off;
+	}
+
+	uint32_t hdr_size = sizeof(lz4_pak_hdr_t) + sizeof(lz4_pak_entry_t) * count;
+	uint32_t out_cap = hdr_size + LZ4_compressBound(in_size) + count * 16;
+	uint8_t *out_buf = (uint8_t *)calloc(1, out_cap);
+	if (!out_buf)
+		goto error;
+
+	lz4_pak_hdr_t *hdr = (lz4_pak_hdr_t *)out_buf;
+	lz4_pak_entry_t *entries = (lz4_pak_entry_t *)(hdr + 1);
+	hdr->magic = LZ4_PAK_MAGIC;
+	hdr->version = LZ4_PAK_VERSION;
+	hdr->count = count;
+	hdr->raw_size = in_size;
+
+	uint32_t out_off = hdr_size;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		uint32_t raw_off = splits[i];
+		uint32_t raw_size = ((i + 1) < count ? splits[i + 1] : in_size) - raw_off;
+
+		// Keep entries word aligned.
+		out_off = (out_off + 3) & ~3;
+
+		int comp_size = LZ4_compress_default((const char *)in_buf + raw_off, (char *)out_buf + out_off,
+			raw_size, out_cap - out_off);
+
+		// Store uncompressed if it doesn't shrink.
+		if (comp_size <= 0 || (uint32_t)comp_size >= raw_size)
+		{
+			memcpy(out_buf + out_off, in_buf + raw_off, raw_size);
+			comp_size = raw_size;
+		}
+
+		entries[i].raw_off = raw_off;
+		entries[i].raw_size = raw_size;
+		entries[i].comp_off = out_off;
+		entries[i].comp_size = comp_size;
+
+		out_off += comp_size;
+	}
+
+	if (!_verify(out_buf, in_buf, in_size))
+	{
+		fprintf(stderr, "Round-trip verification failed: %s\n", argv[1]);
+		exit(1);
+	}
+
+	if ((out_file = fopen(argv[2], "wb")) == NULL)
+		goto error;
+
+	if (fwrite(out_buf, 1, out_off, out_file) != out_off)
+		goto error;
+
+	fclose(out_file);
+
+	printf("%s: %d -> %d bytes, %d entries\n", argv[2], in_size, out_off, count);
+
+	return 0;
+
+error:
+	fprintf(stderr, "Failed to pack: %s\n", argv[1]);
+	exit(1);
+}